@@ -6,6 +6,10 @@
 
 #### Libraries
 
+# zstd, for the file data of Qt compressed help files when Qt has zstd support
+if(QT_FEATURE_zstd)
+    qt_find_package(WrapZSTD 1.3 PROVIDED_TARGETS WrapZSTD::WrapZSTD)
+endif()
 
 
 #### Tests
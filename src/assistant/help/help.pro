@@ -16,9 +16,11 @@ SOURCES += \
     qhelpenginecore.cpp \
     qhelpengine.cpp \
     qhelpfilterdata.cpp \
+    qhelpfiledatacodec.cpp \
     qhelpfilterengine.cpp \
     qhelpfiltersettings.cpp \
     qhelpfiltersettingswidget.cpp \
+    qhelphtmltextextractor.cpp \
     qhelpdbreader.cpp \
     qhelpcontentwidget.cpp \
     qhelpindexwidget.cpp \
@@ -39,10 +41,13 @@ HEADERS += \
     qhelpenginecore.h \
     qhelpengine.h \
     qhelpengine_p.h \
+    qhelpbatchprocessor_p.h \
     qhelpfilterdata.h \
+    qhelpfiledatacodec_p.h \
     qhelpfilterengine.h \
     qhelpfiltersettings_p.h \
     qhelpfiltersettingswidget.h \
+    qhelphtmltextextractor_p.h \
     qhelp_global.h \
     qhelpdbreader_p.h \
     qhelpcontentwidget.h \
@@ -40,9 +40,9 @@
 #include <QtCore/QCoreApplication>
 #include <QtCore/QRegularExpression>
 #include <QtCore/QMutexLocker>
-#include <QtGui/QTextDocument>
 
 #include "qhelp_global.h"
+#include "qhelphtmltextextractor_p.h"
 
 QString QHelpGlobal::uniquifyConnectionName(const QString &name, void *pointer)
 {
@@ -57,18 +57,16 @@ QString QHelpGlobal::uniquifyConnectionName(const QString &name, void *pointer)
 
 QString QHelpGlobal::documentTitle(const QString &content)
 {
-    QString title = QCoreApplication::translate("QHelp", "Untitled");
-    if (!content.isEmpty()) {
-        const int start = content.indexOf(QLatin1String("<title>"), 0, Qt::CaseInsensitive) + 7;
-        const int end = content.indexOf(QLatin1String("</title>"), 0, Qt::CaseInsensitive);
-        if ((end - start) > 0) {
-            title = content.mid(start, end - start);
-            if (Qt::mightBeRichText(title) || title.contains(QLatin1Char('&'))) {
-                QTextDocument doc;
-                doc.setHtml(title);
-                title = doc.toPlainText();
-            }
-        }
-    }
+    const QString title = QHelpHtmlTextExtractor::title(content);
+    if (title.isEmpty())
+        return QCoreApplication::translate("QHelp", "Untitled");
+    return title;
+}
+
+QString QHelpGlobal::documentTitle(const QByteArray &content)
+{
+    const QString title = QHelpHtmlTextExtractor::title(content);
+    if (title.isEmpty())
+        return QCoreApplication::translate("QHelp", "Untitled");
     return title;
 }
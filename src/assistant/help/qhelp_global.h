@@ -59,6 +59,7 @@ class QHELP_EXPORT QHelpGlobal {
 public:
     static QString uniquifyConnectionName(const QString &name, void *pointer);
     static QString documentTitle(const QString &content);
+    static QString documentTitle(const QByteArray &content);
 };
 
 QT_END_NAMESPACE
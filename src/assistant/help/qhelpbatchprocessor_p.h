@@ -0,0 +1,132 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Assistant of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+
+#ifndef QHELPBATCHPROCESSOR_P_H
+#define QHELPBATCHPROCESSOR_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists for the convenience
+// of the help generator tools. This header file may change from version
+// to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qhelp_global.h"
+
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWaitCondition>
+
+#include <deque>
+#include <memory>
+#include <utility>
+
+QT_BEGIN_NAMESPACE
+
+class QHelpBatchProcessor
+{
+public:
+    // Splits items into batches of batchSize and calls process() for each
+    // batch on the threads of pool. consume() gets the results of process()
+    // on the calling thread, in the order of the batches. At most two
+    // batches per thread of pool are in flight, which bounds the memory
+    // held by results that are not consumed yet.
+    //
+    // When consume() returns false, the batches not started yet are
+    // dropped and false is returned once the running ones are done.
+    template <typename T, typename Process, typename Consume>
+    static bool processInOrder(QThreadPool *pool, const QList<T> &items, int batchSize,
+                               Process process, Consume consume)
+    {
+        using Result = decltype(process(std::declval<const QList<T> &>()));
+        struct Batch
+        {
+            QList<T> items;
+            Result result;
+            bool done = false;
+        };
+
+        QMutex mutex;
+        QWaitCondition batchDone;
+        std::deque<std::shared_ptr<Batch>> pending;
+        const size_t maxPending = size_t(2 * qMax(1, pool->maxThreadCount()));
+        qsizetype next = 0;
+
+        const auto startBatch = [&]() {
+            auto batch = std::make_shared<Batch>();
+            const qsizetype count = qMin(qsizetype(batchSize), items.size() - next);
+            batch->items = items.mid(next, count);
+            next += count;
+            pending.push_back(batch);
+            pool->start([batch, &process, &mutex, &batchDone]() {
+                Result result = process(qAsConst(batch->items));
+                batch->items.clear();
+
+                QMutexLocker lock(&mutex);
+                batch->result = std::move(result);
+                batch->done = true;
+                batchDone.wakeAll();
+            });
+        };
+
+        while (next < items.size() && pending.size() < maxPending)
+            startBatch();
+
+        while (!pending.empty()) {
+            const std::shared_ptr<Batch> batch = pending.front();
+            pending.pop_front();
+            {
+                QMutexLocker lock(&mutex);
+                while (!batch->done)
+                    batchDone.wait(&mutex);
+            }
+            if (next < items.size())
+                startBatch();
+
+            if (!consume(batch->result)) {
+                pool->clear();
+                pool->waitForDone();
+                return false;
+            }
+        }
+
+        // The workers may still be leaving their lambdas,
+        // which refer to the locals above.
+        pool->waitForDone();
+        return true;
+    }
+};
+
+QT_END_NAMESPACE
+
+#endif // QHELPBATCHPROCESSOR_P_H
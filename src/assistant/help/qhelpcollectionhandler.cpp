@@ -89,9 +89,13 @@ private:
     bool m_inTransaction;
 };
 
+// The default budget for the data of recently read files
+static const qint64 defaultFileDataCacheSize = 16 * 1024 * 1024;
+
 QHelpCollectionHandler::QHelpCollectionHandler(const QString &collectionFile, QObject *parent)
     : QObject(parent)
     , m_collectionFile(collectionFile)
+    , m_fileDataCache(defaultFileDataCacheSize)
 {
     const QFileInfo fi(m_collectionFile);
     if (!fi.isAbsolute())
@@ -117,6 +121,7 @@ void QHelpCollectionHandler::closeDB()
     if (!m_query)
         return;
 
+    clearReaders();
     delete m_query;
     m_query = nullptr;
     QSqlDatabase::removeDatabase(m_connectionName);
@@ -213,6 +218,13 @@ bool QHelpCollectionHandler::openCollectionFile()
         indexAndNamespaceFilterTablesMissing = tablesExist;
     }
 
+    // Collections created by older versions lack the lookup indexes,
+    // add them on the fly. This is a no-op if they exist already.
+    // The indexes only speed up the lookups, so a collection that cannot
+    // get them (e.g. a read-only file) is still opened.
+    if (!createIndexes(m_query))
+        qWarning("Cannot create indexes in file %s.", qPrintable(collectionFile()));
+
     const FileInfoList &docList = registeredDocumentations();
     if (indexAndNamespaceFilterTablesMissing) {
         for (const QHelpCollectionHandler::FileInfo &info : docList) {
@@ -379,7 +391,8 @@ bool QHelpCollectionHandler::copyCollectionFile(const QString &fileName)
     copyQuery->exec(QLatin1String("PRAGMA synchronous=OFF"));
     copyQuery->exec(QLatin1String("PRAGMA cache_size=3000"));
 
-    if (!createTables(copyQuery) || !recreateIndexAndNamespaceFilterTables(copyQuery)) {
+    if (!createTables(copyQuery) || !recreateIndexAndNamespaceFilterTables(copyQuery)
+            || !createIndexes(copyQuery)) {
         emit error(tr("Cannot copy collection file: %1").arg(colFile));
         delete copyQuery;
         return false;
@@ -557,6 +570,45 @@ bool QHelpCollectionHandler::recreateIndexAndNamespaceFilterTables(QSqlQuery *qu
     return true;
 }
 
+bool QHelpCollectionHandler::createIndexes(QSqlQuery *query)
+{
+    const QStringList indexes = QStringList()
+            << QLatin1String("CREATE INDEX IF NOT EXISTS NamespaceTableNameIndex "
+                             "ON NamespaceTable (Name)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS FolderTableNamespaceIdIndex "
+                             "ON FolderTable (NamespaceId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS FolderTableNameIndex "
+                             "ON FolderTable (Name)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS FileNameTableNameIndex "
+                             "ON FileNameTable (Name, FolderId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS FileNameTableFolderIdIndex "
+                             "ON FileNameTable (FolderId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS IndexTableNameIndex "
+                             "ON IndexTable (Name)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS IndexTableIdentifierIndex "
+                             "ON IndexTable (Identifier)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS IndexTableNamespaceIdIndex "
+                             "ON IndexTable (NamespaceId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS ContentsTableNamespaceIdIndex "
+                             "ON ContentsTable (NamespaceId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS TimeStampTableNamespaceIdIndex "
+                             "ON TimeStampTable (NamespaceId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS VersionTableNamespaceIdIndex "
+                             "ON VersionTable (NamespaceId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS ComponentMappingNamespaceIdIndex "
+                             "ON ComponentMapping (NamespaceId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS ComponentFilterFilterIdIndex "
+                             "ON ComponentFilter (FilterId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS VersionFilterFilterIdIndex "
+                             "ON VersionFilter (FilterId)");
+
+    for (const QString &q : indexes) {
+        if (!query->exec(q))
+            return false;
+    }
+    return true;
+}
+
 QStringList QHelpCollectionHandler::customFilters() const
 {
     QStringList list;
@@ -897,6 +949,9 @@ bool QHelpCollectionHandler::registerDocumentation(const QString &fileName)
     if (!isDBOpened())
         return false;
 
+    // The new documentation may change which namespace a URL resolves to.
+    clearReaders();
+
     QHelpDBReader reader(fileName, QHelpGlobal::uniquifyConnectionName(
         QLatin1String("QHelpCollectionHandler"), this), nullptr);
     if (!reader.init()) {
@@ -934,6 +989,9 @@ bool QHelpCollectionHandler::unregisterDocumentation(const QString &namespaceNam
     if (!isDBOpened())
         return false;
 
+    // Also releases the documentation file.
+    clearReaders();
+
     m_query->prepare(QLatin1String("SELECT Id FROM NamespaceTable WHERE Name = ?"));
     m_query->bindValue(0, namespaceName);
     m_query->exec();
@@ -1387,21 +1445,61 @@ QByteArray QHelpCollectionHandler::fileData(const QUrl &url) const
     if (!isDBOpened())
         return QByteArray();
 
+    const QString cacheKey = url.toString();
+    if (const QByteArray *data = m_fileDataCache.object(cacheKey))
+        return *data;
+
     const QString namespaceName = namespaceForFile(url, QString());
     if (namespaceName.isEmpty())
         return QByteArray();
 
     const FileInfo fileInfo = extractFileInfo(url);
 
+    QHelpDBReader *reader = readerForNamespace(namespaceName);
+    if (!reader)
+        return QByteArray();
+
+    const QByteArray data = reader->fileData(fileInfo.folderName, fileInfo.fileName);
+    if (!data.isEmpty())
+        m_fileDataCache.insert(cacheKey, new QByteArray(data), data.size());
+    return data;
+}
+
+qint64 QHelpCollectionHandler::fileDataCacheSize() const
+{
+    return m_fileDataCache.maxCost();
+}
+
+void QHelpCollectionHandler::setFileDataCacheSize(qint64 size)
+{
+    m_fileDataCache.setMaxCost(qMax(size, qint64(0)));
+}
+
+QHelpDBReader *QHelpCollectionHandler::readerForNamespace(const QString &namespaceName) const
+{
+    QHelpDBReader *reader = m_readers.value(namespaceName);
+    if (reader)
+        return reader;
+
     const FileInfo docInfo = registeredDocumentation(namespaceName);
     const QString absFileName = absoluteDocPath(docInfo.fileName);
 
-    QHelpDBReader reader(absFileName, QHelpGlobal::uniquifyConnectionName(
-                             docInfo.fileName, const_cast<QHelpCollectionHandler *>(this)), nullptr);
-    if (!reader.init())
-        return QByteArray();
+    reader = new QHelpDBReader(absFileName, QHelpGlobal::uniquifyConnectionName(
+                                   docInfo.fileName, const_cast<QHelpCollectionHandler *>(this)),
+                               nullptr);
+    if (!reader->init()) {
+        delete reader;
+        return nullptr;
+    }
+    m_readers.insert(namespaceName, reader);
+    return reader;
+}
 
-    return reader.fileData(fileInfo.folderName, fileInfo.fileName);
+void QHelpCollectionHandler::clearReaders()
+{
+    qDeleteAll(m_readers);
+    m_readers.clear();
+    m_fileDataCache.clear();
 }
 
 QStringList QHelpCollectionHandler::indicesForFilter(const QStringList &filterAttributes) const
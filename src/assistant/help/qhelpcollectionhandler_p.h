@@ -51,6 +51,8 @@
 // We mean it.
 //
 
+#include <QtCore/QCache>
+#include <QtCore/QHash>
 #include <QtCore/QList>
 #include <QtCore/QString>
 #include <QtCore/QObject>
@@ -188,6 +190,8 @@ public:
     QUrl findFile(const QUrl &url,
                   const QString &filterName) const;
     QByteArray fileData(const QUrl &url) const;
+    qint64 fileDataCacheSize() const;
+    void setFileDataCacheSize(qint64 size);
 
 
     QStringList indicesForFilter(const QString &filterName) const;
@@ -239,6 +243,7 @@ private:
     bool createTables(QSqlQuery *query);
     void closeDB();
     bool recreateIndexAndNamespaceFilterTables(QSqlQuery *query);
+    bool createIndexes(QSqlQuery *query);
     bool registerIndexAndNamespaceFilterTables(const QString &nameSpace,
                                                bool createDefaultVersionFilter = false);
     void createVersionFilter(const QString &version);
@@ -252,12 +257,18 @@ private:
     bool hasTimeStampInfo(const QString &nameSpace) const;
     void scheduleVacuum();
     void execVacuum();
+    QHelpDBReader *readerForNamespace(const QString &namespaceName) const;
+    void clearReaders();
 
     QString m_collectionFile;
     QString m_connectionName;
     QSqlQuery *m_query = nullptr;
     bool m_vacuumScheduled = false;
     bool m_readOnly = true;
+    // Open documentation files, by namespace
+    mutable QHash<QString, QHelpDBReader *> m_readers;
+    // Recently read file data, by URL; the cost is the size in bytes
+    mutable QCache<QString, QByteArray> m_fileDataCache;
 };
 
 QT_END_NAMESPACE
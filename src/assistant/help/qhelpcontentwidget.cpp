@@ -43,29 +43,66 @@
 #include "qhelpcollectionhandler_p.h"
 
 #include <QDir>
+#include <QtCore/QDataStream>
+#include <QtCore/QSet>
 #include <QtCore/QStack>
+#include <QtCore/QtEndian>
 #include <QtCore/QThread>
 #include <QtCore/QMutex>
 #include <QtWidgets/QHeaderView>
 
 QT_BEGIN_NAMESPACE
 
+// The serialized contents of a documentation set. The entries only know
+// where their data starts and where their children are listed. Titles and
+// URLs are decoded from the data when they are asked for.
+struct QHelpContentsData
+{
+    struct Entry
+    {
+        quint32 offset;
+        // The children are children[firstChild] to children[firstChild + childCount - 1]
+        qint32 firstChild;
+        qint32 childCount;
+    };
+
+    void readEntry(int entry, QString *link, QString *title) const;
+
+    QString namespaceName;
+    QString folderName;
+    QByteArray data;
+    QList<Entry> entries;
+    QList<qint32> children;
+    QList<int> rootEntries;
+};
+
+// The items below the top level are only created when they are asked
+// for, and refer to their entry instead of holding its title and URL.
 class QHelpContentItemPrivate
 {
 public:
-    QHelpContentItemPrivate(const QString &t, const QUrl &l, QHelpContentItem *p)
+    QHelpContentItemPrivate(QHelpContentItem *p, const QHelpContentsData *c, int e, int r)
         : parent(p),
-          title(t),
-          link(l)
+          contents(c),
+          entry(e),
+          row(r)
     {
     }
 
-    void appendChild(QHelpContentItem *item) { childItems.append(item); }
+    ~QHelpContentItemPrivate() { qDeleteAll(ownedContents); }
+
+    int childCount() const;
+    static QHelpContentItem *createItem(QHelpContentItem *parent,
+                                        const QHelpContentsData *contents, int entry, int row);
 
-    QList<QHelpContentItem*> childItems;
     QHelpContentItem *parent;
-    QString title;
-    QUrl link;
+    // Null until created
+    mutable QList<QHelpContentItem*> childItems;
+    const QHelpContentsData *contents;
+    int entry;
+    int row;
+    // The root item keeps the contents alive.
+    QList<QHelpContentsData *> ownedContents;
 };
 
 class QHelpContentProvider : public QThread
@@ -96,8 +133,32 @@ class QHelpContentModelPrivate
 public:
     QHelpContentItem *rootItem = nullptr;
     QHelpContentProvider *qhelpContentProvider;
+    // The items whose rows were announced by fetchMore()
+    QSet<const QHelpContentItem *> fetchedItems;
 };
 
+// TODO: this is a copy from helpcollectionhandler, make it common
+static QUrl buildQUrl(const QString &ns, const QString &folder,
+                      const QString &relFileName, const QString &anchor)
+{
+    QUrl url;
+    url.setScheme(QLatin1String("qthelp"));
+    url.setAuthority(ns);
+    url.setPath(QLatin1Char('/') + folder + QLatin1Char('/') + relFileName);
+    url.setFragment(anchor);
+    return url;
+}
+
+static QUrl constructUrl(const QString &namespaceName,
+                         const QString &folderName,
+                         const QString &relativePath)
+{
+    const int idx = relativePath.indexOf(QLatin1Char('#'));
+    const QString &rp = idx < 0 ? relativePath : relativePath.left(idx);
+    const QString anchor = idx < 0 ? QString() : relativePath.mid(idx + 1);
+    return buildQUrl(namespaceName, folderName, rp, anchor);
+}
+
 
 
 /*!
@@ -109,7 +170,10 @@ public:
 
 QHelpContentItem::QHelpContentItem(const QString &name, const QUrl &link, QHelpContentItem *parent)
 {
-    d = new QHelpContentItemPrivate(name, link, parent);
+    // Only used for the root item, the others are created from their entries.
+    Q_UNUSED(name);
+    Q_UNUSED(link);
+    d = new QHelpContentItemPrivate(parent, nullptr, -1, 0);
 }
 
 /*!
@@ -128,7 +192,21 @@ QHelpContentItem::~QHelpContentItem()
 */
 QHelpContentItem *QHelpContentItem::child(int row) const
 {
-    return d->childItems.value(row);
+    // The root item holds the top level items of all documentation sets
+    if (!d->contents)
+        return d->childItems.value(row);
+
+    const QHelpContentsData::Entry &entry = d->contents->entries.at(d->entry);
+    if (row < 0 || row >= entry.childCount)
+        return nullptr;
+    if (d->childItems.isEmpty())
+        d->childItems.resize(entry.childCount, nullptr);
+    QHelpContentItem *&item = d->childItems[row];
+    if (!item) {
+        item = QHelpContentItemPrivate::createItem(const_cast<QHelpContentItem *>(this),
+                d->contents, d->contents->children.at(entry.firstChild + row), row);
+    }
+    return item;
 }
 
 /*!
@@ -136,7 +214,7 @@ QHelpContentItem *QHelpContentItem::child(int row) const
 */
 int QHelpContentItem::childCount() const
 {
-    return d->childItems.count();
+    return d->childCount();
 }
 
 /*!
@@ -144,9 +222,7 @@ int QHelpContentItem::childCount() const
 */
 int QHelpContentItem::row() const
 {
-    if (d->parent)
-        return d->parent->d->childItems.indexOf(const_cast<QHelpContentItem*>(this));
-    return 0;
+    return d->row;
 }
 
 /*!
@@ -154,7 +230,12 @@ int QHelpContentItem::row() const
 */
 QString QHelpContentItem::title() const
 {
-    return d->title;
+    if (!d->contents)
+        return QString();
+    QString link;
+    QString title;
+    d->contents->readEntry(d->entry, &link, &title);
+    return title;
 }
 
 /*!
@@ -162,7 +243,12 @@ QString QHelpContentItem::title() const
 */
 QUrl QHelpContentItem::url() const
 {
-    return d->link;
+    if (!d->contents)
+        return QUrl();
+    QString link;
+    QString title;
+    d->contents->readEntry(d->entry, &link, &title);
+    return constructUrl(d->contents->namespaceName, d->contents->folderName, link);
 }
 
 /*!
@@ -178,7 +264,7 @@ QHelpContentItem *QHelpContentItem::parent() const
 */
 int QHelpContentItem::childPosition(QHelpContentItem *child) const
 {
-    return d->childItems.indexOf(child);
+    return child && child->d->parent == this ? child->d->row : -1;
 }
 
 
@@ -233,35 +319,131 @@ QHelpContentItem *QHelpContentProvider::takeContentItem()
     return content;
 }
 
-// TODO: this is a copy from helpcollectionhandler, make it common
-static QUrl buildQUrl(const QString &ns, const QString &folder,
-                      const QString &relFileName, const QString &anchor)
+void QHelpContentsData::readEntry(int entry, QString *link, QString *title) const
 {
-    QUrl url;
-    url.setScheme(QLatin1String("qthelp"));
-    url.setAuthority(ns);
-    url.setPath(QLatin1Char('/') + folder + QLatin1Char('/') + relFileName);
-    url.setFragment(anchor);
-    return url;
+    QDataStream stream(data);
+    stream.device()->seek(entries.at(entry).offset);
+    int depth = 0;
+    stream >> depth;
+    stream >> *link;
+    stream >> *title;
 }
 
-static QUrl constructUrl(const QString &namespaceName,
-                         const QString &folderName,
-                         const QString &relativePath)
+int QHelpContentItemPrivate::childCount() const
 {
-    const int idx = relativePath.indexOf(QLatin1Char('#'));
-    const QString &rp = idx < 0 ? relativePath : relativePath.left(idx);
-    const QString anchor = idx < 0 ? QString() : relativePath.mid(idx + 1);
-    return buildQUrl(namespaceName, folderName, rp, anchor);
+    if (!contents)
+        return childItems.count();
+    return contents->entries.at(entry).childCount;
 }
 
-void QHelpContentProvider::run()
+QHelpContentItem *QHelpContentItemPrivate::createItem(QHelpContentItem *parent,
+                                                      const QHelpContentsData *contents,
+                                                      int entry, int row)
 {
-    QString title;
-    QString link;
-    int depth = 0;
-    QHelpContentItem *item = nullptr;
+    QHelpContentItem *item = new QHelpContentItem(QString(), QUrl(), parent);
+    item->d->contents = contents;
+    item->d->entry = entry;
+    item->d->row = row;
+    return item;
+}
+
+// Returns false if the data ends before the string does.
+static bool skipString(const QByteArray &data, qsizetype *pos, bool *isEmpty)
+{
+    if (data.size() - *pos < 4)
+        return false;
+    const quint32 length = qFromBigEndian<quint32>(data.constData() + *pos);
+    *pos += 4;
+    if (length == 0xffffffff) { // null string
+        *isEmpty = true;
+        return true;
+    }
+    if (length > quint32(data.size() - *pos))
+        return false;
+    *pos += length;
+    *isEmpty = length == 0;
+    return true;
+}
+
+// Builds the tree of entries from the depth, link and title triples
+// serialized by qhelpgenerator, without decoding the strings.
+static void scanContents(QHelpContentsData *contents)
+{
+    const QByteArray &data = contents->data;
+    QList<QHelpContentsData::Entry> &entries = contents->entries;
+    QList<qint32> parents;
+
+    const auto appendChild = [&](int parent, int child) {
+        parents[child] = parent;
+        if (parent < 0)
+            contents->rootEntries.append(child);
+        else
+            ++entries[parent].childCount;
+    };
+
+    int _depth = 0;
+    bool _root = false;
+    int item = -1;
+    QStack<int> stack;
+
+    qsizetype pos = 0;
+    for (;;) {
+        const qsizetype offset = pos;
+        if (data.size() - pos < 4)
+            break;
+        const int depth = qFromBigEndian<qint32>(data.constData() + pos);
+        pos += 4;
+        bool emptyLink = false;
+        bool emptyTitle = false;
+        if (!skipString(data, &pos, &emptyLink) || !skipString(data, &pos, &emptyTitle)
+                || emptyTitle) {
+            break;
+        }
+
+        const int current = entries.count();
+        entries.append({ quint32(offset), 0, 0 });
+        parents.append(-1);
+CHECK_DEPTH:
+        if (depth == 0) {
+            item = current;
+            appendChild(-1, item);
+            stack.push(item);
+            _depth = 1;
+            _root = true;
+        } else {
+            if (depth > _depth && _root) {
+                _depth = depth;
+                stack.push(item);
+            }
+            if (depth == _depth) {
+                item = current;
+                appendChild(stack.top(), item);
+            } else if (depth < _depth) {
+                stack.pop();
+                --_depth;
+                goto CHECK_DEPTH;
+            }
+        }
+    }
+
+    // List the children of each entry next to each other, in their order.
+    qint32 firstChild = 0;
+    for (QHelpContentsData::Entry &entry : entries) {
+        entry.firstChild = firstChild;
+        firstChild += entry.childCount;
+        entry.childCount = 0;
+    }
+    contents->children.resize(firstChild);
+    for (int i = 0; i < entries.count(); ++i) {
+        if (parents.at(i) < 0)
+            continue;
+        QHelpContentsData::Entry &parent = entries[parents.at(i)];
+        contents->children[parent.firstChild + parent.childCount++] = i;
+    }
+}
 
+void QHelpContentProvider::run()
+{
     m_mutex.lock();
     QHelpContentItem * const rootItem = new QHelpContentItem(QString(), QString(), nullptr);
     const QString currentFilter = m_currentFilter;
@@ -293,47 +475,22 @@ void QHelpContentProvider::run()
         }
         m_mutex.unlock();
 
-        const QString namespaceName = contentsData.namespaceName;
-        const QString folderName = contentsData.folderName;
-        for (const QByteArray &contents : contentsData.contentsList)  {
-            if (contents.size() < 1)
+        // Only the top level items are created here, the
+        // others when they are asked for.
+        for (const QByteArray &data : contentsData.contentsList)  {
+            if (data.size() < 1)
                 continue;
 
-            int _depth = 0;
-            bool _root = false;
-            QStack<QHelpContentItem*> stack;
-
-            QDataStream s(contents);
-            for (;;) {
-                s >> depth;
-                s >> link;
-                s >> title;
-                if (title.isEmpty())
-                    break;
-                const QUrl url = constructUrl(namespaceName, folderName, link);
-CHECK_DEPTH:
-                if (depth == 0) {
-                    m_mutex.lock();
-                    item = new QHelpContentItem(title, url, rootItem);
-                    rootItem->d->appendChild(item);
-                    m_mutex.unlock();
-                    stack.push(item);
-                    _depth = 1;
-                    _root = true;
-                } else {
-                    if (depth > _depth && _root) {
-                        _depth = depth;
-                        stack.push(item);
-                    }
-                    if (depth == _depth) {
-                        item = new QHelpContentItem(title, url, stack.top());
-                        stack.top()->d->appendChild(item);
-                    } else if (depth < _depth) {
-                        stack.pop();
-                        --_depth;
-                        goto CHECK_DEPTH;
-                    }
-                }
+            QHelpContentsData *contents = new QHelpContentsData;
+            contents->namespaceName = contentsData.namespaceName;
+            contents->folderName = contentsData.folderName;
+            contents->data = data;
+            scanContents(contents);
+            rootItem->d->ownedContents.append(contents);
+
+            for (int entry : qAsConst(contents->rootEntries)) {
+                rootItem->d->childItems.append(QHelpContentItemPrivate::createItem(
+                        rootItem, contents, entry, rootItem->d->childItems.count()));
             }
         }
     }
@@ -399,6 +556,7 @@ void QHelpContentModel::createContents(const QString &customFilterName)
 
     if (d->rootItem) {
         beginResetModel();
+        d->fetchedItems.clear();
         delete d->rootItem;
         d->rootItem = nullptr;
         endResetModel();
@@ -415,6 +573,7 @@ void QHelpContentModel::insertContents()
     if (!newRootItem)
         return;
     beginResetModel();
+    d->fetchedItems.clear();
     delete d->rootItem;
     d->rootItem = newRootItem;
     endResetModel();
@@ -458,6 +617,42 @@ QModelIndex QHelpContentModel::index(int row, int column, const QModelIndex &par
     return createIndex(row, column, item);
 }
 
+/*!
+    \reimp
+*/
+bool QHelpContentModel::hasChildren(const QModelIndex &parent) const
+{
+    QHelpContentItem *parentItem = contentItemAt(parent);
+    return parentItem && parentItem->d->childCount() > 0;
+}
+
+/*!
+    \reimp
+*/
+bool QHelpContentModel::canFetchMore(const QModelIndex &parent) const
+{
+    // The top level rows are there from the start
+    if (!parent.isValid())
+        return false;
+    QHelpContentItem *parentItem = contentItemAt(parent);
+    return parentItem && parentItem->d->childCount() > 0
+            && !d->fetchedItems.contains(parentItem);
+}
+
+/*!
+    \reimp
+*/
+void QHelpContentModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+
+    const QHelpContentItem *parentItem = contentItemAt(parent);
+    beginInsertRows(parent, 0, parentItem->d->childCount() - 1);
+    d->fetchedItems.insert(parentItem);
+    endInsertRows();
+}
+
 /*!
     Returns the parent of the model item with the given
     \a index, or QModelIndex() if it has no parent.
@@ -488,7 +683,10 @@ int QHelpContentModel::rowCount(const QModelIndex &parent) const
     QHelpContentItem *parentItem = contentItemAt(parent);
     if (!parentItem)
         return 0;
-    return parentItem->childCount();
+    // The rows below the top level are announced by fetchMore()
+    if (parent.isValid() && !d->fetchedItems.contains(parentItem))
+        return 0;
+    return parentItem->d->childCount();
 }
 
 /*!
@@ -574,7 +772,9 @@ bool QHelpContentWidget::searchContentItem(QHelpContentModel *model, const QMode
         return true;
     }
 
-    for (int i = 0; i < parentItem->childCount(); ++i) {
+    if (model->canFetchMore(parent))
+        model->fetchMore(parent);
+    for (int i = 0; i < model->rowCount(parent); ++i) {
         if (searchContentItem(model, model->index(i, 0, parent), cleanPath))
             return true;
     }
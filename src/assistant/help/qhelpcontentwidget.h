@@ -74,6 +74,8 @@ private:
 
     QHelpContentItemPrivate *d;
     friend class QHelpContentProvider;
+    friend class QHelpContentItemPrivate;
+    friend class QHelpContentModel;
 };
 
 class QHELP_EXPORT QHelpContentModel : public QAbstractItemModel
@@ -92,6 +94,9 @@ public:
     QModelIndex parent(const QModelIndex &index) const override;
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
     bool isCreatingContents() const;
 
 Q_SIGNALS:
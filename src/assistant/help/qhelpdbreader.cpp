@@ -39,6 +39,7 @@
 
 #include "qhelpdbreader_p.h"
 #include "qhelp_global.h"
+#include "qhelpfiledatacodec_p.h"
 
 #include <QtCore/QFile>
 #include <QtCore/QList>
@@ -67,6 +68,7 @@ QHelpDBReader::QHelpDBReader(const QString &dbName, const QString &uniqueId,
 QHelpDBReader::~QHelpDBReader()
 {
     if (m_initDone) {
+        delete m_fileDataQuery;
         delete m_query;
         QSqlDatabase::removeDatabase(m_uniqueId);
     }
@@ -420,7 +422,9 @@ QByteArray QHelpDBReader::fileData(const QString &virtualFolder,
         return ba;
 
     namespaceName();
-    m_query->prepare(QLatin1String(
+    if (!m_fileDataQuery) {
+        m_fileDataQuery = new QSqlQuery(QSqlDatabase::database(m_uniqueId));
+        m_fileDataQuery->prepare(QLatin1String(
                     "SELECT "
                         "FileDataTable.Data "
                     "FROM "
@@ -434,13 +438,16 @@ QByteArray QHelpDBReader::fileData(const QString &virtualFolder,
                     "AND FolderTable.Name = ? "
                     "AND FolderTable.NamespaceId = NamespaceTable.Id "
                     "AND NamespaceTable.Name = ?"));
-    m_query->bindValue(0, filePath);
-    m_query->bindValue(1, QString(QLatin1String("./") + filePath));
-    m_query->bindValue(2, virtualFolder);
-    m_query->bindValue(3, m_namespace);
-    m_query->exec();
-    if (m_query->next() && m_query->isValid())
-        ba = qUncompress(m_query->value(0).toByteArray());
+    }
+    m_fileDataQuery->bindValue(0, filePath);
+    m_fileDataQuery->bindValue(1, QString(QLatin1String("./") + filePath));
+    m_fileDataQuery->bindValue(2, virtualFolder);
+    m_fileDataQuery->bindValue(3, m_namespace);
+    m_fileDataQuery->exec();
+    if (m_fileDataQuery->next() && m_fileDataQuery->isValid())
+        ba = QHelpFileDataCodec::uncompress(m_fileDataQuery->value(0).toByteArray(),
+                                            fileDataCodec());
+    m_fileDataQuery->finish();
     return ba;
 }
 
@@ -483,6 +490,19 @@ QStringList QHelpDBReader::filterAttributes(const QString &filterName) const
 
 QMultiMap<QString, QByteArray> QHelpDBReader::filesData(const QStringList &filterAttributes,
                                                         const QString &extensionFilter) const
+{
+    QMultiMap<QString, QByteArray> result = compressedFilesData(filterAttributes, extensionFilter);
+    const int codec = fileDataCodec();
+    for (auto it = result.begin(), end = result.end(); it != end; ++it)
+        it.value() = QHelpFileDataCodec::uncompress(it.value(), codec);
+    return result;
+}
+
+// With withoutSearchText, only the files that have no entry in
+// the SearchTextTable written by qhelpgenerator are returned.
+QMultiMap<QString, QByteArray> QHelpDBReader::compressedFilesData(const QStringList &filterAttributes,
+                                                                  const QString &extensionFilter,
+                                                                  bool withoutSearchText) const
 {
     QMultiMap<QString, QByteArray> result;
     if (!m_query)
@@ -493,6 +513,10 @@ QMultiMap<QString, QByteArray> QHelpDBReader::filesData(const QStringList &filte
     if (!extensionFilter.isEmpty())
         extension = QString(QLatin1String("AND FileNameTable.Name "
                                           "LIKE \'%.%1\'")).arg(extensionFilter);
+    if (withoutSearchText) {
+        extension.append(QLatin1String(" AND FileNameTable.FileId NOT IN "
+                                       "(SELECT FileId FROM SearchTextTable)"));
+    }
 
     if (filterAttributes.isEmpty()) {
         query = QString(QLatin1String("SELECT "
@@ -530,7 +554,75 @@ QMultiMap<QString, QByteArray> QHelpDBReader::filesData(const QStringList &filte
     }
     m_query->exec(query);
     while (m_query->next())
-        result.insert(m_query->value(0).toString(), qUncompress(m_query->value(1).toByteArray()));
+        result.insert(m_query->value(0).toString(), m_query->value(1).toByteArray());
+
+    return result;
+}
+
+// Files written before the codec became configurable lack the entry and use zlib.
+int QHelpDBReader::fileDataCodec() const
+{
+    if (m_fileDataCodec < 0) {
+        m_fileDataCodec = metaData(QLatin1String("fileDataCodec")).toInt();
+        if (!QHelpFileDataCodec::isSupported(m_fileDataCodec)) {
+            qWarning("The file data of %s uses codec %d, which is not supported by this "
+                     "version of Qt Help.", qPrintable(m_dbName), m_fileDataCodec);
+        }
+    }
+    return m_fileDataCodec;
+}
+
+int QHelpDBReader::searchTextVersion() const
+{
+    return metaData(QLatin1String("searchTextVersion")).toInt();
+}
+
+QList<QHelpDBReader::SearchText> QHelpDBReader::searchTexts(const QStringList &filterAttributes,
+                                                           const QString &extensionFilter) const
+{
+    QList<SearchText> result;
+    if (!m_query)
+        return result;
+
+    QString query = QString(QLatin1String("SELECT "
+                                              "FileNameTable.Name, "
+                                              "SearchTextTable.Title, "
+                                              "SearchTextTable.Contents "
+                                          "FROM "
+                                              "FolderTable, "
+                                              "FileNameTable, "
+                                              "SearchTextTable "
+                                          "WHERE SearchTextTable.FileId = FileNameTable.FileId "
+                                          "AND FileNameTable.FolderId = FolderTable.Id "
+                                          "AND FileNameTable.Name LIKE \'%.%1\'"))
+            .arg(extensionFilter);
+
+    if (!filterAttributes.isEmpty()) {
+        query.append(QLatin1String(" AND FileNameTable.FileId IN ("));
+        for (int i = 0; i < filterAttributes.count(); ++i) {
+            if (i > 0)
+                query.append(QLatin1String(" INTERSECT "));
+            query.append(QString(QLatin1String(
+                                     "SELECT "
+                                         "FileFilterTable.FileId "
+                                     "FROM "
+                                         "FileFilterTable, "
+                                         "FilterAttributeTable "
+                                     "WHERE FileFilterTable.FilterAttributeId = FilterAttributeTable.Id "
+                                     "AND FilterAttributeTable.Name = \'%1\'"))
+                         .arg(quote(filterAttributes.at(i))));
+        }
+        query.append(QLatin1Char(')'));
+    }
+
+    m_query->exec(query);
+    while (m_query->next()) {
+        SearchText text;
+        text.name = m_query->value(0).toString();
+        text.title = m_query->value(1).toString();
+        text.contents = m_query->value(2).toString();
+        result.append(text);
+    }
 
     return result;
 }
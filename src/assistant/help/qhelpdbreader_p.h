@@ -94,6 +94,15 @@ public:
         QStringList filterAttributes;
     };
 
+    class SearchText
+    {
+    public:
+        SearchText() = default;
+        QString name;
+        QString title;
+        QString contents;
+    };
+
     class IndexTable
     {
     public:
@@ -117,8 +126,15 @@ public:
     QList<QStringList> filterAttributeSets() const;
     QMultiMap<QString, QByteArray> filesData(const QStringList &filterAttributes,
                                              const QString &extensionFilter = QString()) const;
+    QMultiMap<QString, QByteArray> compressedFilesData(const QStringList &filterAttributes,
+                                                       const QString &extensionFilter = QString(),
+                                                       bool withoutSearchText = false) const;
     QByteArray fileData(const QString &virtualFolder,
         const QString &filePath) const;
+    int fileDataCodec() const;
+    int searchTextVersion() const;
+    QList<SearchText> searchTexts(const QStringList &filterAttributes,
+                                  const QString &extensionFilter) const;
 
     QStringList customFilters() const;
     QStringList filterAttributes(const QString &filterName = QString()) const;
@@ -135,7 +151,10 @@ private:
     QString m_uniqueId;
     QString m_error;
     QSqlQuery *m_query = nullptr;
+    // Kept prepared, as file data is read over and over again
+    mutable QSqlQuery *m_fileDataQuery = nullptr;
     mutable QString m_namespace;
+    mutable int m_fileDataCodec = -1;
 };
 
 QT_END_NAMESPACE
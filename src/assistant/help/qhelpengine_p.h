@@ -90,6 +90,7 @@ public:
     bool autoSaveFilter = true;
     bool usesFilterEngine = false;
     bool readOnly = true;
+    qint64 fileDataCacheSize = -1;
 
 protected:
     QHelpEngineCore *q;
@@ -62,6 +62,8 @@ void QHelpEngineCorePrivate::init(const QString &collectionFile,
     connect(collectionHandler, &QHelpCollectionHandler::error,
             this, &QHelpEngineCorePrivate::errorReceived);
     filterEngine->setCollectionHandler(collectionHandler);
+    if (fileDataCacheSize >= 0)
+        collectionHandler->setFileDataCacheSize(fileDataCacheSize);
     needsSetup = true;
 }
 
@@ -648,6 +650,37 @@ QByteArray QHelpEngineCore::fileData(const QUrl &url) const
     return d->collectionHandler->fileData(url);
 }
 
+/*!
+    \since 6.0
+
+    Returns the maximum number of bytes of file data that are kept in
+    memory, so that files which are requested again by fileData() do not
+    need to be read from the documentation files.
+
+    The default is 16 MB.
+
+    \sa setFileDataCacheSize()
+*/
+qint64 QHelpEngineCore::fileDataCacheSize() const
+{
+    return d->collectionHandler->fileDataCacheSize();
+}
+
+/*!
+    \since 6.0
+
+    Sets the maximum number of bytes of file data that are kept in memory
+    to \a size. The least recently used files are dropped first. A
+    \a size of \c 0 disables caching.
+
+    \sa fileDataCacheSize(), fileData()
+*/
+void QHelpEngineCore::setFileDataCacheSize(qint64 size)
+{
+    d->fileDataCacheSize = qMax(size, qint64(0));
+    d->collectionHandler->setFileDataCacheSize(d->fileDataCacheSize);
+}
+
 /*!
     \since 5.15
 
@@ -85,6 +85,8 @@ public:
     QString documentationFileName(const QString &namespaceName);
     QStringList registeredDocumentations() const;
     QByteArray fileData(const QUrl &url) const;
+    qint64 fileDataCacheSize() const;
+    void setFileDataCacheSize(qint64 size);
 
 #if QT_DEPRECATED_SINCE(5,13)
     QStringList customFilters() const;
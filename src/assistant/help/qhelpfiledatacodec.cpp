@@ -0,0 +1,158 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Assistant of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qhelpfiledatacodec_p.h"
+
+#include <QtCore/private/qglobal_p.h>
+
+#if QT_CONFIG(zstd)
+#  include <zstd.h>
+
+#  include <limits>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \internal
+    \class QHelpFileDataCodec
+
+    Compresses and uncompresses the file data stored in .qch files. The
+    codec of a .qch file is recorded in its MetaDataTable, so that files
+    written before the codec became configurable, which lack the entry,
+    are read with zlib as before.
+
+    Zstandard is only available when Qt was built with zstd support. It
+    uncompresses several times faster than zlib, which shows when pages
+    are loaded and especially when the full text search index is built,
+    as that uncompresses every page.
+*/
+
+#if QT_CONFIG(zstd)
+// Uncompression speed hardly depends on the level, so favor size
+// as long as generating large documentation sets stays fast.
+static const int zstdLevel = 12;
+#endif
+
+/*!
+    Returns whether this build of Qt Help can read and write \a codec.
+*/
+bool QHelpFileDataCodec::isSupported(int codec)
+{
+    switch (codec) {
+    case Zlib:
+        return true;
+    case Zstd:
+#if QT_CONFIG(zstd)
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+/*!
+    Returns the codec called \a name, or -1 if there is none.
+*/
+int QHelpFileDataCodec::codecFromName(const QString &name)
+{
+    if (name == QLatin1String("zlib"))
+        return Zlib;
+    if (name == QLatin1String("zstd"))
+        return Zstd;
+    return -1;
+}
+
+QByteArray QHelpFileDataCodec::compress(const QByteArray &data, int codec)
+{
+    switch (codec) {
+    case Zlib:
+        return qCompress(data);
+    case Zstd: {
+#if QT_CONFIG(zstd)
+        QByteArray result(int(ZSTD_compressBound(size_t(data.size()))), Qt::Uninitialized);
+        const size_t size = ZSTD_compress(result.data(), size_t(result.size()),
+                                          data.constData(), size_t(data.size()), zstdLevel);
+        if (ZSTD_isError(size))
+            return QByteArray();
+        result.truncate(int(size));
+        result.squeeze();
+        return result;
+#else
+        break;
+#endif
+    }
+    }
+    return QByteArray();
+}
+
+/*!
+    Returns the uncompressed \a data, or an empty byte array if the data
+    is corrupt or \a codec is not supported.
+*/
+QByteArray QHelpFileDataCodec::uncompress(const QByteArray &data, int codec)
+{
+    switch (codec) {
+    case Zlib:
+        return qUncompress(data);
+    case Zstd: {
+#if QT_CONFIG(zstd)
+        // The generator always writes the content size into the frame.
+        const unsigned long long contentSize =
+                ZSTD_getFrameContentSize(data.constData(), size_t(data.size()));
+        if (contentSize == ZSTD_CONTENTSIZE_UNKNOWN || contentSize == ZSTD_CONTENTSIZE_ERROR
+                || contentSize > unsigned(std::numeric_limits<int>::max())) {
+            return QByteArray();
+        }
+        QByteArray result(int(contentSize), Qt::Uninitialized);
+        const size_t size = ZSTD_decompress(result.data(), size_t(result.size()),
+                                            data.constData(), size_t(data.size()));
+        if (ZSTD_isError(size) || size != contentSize)
+            return QByteArray();
+        return result;
+#else
+        break;
+#endif
+    }
+    }
+    return QByteArray();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,622 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Assistant of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qhelphtmltextextractor_p.h"
+
+#include <QtCore/QStringDecoder>
+#include <QtCore/QTextStream>
+#include <QtGui/QTextDocumentFragment>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \internal
+    \class QHelpHtmlTextExtractor
+
+    Extracts the title and the visible text of an HTML page in a single
+    pass over its data, without building a document. The contents of script
+    and style elements and everything inside the head apart from the title
+    are skipped, and character references are decoded; the few named ones
+    missing from the built-in table are looked up with QTextDocument. The
+    first title element counts, wherever it is. Runs of whitespace
+    collapse into a single space and block elements start a new line, much
+    like QTextDocument::toPlainText() does.
+*/
+
+namespace {
+
+struct Entity
+{
+    const char *name;
+    char16_t value;
+};
+
+// Sorted by name, a value of 0 is dropped from the output.
+const Entity entities[] = {
+    { "AElig", 0x00c6 },
+    { "Aacute", 0x00c1 },
+    { "Agrave", 0x00c0 },
+    { "Auml", 0x00c4 },
+    { "Ccedil", 0x00c7 },
+    { "Eacute", 0x00c9 },
+    { "Ouml", 0x00d6 },
+    { "Uuml", 0x00dc },
+    { "aacute", 0x00e1 },
+    { "acirc", 0x00e2 },
+    { "aelig", 0x00e6 },
+    { "agrave", 0x00e0 },
+    { "amp", 0x0026 },
+    { "apos", 0x0027 },
+    { "aring", 0x00e5 },
+    { "auml", 0x00e4 },
+    { "bull", 0x2022 },
+    { "ccedil", 0x00e7 },
+    { "cent", 0x00a2 },
+    { "copy", 0x00a9 },
+    { "deg", 0x00b0 },
+    { "divide", 0x00f7 },
+    { "eacute", 0x00e9 },
+    { "ecirc", 0x00ea },
+    { "egrave", 0x00e8 },
+    { "euml", 0x00eb },
+    { "euro", 0x20ac },
+    { "ge", 0x2265 },
+    { "gt", 0x003e },
+    { "hellip", 0x2026 },
+    { "iacute", 0x00ed },
+    { "laquo", 0x00ab },
+    { "larr", 0x2190 },
+    { "ldquo", 0x201c },
+    { "le", 0x2264 },
+    { "lsaquo", 0x2039 },
+    { "lsquo", 0x2018 },
+    { "lt", 0x003c },
+    { "mdash", 0x2014 },
+    { "micro", 0x00b5 },
+    { "middot", 0x00b7 },
+    { "nbsp", 0x0020 },
+    { "ndash", 0x2013 },
+    { "ne", 0x2260 },
+    { "ntilde", 0x00f1 },
+    { "oacute", 0x00f3 },
+    { "ocirc", 0x00f4 },
+    { "ouml", 0x00f6 },
+    { "para", 0x00b6 },
+    { "plusmn", 0x00b1 },
+    { "pound", 0x00a3 },
+    { "quot", 0x0022 },
+    { "raquo", 0x00bb },
+    { "rarr", 0x2192 },
+    { "rdquo", 0x201d },
+    { "reg", 0x00ae },
+    { "rsaquo", 0x203a },
+    { "rsquo", 0x2019 },
+    { "sect", 0x00a7 },
+    { "shy", 0x0000 },
+    { "szlig", 0x00df },
+    { "times", 0x00d7 },
+    { "trade", 0x2122 },
+    { "uacute", 0x00fa },
+    { "uuml", 0x00fc },
+    { "yen", 0x00a5 },
+};
+
+// Sorted, starting a new line.
+const char *const blockElements[] = {
+    "address", "article", "aside", "blockquote", "br", "caption", "dd", "div",
+    "dl", "dt", "figcaption", "figure", "footer", "form", "h1", "h2", "h3", "h4",
+    "h5", "h6", "header", "hr", "li", "main", "nav", "ol", "p", "section",
+    "table", "tbody", "td", "tfoot", "th", "thead", "tr", "ul"
+};
+
+const int maxEntityNameLength = 10;
+const int maxTagNameLength = 10;
+
+inline char16_t unit(char c) { return uchar(c); }
+inline char16_t unit(QChar c) { return c.unicode(); }
+
+inline bool isSpace(char16_t c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+inline char16_t asciiLower(char16_t c)
+{
+    return c >= 'A' && c <= 'Z' ? char16_t(c + ('a' - 'A')) : c;
+}
+
+inline bool isAsciiLetter(char16_t c)
+{
+    const char16_t l = asciiLower(c);
+    return l >= 'a' && l <= 'z';
+}
+
+inline bool isAsciiLetterOrDigit(char16_t c)
+{
+    return isAsciiLetter(c) || (c >= '0' && c <= '9');
+}
+
+inline bool lessThan(const char *a, const char *b)
+{
+    return qstrcmp(a, b) < 0;
+}
+
+// Sets text to the text of the entity name, returns false if it is unknown.
+bool lookUpEntity(const char *name, QString *text)
+{
+    const Entity *end = entities + sizeof(entities) / sizeof(entities[0]);
+    const Entity *entity = std::lower_bound(entities, end, name,
+                                            [](const Entity &e, const char *n) {
+        return lessThan(e.name, n);
+    });
+    if (entity != end && qstrcmp(entity->name, name) == 0) {
+        if (entity->value)
+            *text = QChar(entity->value);
+        return true;
+    }
+
+    // The table only holds the entities that are common in documentation,
+    // QTextDocument knows all of HTML 4.
+    const QString reference = QLatin1Char('&') + QLatin1String(name) + QLatin1Char(';');
+    *text = QTextDocumentFragment::fromHtml(reference).toPlainText();
+    return *text != reference;
+}
+
+template <typename Char>
+class HtmlScanner
+{
+public:
+    HtmlScanner(const Char *begin, const Char *end, QString *title, QString *text)
+        : m_begin(begin), m_end(end), m_title(title), m_text(text)
+    {
+        if (m_text)
+            m_text->clear();
+    }
+
+    void setDecoder(QStringDecoder *decoder) { m_decoder = decoder; }
+    void scan();
+
+private:
+    const Char *parseReference(const Char *p);
+    const Char *parseMarkup(const Char *p);
+    const Char *handleTag(const char *name, bool closing, bool selfClosing, const Char *next);
+    const Char *skipTag(const Char *p) const;
+    const Char *skipRawText(const Char *p, const char *name) const;
+    bool startsWith(const Char *p, const char *s) const;
+
+    bool wantsText() const { return m_inTitle || (m_text && !m_inHead); }
+    void appendRun(const char *from, const char *to);
+    void appendRun(const QChar *from, const QChar *to);
+    template <typename T>
+    void appendUnits(const T *from, const T *to);
+    void appendCodePoint(char32_t c);
+    void appendChar(char16_t c);
+    void lineBreak();
+
+    const Char *m_begin;
+    const Char *m_end;
+    QString *m_title;
+    QString *m_text;
+    QStringDecoder *m_decoder = nullptr;
+    QString m_titleText;
+    int m_preDepth = 0;
+    bool m_inTitle = false;
+    bool m_titleSeen = false;
+    bool m_inHead = false;
+    bool m_pendingSpace = false;
+    bool m_done = false;
+};
+
+template <typename Char>
+void HtmlScanner<Char>::scan()
+{
+    const Char *p = m_begin;
+    while (p < m_end && !m_done) {
+        const Char *run = p;
+        while (p < m_end && unit(*p) != '<' && unit(*p) != '&')
+            ++p;
+        appendRun(run, p);
+        if (p == m_end)
+            break;
+        p = unit(*p) == '&' ? parseReference(p) : parseMarkup(p);
+    }
+
+    if (m_title)
+        *m_title = m_titleText.simplified();
+    if (m_text) {
+        while (m_text->endsWith(QLatin1Char('\n')))
+            m_text->chop(1);
+    }
+}
+
+template <typename Char>
+const Char *HtmlScanner<Char>::parseReference(const Char *p)
+{
+    const Char *q = p + 1;
+    if (q < m_end && unit(*q) == '#') {
+        ++q;
+        const bool hex = q < m_end && asciiLower(unit(*q)) == 'x';
+        if (hex)
+            ++q;
+        const Char *digits = q;
+        char32_t value = 0;
+        for (; q < m_end; ++q) {
+            const char16_t c = asciiLower(unit(*q));
+            char32_t digit;
+            if (c >= '0' && c <= '9')
+                digit = c - '0';
+            else if (hex && c >= 'a' && c <= 'f')
+                digit = c - 'a' + 10;
+            else
+                break;
+            if (value <= 0x10ffff)
+                value = value * (hex ? 16 : 10) + digit;
+        }
+        if (q == digits) {
+            appendChar('&');
+            return p + 1;
+        }
+        if (q < m_end && unit(*q) == ';')
+            ++q;
+        if (value == 0 || value > 0x10ffff || (value >= 0xd800 && value <= 0xdfff))
+            value = QChar::ReplacementCharacter;
+        appendCodePoint(value);
+        return q;
+    }
+
+    char name[maxEntityNameLength + 1];
+    int length = 0;
+    while (q < m_end && length < maxEntityNameLength && isAsciiLetterOrDigit(unit(*q)))
+        name[length++] = char(unit(*q++));
+    if (length > 0 && q < m_end && unit(*q) == ';') {
+        name[length] = '\0';
+        QString text;
+        if (lookUpEntity(name, &text)) {
+            appendUnits(text.constData(), text.constData() + text.size());
+            return q + 1;
+        }
+    }
+    appendChar('&');
+    return p + 1;
+}
+
+template <typename Char>
+const Char *HtmlScanner<Char>::parseMarkup(const Char *p)
+{
+    const Char *q = p + 1;
+    if (q < m_end && unit(*q) == '!') {
+        if (startsWith(q + 1, "--")) {
+            for (q += 3; q < m_end; ++q) {
+                if (unit(*q) == '>' && q - p >= 6 && unit(q[-1]) == '-' && unit(q[-2]) == '-')
+                    return q + 1;
+            }
+            return m_end;
+        }
+        return skipTag(q);
+    }
+    if (q < m_end && unit(*q) == '?')
+        return skipTag(q);
+
+    const bool closing = q < m_end && unit(*q) == '/';
+    if (closing)
+        ++q;
+    if (q == m_end || !isAsciiLetter(unit(*q))) {
+        appendChar('<');
+        return p + 1;
+    }
+
+    char name[maxTagNameLength + 1];
+    int length = 0;
+    for (; q < m_end && isAsciiLetterOrDigit(unit(*q)); ++q) {
+        if (length < maxTagNameLength)
+            name[length] = char(asciiLower(unit(*q)));
+        ++length;
+    }
+    // Longer names are none of the ones we are interested in.
+    name[length <= maxTagNameLength ? length : 0] = '\0';
+
+    const Char *next = skipTag(q);
+    const bool selfClosing = next - q >= 2 && unit(next[-1]) == '>' && unit(next[-2]) == '/';
+    return handleTag(name, closing, selfClosing, next);
+}
+
+template <typename Char>
+const Char *HtmlScanner<Char>::handleTag(const char *name, bool closing, bool selfClosing,
+                                         const Char *next)
+{
+    if (qstrcmp(name, "title") == 0) {
+        if (!closing && !m_titleSeen) {
+            m_inTitle = true;
+        } else if (closing && m_inTitle) {
+            m_inTitle = false;
+            m_titleSeen = true;
+            if (!m_text)
+                m_done = true;
+        }
+    } else if (qstrcmp(name, "head") == 0) {
+        m_inHead = !closing;
+    } else if (qstrcmp(name, "body") == 0) {
+        m_inHead = false;
+    } else if (qstrcmp(name, "script") == 0 || qstrcmp(name, "style") == 0) {
+        if (!closing && !selfClosing)
+            return skipRawText(next, name);
+    } else if (qstrcmp(name, "pre") == 0) {
+        lineBreak();
+        if (!closing)
+            ++m_preDepth;
+        else if (m_preDepth > 0)
+            --m_preDepth;
+    } else if (std::binary_search(std::begin(blockElements), std::end(blockElements),
+                                  name, lessThan)) {
+        lineBreak();
+    }
+    return next;
+}
+
+template <typename Char>
+const Char *HtmlScanner<Char>::skipTag(const Char *p) const
+{
+    // Quotes only matter in attribute values, where they follow a '='.
+    char16_t quote = 0;
+    char16_t previous = 0;
+    for (; p < m_end; ++p) {
+        const char16_t c = unit(*p);
+        if (quote) {
+            if (c == quote)
+                quote = 0;
+        } else if ((c == '"' || c == '\'') && previous == '=') {
+            quote = c;
+        } else if (c == '>') {
+            return p + 1;
+        }
+        if (!isSpace(c))
+            previous = c;
+    }
+    return m_end;
+}
+
+template <typename Char>
+const Char *HtmlScanner<Char>::skipRawText(const Char *p, const char *name) const
+{
+    for (; p < m_end; ++p) {
+        if (unit(*p) == '<' && p + 1 < m_end && unit(p[1]) == '/' && startsWith(p + 2, name))
+            return skipTag(p + 2);
+    }
+    return m_end;
+}
+
+template <typename Char>
+bool HtmlScanner<Char>::startsWith(const Char *p, const char *s) const
+{
+    for (; *s; ++s, ++p) {
+        if (p >= m_end || asciiLower(unit(*p)) != char16_t(*s))
+            return false;
+    }
+    return true;
+}
+
+template <typename Char>
+void HtmlScanner<Char>::appendRun(const char *from, const char *to)
+{
+    if (from == to || !wantsText())
+        return;
+    if (m_decoder && std::any_of(from, to, [](char c) { return uchar(c) >= 0x80; })) {
+        const QString decoded = (*m_decoder)(QByteArray::fromRawData(from, int(to - from)));
+        appendUnits(decoded.constData(), decoded.constData() + decoded.size());
+    } else {
+        appendUnits(from, to);
+    }
+}
+
+template <typename Char>
+void HtmlScanner<Char>::appendRun(const QChar *from, const QChar *to)
+{
+    if (from != to && wantsText())
+        appendUnits(from, to);
+}
+
+template <typename Char>
+template <typename T>
+void HtmlScanner<Char>::appendUnits(const T *from, const T *to)
+{
+    for (; from != to; ++from)
+        appendChar(unit(*from));
+}
+
+template <typename Char>
+void HtmlScanner<Char>::appendCodePoint(char32_t c)
+{
+    if (QChar::requiresSurrogates(c)) {
+        appendChar(QChar::highSurrogate(c));
+        appendChar(QChar::lowSurrogate(c));
+    } else {
+        appendChar(char16_t(c));
+    }
+}
+
+template <typename Char>
+void HtmlScanner<Char>::appendChar(char16_t c)
+{
+    if (m_inTitle) {
+        m_titleText.append(QChar(c));
+        return;
+    }
+    if (!m_text || m_inHead)
+        return;
+
+    if (m_preDepth > 0) {
+        if (c != '\r')
+            m_text->append(QChar(c));
+        return;
+    }
+    if (isSpace(c)) {
+        m_pendingSpace = true;
+        return;
+    }
+    if (m_pendingSpace) {
+        m_pendingSpace = false;
+        if (!m_text->isEmpty() && !m_text->endsWith(QLatin1Char('\n')))
+            m_text->append(QLatin1Char(' '));
+    }
+    m_text->append(QChar(c));
+}
+
+template <typename Char>
+void HtmlScanner<Char>::lineBreak()
+{
+    if (m_inTitle || !m_text || m_inHead)
+        return;
+    m_pendingSpace = false;
+    if (!m_text->isEmpty() && !m_text->endsWith(QLatin1Char('\n')))
+        m_text->append(QLatin1Char('\n'));
+}
+
+void extractFromString(const QString &html, QString *title, QString *text)
+{
+    HtmlScanner<QChar> scanner(html.constData(), html.constData() + html.size(), title, text);
+    scanner.scan();
+}
+
+void extractFromBytes(const QByteArray &html, QString *title, QString *text)
+{
+    const auto encoding = QStringDecoder::encodingForHtml(html.constData(), html.size());
+    QStringDecoder decoder(encoding ? *encoding : QStringDecoder::Utf8);
+    switch (encoding ? *encoding : QStringDecoder::Utf8) {
+    case QStringDecoder::Utf16:
+    case QStringDecoder::Utf16LE:
+    case QStringDecoder::Utf16BE:
+    case QStringDecoder::Utf32:
+    case QStringDecoder::Utf32LE:
+    case QStringDecoder::Utf32BE:
+        // Markup is not ASCII in these, decode everything up front.
+        extractFromString(decoder(html), title, text);
+        return;
+    default:
+        break;
+    }
+
+    HtmlScanner<char> scanner(html.constData(), html.constData() + html.size(), title, text);
+    scanner.setDecoder(&decoder);
+    scanner.scan();
+}
+
+} // namespace
+
+/*!
+    Returns the simplified title of the HTML page \a html, or an empty string
+    if it has none. The encoding is detected like QStringDecoder::encodingForHtml()
+    does, defaulting to UTF-8. Scanning stops at the end of the title.
+*/
+QString QHelpHtmlTextExtractor::title(const QByteArray &html)
+{
+    QString result;
+    extractFromBytes(html, &result, nullptr);
+    return result;
+}
+
+/*!
+    \overload
+*/
+QString QHelpHtmlTextExtractor::title(const QString &html)
+{
+    QString result;
+    extractFromString(html, &result, nullptr);
+    return result;
+}
+
+/*!
+    Stores the simplified title of the HTML page \a html in \a title and its
+    visible text in \a text.
+*/
+void QHelpHtmlTextExtractor::extract(const QByteArray &html, QString *title, QString *text)
+{
+    Q_ASSERT(title && text);
+    extractFromBytes(html, title, text);
+}
+
+/*!
+    \overload
+*/
+void QHelpHtmlTextExtractor::extract(const QString &html, QString *title, QString *text)
+{
+    Q_ASSERT(title && text);
+    extractFromString(html, title, text);
+}
+
+/*!
+    Extracts the \a title and \a contents of the file \a fileName with
+    the given \a data the way the full text search index stores them,
+    HTML escaped. Text files are titled by their name. Returns \c false
+    if there is nothing to index.
+*/
+bool QHelpHtmlTextExtractor::extractSearchText(const QString &fileName, const QByteArray &data,
+                                               QString *title, QString *contents)
+{
+    if (data.isEmpty())
+        return false;
+
+    if (fileName.endsWith(QLatin1String(".txt"))) {
+        QTextStream s(data);
+        auto encoding = QStringDecoder::encodingForHtml(data.constData(), data.size());
+        if (encoding)
+            s.setEncoding(*encoding);
+
+        const QString &text = s.readAll();
+        if (text.isEmpty())
+            return false;
+
+        *title = fileName.mid(fileName.lastIndexOf(QLatin1Char('/')) + 1);
+        *contents = text.toHtmlEscaped();
+        return true;
+    }
+
+    QString plainTitle;
+    QString text;
+    extract(data, &plainTitle, &text);
+    if (plainTitle.isEmpty() && text.isEmpty())
+        return false;
+
+    *title = plainTitle.toHtmlEscaped();
+    *contents = text.toHtmlEscaped();
+    return true;
+}
+
+QT_END_NAMESPACE
@@ -45,6 +45,7 @@
 
 #include <QtCore/QThread>
 #include <QtCore/QMutex>
+#include <QtCore/QVarLengthArray>
 #include <QtHelp/QHelpLink>
 #include <QtWidgets/QListView>
 #include <QtWidgets/QHeaderView>
@@ -53,6 +54,119 @@
 
 QT_BEGIN_NAMESPACE
 
+// Case folded copies of the keywords together with a trigram index,
+// which finds the keywords containing a string without comparing it
+// with every keyword. The trigrams are hashed into a fixed number of
+// buckets, the candidates found are verified.
+class QHelpKeywordIndex
+{
+public:
+    void build(const QStringList &keywords);
+    QList<int> keywordsContaining(const QString &foldedFilter,
+                                  const QList<int> *candidates = nullptr) const;
+    const QString &foldedKeyword(int i) const { return m_foldedKeywords.at(i); }
+
+private:
+    static const int BucketCount = 1 << 16;
+
+    static int bucket(const QChar *trigram)
+    {
+        const quint32 hash = trigram[0].unicode() * 0x9e3779b1u
+                ^ trigram[1].unicode() * 0x85ebca77u
+                ^ trigram[2].unicode() * 0xc2b2ae3du;
+        return int(hash >> 16);
+    }
+
+    using Buckets = QVarLengthArray<int, 64>;
+    static void keywordBuckets(const QString &foldedKeyword, Buckets *buckets);
+
+    QStringList m_foldedKeywords;
+    // The keywords having a trigram of bucket i are stored
+    // in m_postings from m_offsets[i] to m_offsets[i + 1].
+    QList<int> m_offsets;
+    QList<int> m_postings;
+};
+
+void QHelpKeywordIndex::keywordBuckets(const QString &foldedKeyword, Buckets *buckets)
+{
+    buckets->clear();
+    const QChar *data = foldedKeyword.constData();
+    for (qsizetype i = 0; i + 3 <= foldedKeyword.size(); ++i)
+        buckets->append(bucket(data + i));
+    std::sort(buckets->begin(), buckets->end());
+    buckets->erase(std::unique(buckets->begin(), buckets->end()), buckets->end());
+}
+
+void QHelpKeywordIndex::build(const QStringList &keywords)
+{
+    m_foldedKeywords.clear();
+    m_foldedKeywords.reserve(keywords.count());
+    for (const QString &keyword : keywords)
+        m_foldedKeywords.append(keyword.toCaseFolded());
+
+    // Counting sort: count the keywords per bucket, then fill them in.
+    // The keywords of a bucket end up in their original order.
+    m_offsets = QList<int>(BucketCount + 1, 0);
+    Buckets buckets;
+    for (const QString &keyword : qAsConst(m_foldedKeywords)) {
+        keywordBuckets(keyword, &buckets);
+        for (int b : qAsConst(buckets))
+            ++m_offsets[b + 1];
+    }
+    for (int b = 0; b < BucketCount; ++b)
+        m_offsets[b + 1] += m_offsets.at(b);
+
+    m_postings = QList<int>(m_offsets.last());
+    QList<int> next = m_offsets;
+    for (int i = 0; i < m_foldedKeywords.count(); ++i) {
+        keywordBuckets(m_foldedKeywords.at(i), &buckets);
+        for (int b : qAsConst(buckets))
+            m_postings[next[b]++] = i;
+    }
+}
+
+// Returns the positions of the keywords containing foldedFilter in
+// ascending order. If candidates are given, for example the result for
+// a part of foldedFilter, only they are checked.
+QList<int> QHelpKeywordIndex::keywordsContaining(const QString &foldedFilter,
+                                                 const QList<int> *candidates) const
+{
+    QList<int> result;
+
+    int first = 0;
+    int last = -1;
+    if (foldedFilter.size() >= 3 && !m_offsets.isEmpty()) {
+        // Checking the keywords of the smallest bucket is enough.
+        const QChar *data = foldedFilter.constData();
+        for (qsizetype i = 0; i + 3 <= foldedFilter.size(); ++i) {
+            const int b = bucket(data + i);
+            if (last < 0 || m_offsets.at(b + 1) - m_offsets.at(b) < last - first) {
+                first = m_offsets.at(b);
+                last = m_offsets.at(b + 1);
+            }
+        }
+    }
+
+    if (candidates && (last < 0 || candidates->count() <= last - first)) {
+        for (int i : *candidates) {
+            if (m_foldedKeywords.at(i).contains(foldedFilter))
+                result.append(i);
+        }
+    } else if (last >= 0) {
+        for (int p = first; p < last; ++p) {
+            const int i = m_postings.at(p);
+            if (m_foldedKeywords.at(i).contains(foldedFilter))
+                result.append(i);
+        }
+    } else {
+        for (int i = 0; i < m_foldedKeywords.count(); ++i) {
+            if (m_foldedKeywords.at(i).contains(foldedFilter))
+                result.append(i);
+        }
+    }
+    return result;
+}
+
 class QHelpIndexProvider : public QThread
 {
 public:
@@ -61,6 +175,7 @@ public:
     void collectIndices(const QString &customFilterName);
     void stopCollecting();
     QStringList indices() const;
+    QHelpKeywordIndex keywordIndex() const;
 
 private:
     void run() override;
@@ -69,6 +184,7 @@ private:
     QString m_currentFilter;
     QStringList m_filterAttributes;
     QStringList m_indices;
+    QHelpKeywordIndex m_keywordIndex;
     mutable QMutex m_mutex;
 };
 
@@ -84,6 +200,11 @@ public:
     QHelpEnginePrivate *helpEngine;
     QHelpIndexProvider *indexProvider;
     QStringList indices;
+    QHelpKeywordIndex keywordIndex;
+    // The last filter applied without wildcard and its matches,
+    // a longer filter containing it only needs to check these.
+    QString lastFoldedFilter;
+    QList<int> lastMatches;
 };
 
 QHelpIndexProvider::QHelpIndexProvider(QHelpEnginePrivate *helpEngine)
@@ -122,6 +243,12 @@ QStringList QHelpIndexProvider::indices() const
     return m_indices;
 }
 
+QHelpKeywordIndex QHelpIndexProvider::keywordIndex() const
+{
+    QMutexLocker lck(&m_mutex);
+    return m_keywordIndex;
+}
+
 void QHelpIndexProvider::run()
 {
     m_mutex.lock();
@@ -129,6 +256,7 @@ void QHelpIndexProvider::run()
     const QStringList attributes = m_filterAttributes;
     const QString collectionFile = m_helpEngine->collectionHandler->collectionFile();
     m_indices = QStringList();
+    m_keywordIndex = QHelpKeywordIndex();
     m_mutex.unlock();
 
     if (collectionFile.isEmpty())
@@ -142,8 +270,12 @@ void QHelpIndexProvider::run()
             ? collectionHandler.indicesForFilter(currentFilter)
             : collectionHandler.indicesForFilter(attributes);
 
+    QHelpKeywordIndex keywordIndex;
+    keywordIndex.build(result);
+
     m_mutex.lock();
     m_indices = result;
+    m_keywordIndex = keywordIndex;
     m_mutex.unlock();
 }
 
@@ -199,6 +331,7 @@ void QHelpIndexModel::createIndex(const QString &customFilterName)
         return;
 
     d->indices = QStringList();
+    d->keywordIndex = QHelpKeywordIndex();
     filter(QString());
     emit indexCreationStarted();
 }
@@ -209,6 +342,7 @@ void QHelpIndexModel::insertIndices()
         return;
 
     d->indices = d->indexProvider->indices();
+    d->keywordIndex = d->indexProvider->keywordIndex();
     filter(QString());
     emit indexCreated();
 }
@@ -245,6 +379,8 @@ QHelpEngineCore *QHelpIndexModel::helpEngine() const
 QModelIndex QHelpIndexModel::filter(const QString &filter, const QString &wildcard)
 {
     if (filter.isEmpty()) {
+        d->lastFoldedFilter.clear();
+        d->lastMatches.clear();
         setStringList(d->indices);
         return index(-1, 0, QModelIndex());
     }
@@ -254,6 +390,8 @@ QModelIndex QHelpIndexModel::filter(const QString &filter, const QString &wildca
     int perfectMatch = -1;
 
     if (!wildcard.isEmpty()) {
+        d->lastFoldedFilter.clear();
+        d->lastMatches.clear();
         auto re = QRegularExpression::wildcardToRegularExpression(wildcard,
                                                                   QRegularExpression::UnanchoredWildcardConversion);
         const QRegularExpression regExp(re, QRegularExpression::CaseInsensitiveOption);
@@ -272,21 +410,28 @@ QModelIndex QHelpIndexModel::filter(const QString &filter, const QString &wildca
             }
         }
     } else {
-        for (const QString &index : qAsConst(d->indices)) {
-            if (index.contains(filter, Qt::CaseInsensitive)) {
-                lst.append(index);
-                if (perfectMatch == -1 && index.startsWith(filter, Qt::CaseInsensitive)) {
-                    if (goodMatch == -1)
-                        goodMatch = lst.count() - 1;
-                    if (filter.length() == index.length()){
-                        perfectMatch = lst.count() - 1;
-                    }
-                } else if (perfectMatch > -1 && index == filter) {
+        const QString foldedFilter = filter.toCaseFolded();
+        const bool narrowing = !d->lastFoldedFilter.isEmpty()
+                && foldedFilter.contains(d->lastFoldedFilter);
+        const QList<int> matches = d->keywordIndex.keywordsContaining(foldedFilter,
+                narrowing ? &d->lastMatches : nullptr);
+        d->lastFoldedFilter = foldedFilter;
+        d->lastMatches = matches;
+
+        lst.reserve(matches.count());
+        for (int i : matches) {
+            const QString &index = d->indices.at(i);
+            lst.append(index);
+            if (perfectMatch == -1 && d->keywordIndex.foldedKeyword(i).startsWith(foldedFilter)) {
+                if (goodMatch == -1)
+                    goodMatch = lst.count() - 1;
+                if (filter.length() == index.length()){
                     perfectMatch = lst.count() - 1;
                 }
+            } else if (perfectMatch > -1 && index == filter) {
+                perfectMatch = lst.count() - 1;
             }
         }
-
     }
 
     if (perfectMatch == -1)
@@ -38,6 +38,7 @@
 ****************************************************************************/
 
 #include "qhelpenginecore.h"
+#include "qhelpfilterengine.h"
 #include "qhelpsearchengine.h"
 #include "qhelpsearchquerywidget.h"
 #include "qhelpsearchresultwidget.h"
@@ -150,6 +151,17 @@ QString QHelpSearchResult::snippet() const
 }
 
 
+static bool attributesMatchFilter(const QStringList &attributes,
+                                  const QStringList &filter)
+{
+    for (const QString &attribute : filter) {
+        if (!attributes.contains(attribute, Qt::CaseInsensitive))
+            return false;
+    }
+
+    return true;
+}
+
 class QHelpSearchEnginePrivate : public QObject
 {
     Q_OBJECT
@@ -230,9 +242,30 @@ private:
         }
 
         m_searchInput = searchInput;
-        indexReader->cancelSearching();
-        indexReader->search(helpEngine->collectionFile(), indexFilesFolder(),
-                            searchInput, helpEngine->usesFilterEngine());
+
+        // The documentation to search in is looked up here, so that the
+        // search thread does not need to set up its own help engine.
+        if (helpEngine->usesFilterEngine()) {
+            QHelpFilterEngine *filterEngine = helpEngine->filterEngine();
+            indexReader->search(indexFilesFolder(), searchInput,
+                                filterEngine->namespacesForFilter(filterEngine->activeFilter()));
+            return;
+        }
+
+        QMultiMap<QString, QStringList> namespaceAttributes;
+        const QStringList &registeredDocs = helpEngine->registeredDocumentations();
+        const QStringList &currentFilter = helpEngine->filterAttributes(helpEngine->currentFilter());
+
+        for (const QString &namespaceName : registeredDocs) {
+            const QList<QStringList> &attributeSets =
+                    helpEngine->filterAttributeSets(namespaceName);
+
+            for (const QStringList &attributes : attributeSets) {
+                if (attributesMatchFilter(attributes, currentFilter))
+                    namespaceAttributes.insert(namespaceName, attributes);
+            }
+        }
+        indexReader->search(indexFilesFolder(), searchInput, namespaceAttributes);
     }
 
     void cancelSearching()
@@ -489,6 +522,10 @@ QList<QHelpSearchEngine::SearchHit> QHelpSearchEngine::hits(int start, int end)
     \since 5.9
     Returns a list of search results within the range from the index
     specified by \a start to the index specified by \a end.
+
+    The titles and snippets of the results are read from the index
+    only when they are requested, so it is cheaper to request just
+    the range of results that is going to be displayed.
 */
 QList<QHelpSearchResult> QHelpSearchEngine::searchResults(int start, int end) const
 {
@@ -552,6 +589,10 @@ void QHelpSearchEngine::cancelSearching()
     If double quotation marks are used to group the words,
     the search engine will search for an exact match of the quoted phrase.
 
+    A word followed by an asterisk matches all the words starting with it,
+    which is useful for searching while the search phrase is being typed.
+    Starting a new search aborts the search that is still in progress.
+
     For more information about the text query syntax,
     see \l {https://sqlite.org/fts5.html#full_text_query_syntax}
     {SQLite FTS5 Extension}.
@@ -45,7 +45,19 @@ namespace fulltextsearch {
 
 QHelpSearchIndexReader::~QHelpSearchIndexReader()
 {
-    cancelSearching();
+    stopSearchThread();
+}
+
+// The subclass has to stop the thread in its destructor,
+// before its own members used by run() are destroyed.
+void QHelpSearchIndexReader::stopSearchThread()
+{
+    QMutexLocker lock(&m_mutex);
+    m_quit = true;
+    m_cancel = true;
+    m_searchRequested.wakeAll();
+    lock.unlock();
+
     wait();
 }
 
@@ -53,36 +65,56 @@ void QHelpSearchIndexReader::cancelSearching()
 {
     QMutexLocker lock(&m_mutex);
     m_cancel = true;
+    m_searchPending = false;
 }
 
-void QHelpSearchIndexReader::search(const QString &collectionFile, const QString &indexFilesFolder,
-    const QString &searchInput, bool usesFilterEngine)
+bool QHelpSearchIndexReader::isCancelled() const
 {
-    wait();
+    QMutexLocker lock(&m_mutex);
+    return m_cancel;
+}
 
-    m_searchResults.clear();
-    m_cancel = false;
+void QHelpSearchIndexReader::search(const QString &indexFilesFolder, const QString &searchInput,
+    const QMultiMap<QString, QStringList> &namespaceAttributes)
+{
+    QMutexLocker lock(&m_mutex);
     m_searchInput = searchInput;
-    m_collectionFile = collectionFile;
     m_indexFilesFolder = indexFilesFolder;
-    m_usesFilterEngine = usesFilterEngine;
+    m_namespaceAttributes = namespaceAttributes;
+    m_filterEngineNamespaceList.clear();
+    m_usesFilterEngine = false;
+    lock.unlock();
 
-    start(QThread::NormalPriority);
+    startSearch();
 }
 
-int QHelpSearchIndexReader::searchResultCount() const
+void QHelpSearchIndexReader::search(const QString &indexFilesFolder, const QString &searchInput,
+    const QStringList &filterEngineNamespaceList)
 {
     QMutexLocker lock(&m_mutex);
-    return m_searchResults.count();
+    m_searchInput = searchInput;
+    m_indexFilesFolder = indexFilesFolder;
+    m_namespaceAttributes.clear();
+    m_filterEngineNamespaceList = filterEngineNamespaceList;
+    m_usesFilterEngine = true;
+    lock.unlock();
+
+    startSearch();
 }
 
-QList<QHelpSearchResult> QHelpSearchIndexReader::searchResults(int start,
-                                                                 int end) const
+// The search thread keeps running between searches. A new search
+// aborts the one in progress instead of waiting for it to finish.
+void QHelpSearchIndexReader::startSearch()
 {
     QMutexLocker lock(&m_mutex);
-    return m_searchResults.mid(start, end - start);
-}
+    m_cancel = true;
+    m_searchPending = true;
+    m_searchRequested.wakeAll();
+    lock.unlock();
 
+    if (!isRunning())
+        start(QThread::NormalPriority);
+}
 
 }   // namespace fulltextsearch
 
@@ -37,38 +37,81 @@
 **
 ****************************************************************************/
 
-#include "qhelpenginecore.h"
-#include "qhelpfilterengine.h"
+#include "qhelp_global.h"
 #include "qhelpsearchindexreader_default_p.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QSet>
+#include <QtCore/QThread>
 #include <QtSql/QSqlDatabase>
 #include <QtSql/QSqlQuery>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 namespace fulltextsearch {
 namespace qt {
 
+Reader::~Reader()
+{
+    closeDB();
+}
+
 void Reader::setIndexPath(const QString &path)
 {
+    if (path != m_indexPath)
+        closeDB();
     m_indexPath = path;
-    m_namespaceAttributes.clear();
-    m_filterEngineNamespaceList.clear();
-    m_useFilterEngine = false;
 }
 
-void Reader::addNamespaceAttributes(const QString &namespaceName, const QStringList &attributes)
+void Reader::setNamespaceAttributes(const QMultiMap<QString, QStringList> &namespaceAttributes)
 {
-    m_namespaceAttributes.insert(namespaceName, attributes);
+    m_useFilterEngine = false;
+    m_namespaceAttributes = namespaceAttributes;
+    m_filterEngineNamespaceList.clear();
 }
 
 void Reader::setFilterEngineNamespaceList(const QStringList &namespaceList)
 {
     m_useFilterEngine = true;
+    m_namespaceAttributes.clear();
     m_filterEngineNamespaceList = namespaceList;
 }
 
+// The connection is kept open between searches,
+// it has to be closed by the thread which opened it.
+bool Reader::openDB()
+{
+    if (!m_connectionName.isEmpty())
+        return true;
+
+    const QString &uniqueId = QHelpGlobal::uniquifyConnectionName(QLatin1String("QHelpReader"), this);
+    bool opened = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QLatin1String("QSQLITE"), uniqueId);
+        db.setConnectOptions(QLatin1String("QSQLITE_OPEN_READONLY"));
+        db.setDatabaseName(m_indexPath + QLatin1String("/fts"));
+        opened = db.open();
+    }
+    if (!opened) {
+        QSqlDatabase::removeDatabase(uniqueId);
+        return false;
+    }
+    m_connectionName = uniqueId;
+    return true;
+}
+
+void Reader::closeDB()
+{
+    if (m_connectionName.isEmpty())
+        return;
+
+    QSqlDatabase::database(m_connectionName, false).close();
+    QSqlDatabase::removeDatabase(m_connectionName);
+    m_connectionName.clear();
+}
+
 static QString namespacePlaceholders(const QMultiMap<QString, QStringList> &namespaces)
 {
     QString placeholders;
@@ -135,150 +178,247 @@ static void bindNamespacesAndAttributes(QSqlQuery *query, const QStringList &nam
         query->addBindValue(ns);
 }
 
-QList<QHelpSearchResult> Reader::queryTable(const QSqlDatabase &db,
-                                         const QString &tableName,
-                                         const QString &searchInput) const
+// The hits are read in the order of the fts index and sorted by their rank
+// afterwards, instead of using ORDER BY rank, which would compute all of
+// them before returning the first row. That allows aborting the query
+// between rows as soon as a new search is started.
+bool Reader::queryTable(const QSqlDatabase &db,
+                        const QString &tableName,
+                        const QString &searchInput,
+                        const std::function<bool()> &isCancelled,
+                        QList<Hit> *hits) const
 {
     const QString nsPlaceholders = m_useFilterEngine
             ? namespacePlaceholders(m_filterEngineNamespaceList)
             : namespacePlaceholders(m_namespaceAttributes);
     QSqlQuery query(db);
-    query.prepare(QLatin1String("SELECT url, title, snippet(") + tableName +
-                  QLatin1String(", -1, '<b>', '</b>', '...', '10') FROM ") + tableName +
+    query.setForwardOnly(true);
+    query.prepare(QLatin1String("SELECT rowid, url, rank FROM ") + tableName +
                   QLatin1String(" WHERE (") + nsPlaceholders +
                   QLatin1String(") AND ") + tableName +
-                  QLatin1String(" MATCH ? ORDER BY rank"));
+                  QLatin1String(" MATCH ?"));
     m_useFilterEngine
             ? bindNamespacesAndAttributes(&query, m_filterEngineNamespaceList)
             : bindNamespacesAndAttributes(&query, m_namespaceAttributes);
     query.addBindValue(searchInput);
     query.exec();
 
-    QList<QHelpSearchResult> results;
+    const bool titleMatch = tableName == QLatin1String("titles");
 
-    while (query.next()) {
-        const QString &url = query.value(QLatin1String("url")).toString();
-        const QString &title = query.value(QLatin1String("title")).toString();
-        const QString &snippet = query.value(2).toString();
-        results.append(QHelpSearchResult(url, title, snippet));
+    for (int row = 1; query.next(); ++row) {
+        if (row % 256 == 0 && isCancelled())
+            return false;
+        hits->append({ query.value(1).toString(), query.value(0).toLongLong(),
+                       query.value(2).toDouble(), titleMatch });
     }
 
-    return results;
+    std::stable_sort(hits->begin(), hits->end(), [](const Hit &a, const Hit &b) {
+        return a.rank < b.rank;
+    });
+    return true;
 }
 
-void Reader::searchInDB(const QString &searchInput)
+// Only the ranked row ids are collected here. The titles and the
+// snippets, which are expensive to compute, are fetched by
+// fetchResults() for the results that are actually requested.
+// Returns false if the search was cancelled.
+bool Reader::searchInDB(const QString &searchInput, const std::function<bool()> &isCancelled)
 {
-    const QString &uniqueId = QHelpGlobal::uniquifyConnectionName(QLatin1String("QHelpReader"), this);
-    {
-        QSqlDatabase db = QSqlDatabase::addDatabase(QLatin1String("QSQLITE"), uniqueId);
-        db.setConnectOptions(QLatin1String("QSQLITE_OPEN_READONLY"));
-        db.setDatabaseName(m_indexPath + QLatin1String("/fts"));
+    m_hits = QList<Hit>();
 
-        if (db.open()) {
-            const QList<QHelpSearchResult> titleResults = queryTable(db,
-                                             QLatin1String("titles"), searchInput);
-            const QList<QHelpSearchResult> contentResults = queryTable(db,
-                                             QLatin1String("contents"), searchInput);
+    if (!openDB())
+        return true;
 
-            // merge results form title and contents searches
-            m_searchResults = QList<QHelpSearchResult>();
+    const QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
 
-            QSet<QUrl> urls;
+    QList<Hit> titleHits;
+    QList<Hit> contentHits;
+    if (!queryTable(db, QLatin1String("titles"), searchInput, isCancelled, &titleHits)
+            || isCancelled()
+            || !queryTable(db, QLatin1String("contents"), searchInput, isCancelled, &contentHits)) {
+        return false;
+    }
 
-            for (const QHelpSearchResult &result : titleResults) {
-                const QUrl &url = result.url();
-                if (!urls.contains(url)) {
-                    urls.insert(url);
-                    m_searchResults.append(result);
-                }
-            }
+    // merge results form title and contents searches
+    QSet<QString> urls;
 
-            for (const QHelpSearchResult &result : contentResults) {
-                const QUrl &url = result.url();
-                if (!urls.contains(url)) {
-                    urls.insert(url);
-                    m_searchResults.append(result);
-                }
-            }
+    for (const Hit &hit : qAsConst(titleHits)) {
+        if (!urls.contains(hit.url)) {
+            urls.insert(hit.url);
+            m_hits.append(hit);
         }
     }
-    QSqlDatabase::removeDatabase(uniqueId);
+
+    for (const Hit &hit : qAsConst(contentHits)) {
+        if (!urls.contains(hit.url)) {
+            urls.insert(hit.url);
+            m_hits.append(hit);
+        }
+    }
+    return true;
 }
 
-QList<QHelpSearchResult> Reader::searchResults() const
+QList<Reader::Hit> Reader::hits() const
 {
-    return m_searchResults;
+    return m_hits;
 }
 
-static bool attributesMatchFilter(const QStringList &attributes,
-                                  const QStringList &filter)
+static void fetchTableResults(const QSqlDatabase &db, const QString &tableName,
+                              const QString &searchInput, const QList<qint64> &rowIds,
+                              QHash<qint64, QHelpSearchResult> *results)
 {
-    for (const QString &attribute : filter) {
-        if (!attributes.contains(attribute, Qt::CaseInsensitive))
-            return false;
+    // Stay below the default limit of host parameters of older SQLite versions.
+    const int maxRowIds = 500;
+
+    for (int first = 0; first < rowIds.count(); first += maxRowIds) {
+        const QList<qint64> chunk = rowIds.mid(first, maxRowIds);
+
+        QString placeholders = QLatin1String("?");
+        for (int i = chunk.count() - 1; i; --i)
+            placeholders += QLatin1String(", ?");
+
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        query.prepare(QLatin1String("SELECT rowid, url, title, snippet(") + tableName +
+                      QLatin1String(", -1, '<b>', '</b>', '...', '10') FROM ") + tableName +
+                      QLatin1String(" WHERE ") + tableName +
+                      QLatin1String(" MATCH ? AND rowid IN (") + placeholders +
+                      QLatin1Char(')'));
+        query.addBindValue(searchInput);
+        for (qint64 rowId : chunk)
+            query.addBindValue(rowId);
+        query.exec();
+
+        while (query.next()) {
+            const QString &url = query.value(1).toString();
+            const QString &title = query.value(2).toString();
+            const QString &snippet = query.value(3).toString();
+            results->insert(query.value(0).toLongLong(),
+                            QHelpSearchResult(url, title, snippet));
+        }
     }
+}
 
-    return true;
+QList<QHelpSearchResult> Reader::fetchResults(const QString &indexPath,
+                                              const QString &searchInput,
+                                              const QList<Hit> &hits)
+{
+    QList<QHelpSearchResult> results;
+    if (hits.isEmpty())
+        return results;
+
+    QList<qint64> titleRowIds;
+    QList<qint64> contentRowIds;
+    for (const Hit &hit : hits)
+        (hit.titleMatch ? titleRowIds : contentRowIds).append(hit.rowId);
+
+    QHash<qint64, QHelpSearchResult> titleResults;
+    QHash<qint64, QHelpSearchResult> contentResults;
+
+    const QString &uniqueId = QHelpGlobal::uniquifyConnectionName(
+                QLatin1String("QHelpResultReader"), QThread::currentThread());
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QLatin1String("QSQLITE"), uniqueId);
+        db.setConnectOptions(QLatin1String("QSQLITE_OPEN_READONLY"));
+        db.setDatabaseName(indexPath + QLatin1String("/fts"));
+
+        if (db.open()) {
+            fetchTableResults(db, QLatin1String("titles"), searchInput,
+                              titleRowIds, &titleResults);
+            fetchTableResults(db, QLatin1String("contents"), searchInput,
+                              contentRowIds, &contentResults);
+        }
+    }
+    QSqlDatabase::removeDatabase(uniqueId);
+
+    // Rows removed by indexing in the meantime are skipped.
+    results.reserve(hits.count());
+    for (const Hit &hit : hits) {
+        const QHash<qint64, QHelpSearchResult> &tableResults =
+                hit.titleMatch ? titleResults : contentResults;
+        const auto it = tableResults.constFind(hit.rowId);
+        if (it != tableResults.cend())
+            results.append(it.value());
+    }
+
+    return results;
+}
+
+QHelpSearchIndexReaderDefault::~QHelpSearchIndexReaderDefault()
+{
+    // run() uses m_reader, stop it before m_reader is destroyed.
+    stopSearchThread();
 }
 
 void QHelpSearchIndexReaderDefault::run()
 {
     QMutexLocker lock(&m_mutex);
 
-    if (m_cancel)
-        return;
+    forever {
+        while (!m_quit && !m_searchPending)
+            m_searchRequested.wait(&m_mutex);
 
-    const QString searchInput = m_searchInput;
-    const QString collectionFile = m_collectionFile;
-    const QString indexPath = m_indexFilesFolder;
-    const bool usesFilterEngine = m_usesFilterEngine;
+        if (m_quit)
+            break;
 
-    lock.unlock();
+        m_searchPending = false;
+        m_cancel = false;
+        m_hits.clear();
 
-    QHelpEngineCore engine(collectionFile, nullptr);
-    if (!engine.setupData())
-        return;
+        const QString searchInput = m_searchInput;
+        const QString indexPath = m_indexFilesFolder;
+        const bool usesFilterEngine = m_usesFilterEngine;
 
-    emit searchingStarted();
+        // setup the reader
+        m_reader.setIndexPath(indexPath);
+        if (usesFilterEngine)
+            m_reader.setFilterEngineNamespaceList(m_filterEngineNamespaceList);
+        else
+            m_reader.setNamespaceAttributes(m_namespaceAttributes);
 
-    // setup the reader
-    m_reader.setIndexPath(indexPath);
+        lock.unlock();
 
-    if (usesFilterEngine) {
-        m_reader.setFilterEngineNamespaceList(
-                    engine.filterEngine()->namespacesForFilter(
-                        engine.filterEngine()->activeFilter()));
-    } else {
-        const QStringList &registeredDocs = engine.registeredDocumentations();
-        const QStringList &currentFilter = engine.filterAttributes(engine.currentFilter());
+        emit searchingStarted();
 
-        for (const QString &namespaceName : registeredDocs) {
-            const QList<QStringList> &attributeSets =
-                    engine.filterAttributeSets(namespaceName);
+        const bool finished = m_reader.searchInDB(searchInput, [this]() {
+            return isCancelled();
+        });
 
-            for (const QStringList &attributes : attributeSets) {
-                if (attributesMatchFilter(attributes, currentFilter)) {
-                    m_reader.addNamespaceAttributes(namespaceName, attributes);
-                }
-            }
+        lock.relock();
+        if (finished) {
+            m_hits = m_reader.hits();
+            m_hitsIndexPath = indexPath;
+            m_hitsSearchInput = searchInput;
         }
-    }
+        const int resultCount = m_hits.count();
+        lock.unlock();
 
-    lock.relock();
-    if (m_cancel) {
-        emit searchingFinished(0);   // TODO: check this, speed issue while locking???
-        return;
+        emit searchingFinished(resultCount);
+
+        lock.relock();
     }
+
     lock.unlock();
 
-    m_searchResults.clear();
-    m_reader.searchInDB(searchInput);    // TODO: should this be interruptible as well ???
+    // The connection belongs to this thread.
+    m_reader.closeDB();
+}
 
-    lock.relock();
-    m_searchResults = m_reader.searchResults();
+int QHelpSearchIndexReaderDefault::searchResultCount() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_hits.count();
+}
+
+QList<QHelpSearchResult> QHelpSearchIndexReaderDefault::searchResults(int start, int end) const
+{
+    QMutexLocker lock(&m_mutex);
+    const QList<Reader::Hit> hits = m_hits.mid(start, end - start);
+    const QString indexPath = m_hitsIndexPath;
+    const QString searchInput = m_hitsSearchInput;
     lock.unlock();
 
-    emit searchingFinished(m_searchResults.count());
+    return Reader::fetchResults(indexPath, searchInput, hits);
 }
 
 }   // namespace std
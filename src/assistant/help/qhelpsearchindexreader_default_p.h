@@ -53,6 +53,8 @@
 
 #include "qhelpsearchindexreader_p.h"
 
+#include <functional>
+
 QT_FORWARD_DECLARE_CLASS(QSqlDatabase)
 
 QT_BEGIN_NAMESPACE
@@ -63,22 +65,41 @@ namespace qt {
 class Reader
 {
 public:
+    struct Hit
+    {
+        QString url;
+        qint64 rowId = 0;
+        double rank = 0;
+        bool titleMatch = false;
+    };
+
+    ~Reader();
+
     void setIndexPath(const QString &path);
-    void addNamespaceAttributes(const QString &namespaceName, const QStringList &attributes);
+    void setNamespaceAttributes(const QMultiMap<QString, QStringList> &namespaceAttributes);
     void setFilterEngineNamespaceList(const QStringList &namespaceList);
 
-    void searchInDB(const QString &term);
-    QList<QHelpSearchResult> searchResults() const;
+    bool searchInDB(const QString &term, const std::function<bool()> &isCancelled);
+    QList<Hit> hits() const;
+    void closeDB();
+
+    static QList<QHelpSearchResult> fetchResults(const QString &indexPath,
+                                                 const QString &searchInput,
+                                                 const QList<Hit> &hits);
 
 private:
-    QList<QHelpSearchResult> queryTable(const QSqlDatabase &db,
-                                          const QString &tableName,
-                                          const QString &searchInput) const;
+    bool openDB();
+    bool queryTable(const QSqlDatabase &db,
+                    const QString &tableName,
+                    const QString &searchInput,
+                    const std::function<bool()> &isCancelled,
+                    QList<Hit> *hits) const;
 
     QMultiMap<QString, QStringList> m_namespaceAttributes;
     QStringList m_filterEngineNamespaceList;
-    QList<QHelpSearchResult> m_searchResults;
+    QList<Hit> m_hits;
     QString m_indexPath;
+    QString m_connectionName;
     bool m_useFilterEngine = false;
 };
 
@@ -87,11 +108,20 @@ class QHelpSearchIndexReaderDefault : public QHelpSearchIndexReader
 {
     Q_OBJECT
 
+public:
+    ~QHelpSearchIndexReaderDefault() override;
+
+    int searchResultCount() const override;
+    QList<QHelpSearchResult> searchResults(int start, int end) const override;
+
 private:
     void run() override;
 
 private:
     Reader m_reader;
+    QList<Reader::Hit> m_hits;
+    QString m_hitsIndexPath;
+    QString m_hitsSearchInput;
 };
 
 }   // namespace std
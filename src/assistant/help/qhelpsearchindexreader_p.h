@@ -54,8 +54,10 @@
 #include "qhelpsearchengine.h"
 
 #include <QtCore/QList>
+#include <QtCore/QMap>
 #include <QtCore/QMutex>
 #include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
 
 QT_BEGIN_NAMESPACE
 
@@ -71,27 +73,36 @@ public:
     ~QHelpSearchIndexReader() override;
 
     void cancelSearching();
-    void search(const QString &collectionFile,
-                const QString &indexFilesFolder,
+    void search(const QString &indexFilesFolder,
                 const QString &searchInput,
-                bool usesFilterEngine = false);
-    int searchResultCount() const;
-    QList<QHelpSearchResult> searchResults(int start, int end) const;
+                const QMultiMap<QString, QStringList> &namespaceAttributes);
+    void search(const QString &indexFilesFolder,
+                const QString &searchInput,
+                const QStringList &filterEngineNamespaceList);
+    virtual int searchResultCount() const = 0;
+    virtual QList<QHelpSearchResult> searchResults(int start, int end) const = 0;
 
 signals:
     void searchingStarted();
     void searchingFinished(int searchResultCount);
 
 protected:
+    bool isCancelled() const;
+    void stopSearchThread();
+
     mutable QMutex m_mutex;
-    QList<QHelpSearchResult> m_searchResults;
+    QWaitCondition m_searchRequested;
     bool m_cancel = false;
-    QString m_collectionFile;
+    bool m_searchPending = false;
+    bool m_quit = false;
     QString m_searchInput;
     QString m_indexFilesFolder;
+    QMultiMap<QString, QStringList> m_namespaceAttributes;
+    QStringList m_filterEngineNamespaceList;
     bool m_usesFilterEngine = false;
 
 private:
+    void startSearch();
     void run() override = 0;
 };
 
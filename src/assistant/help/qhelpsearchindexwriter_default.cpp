@@ -39,15 +39,17 @@
 
 #include "qhelpsearchindexwriter_default_p.h"
 #include "qhelp_global.h"
+#include "qhelpbatchprocessor_p.h"
 #include "qhelpenginecore.h"
 #include "qhelpdbreader_p.h"
+#include "qhelphtmltextextractor_p.h"
 
+#include <QtCore/QCryptographicHash>
 #include <QtCore/QDataStream>
 #include <QtCore/QDateTime>
 #include <QtCore/QDir>
-#include <QtCore/QStringDecoder>
-#include <QtCore/QTextStream>
 #include <QtCore/QSet>
+#include <QtCore/QThreadPool>
 #include <QtCore/QUrl>
 #include <QtCore/QVariant>
 #include <QtSql/QSqlDatabase>
@@ -55,8 +57,6 @@
 #include <QtSql/QSqlError>
 #include <QtSql/QSqlQuery>
 
-#include <QTextDocument>
-
 QT_BEGIN_NAMESPACE
 
 namespace fulltextsearch {
@@ -150,12 +150,20 @@ void Writer::init(bool reindex)
         query.exec(QLatin1String("DROP TABLE info;"));
     }
 
-    query.exec(QLatin1String("CREATE TABLE info (id INTEGER PRIMARY KEY, namespace, attributes, url, title, data);"));
+    query.exec(QLatin1String("CREATE TABLE info (id INTEGER PRIMARY KEY, namespace, attributes, url, title, data, hash);"));
+    // Databases written by older versions have no content hashes,
+    // their documents are indexed again on the next update.
+    if (!query.exec(QLatin1String("SELECT hash FROM info LIMIT 1")))
+        query.exec(QLatin1String("ALTER TABLE info ADD COLUMN hash;"));
+    query.exec(QLatin1String("CREATE INDEX IF NOT EXISTS info_namespace ON info (namespace);"));
 
+    // The prefix indexes speed up the prefix queries used while typing.
+    // Tables created by older versions get them when being reindexed.
     query.exec(QLatin1String("CREATE VIRTUAL TABLE titles USING fts5("
                              "namespace UNINDEXED, attributes UNINDEXED, "
                              "url UNINDEXED, title, "
-                             "tokenize = 'porter unicode61', content = 'info', content_rowid='id');"));
+                             "tokenize = 'porter unicode61', prefix = '2 3', "
+                             "content = 'info', content_rowid='id');"));
     query.exec(QLatin1String("CREATE TRIGGER titles_insert AFTER INSERT ON info BEGIN "
                              "INSERT INTO titles(rowid, namespace, attributes, url, title) "
                              "VALUES(new.id, new.namespace, new.attributes, new.url, new.title); "
@@ -174,7 +182,8 @@ void Writer::init(bool reindex)
     query.exec(QLatin1String("CREATE VIRTUAL TABLE contents USING fts5("
                              "namespace UNINDEXED, attributes UNINDEXED, "
                              "url UNINDEXED, title, data, "
-                             "tokenize = 'porter unicode61', content = 'info', content_rowid='id');"));
+                             "tokenize = 'porter unicode61', prefix = '2 3', "
+                             "content = 'info', content_rowid='id');"));
     query.exec(QLatin1String("CREATE TRIGGER contents_insert AFTER INSERT ON info BEGIN "
                              "INSERT INTO contents(rowid, namespace, attributes, url, title, data) "
                              "VALUES(new.id, new.namespace, new.attributes, new.url, new.title, new.data); "
@@ -204,17 +213,18 @@ Writer::~Writer()
 
 void Writer::flush()
 {
-    if (!m_db)
+    if (!m_db || m_namespaces.isEmpty())
         return;
 
     QSqlQuery query(*m_db);
 
-    query.prepare(QLatin1String("INSERT INTO info (namespace, attributes, url, title, data) VALUES (?, ?, ?, ?, ?)"));
+    query.prepare(QLatin1String("INSERT INTO info (namespace, attributes, url, title, data, hash) VALUES (?, ?, ?, ?, ?, ?)"));
     query.addBindValue(m_namespaces);
     query.addBindValue(m_attributes);
     query.addBindValue(m_urls);
     query.addBindValue(m_titles);
     query.addBindValue(m_contents);
+    query.addBindValue(m_hashes);
     query.execBatch();
 
     m_namespaces = QVariantList();
@@ -222,6 +232,7 @@ void Writer::flush()
     m_urls = QVariantList();
     m_titles = QVariantList();
     m_contents = QVariantList();
+    m_hashes = QVariantList();
 }
 
 void Writer::removeNamespace(const QString &namespaceName)
@@ -255,17 +266,69 @@ bool Writer::hasNamespace(const QString &namespaceName)
     return query.next();
 }
 
+// Returns the documents indexed for the namespace, keyed by their
+// attributes and url. An update that was cancelled may have left
+// several documents with the same key, all but the newest are removed.
+QHash<QString, Writer::IndexedFile> Writer::indexedFiles(const QString &namespaceName)
+{
+    QHash<QString, IndexedFile> files;
+    if (!m_db)
+        return files;
+
+    QSqlQuery query(*m_db);
+
+    query.prepare(QLatin1String("SELECT id, attributes, url, hash FROM info "
+                                "WHERE namespace = ? ORDER BY id"));
+    query.addBindValue(namespaceName);
+    query.exec();
+
+    QList<qint64> duplicates;
+    while (query.next()) {
+        const QString key = query.value(1).toString() + QLatin1Char('\t')
+                + query.value(2).toString();
+        IndexedFile &file = files[key];
+        if (file.id)
+            duplicates.append(file.id);
+        file.id = query.value(0).toLongLong();
+        file.hash = query.value(3).toByteArray();
+    }
+    removeDocuments(duplicates);
+
+    return files;
+}
+
+void Writer::removeDocuments(const QList<qint64> &ids)
+{
+    if (!m_db || ids.isEmpty())
+        return;
+
+    // The delete triggers keep the fts tables up to date,
+    // so there is no need to rebuild them afterwards.
+    QVariantList idList;
+    idList.reserve(ids.size());
+    for (qint64 id : ids)
+        idList.append(id);
+
+    QSqlQuery query(*m_db);
+
+    query.prepare(QLatin1String("DELETE FROM info WHERE id = ?"));
+    query.addBindValue(idList);
+    query.execBatch();
+}
+
 void Writer::insertDoc(const QString &namespaceName,
                        const QString &attributes,
                        const QString &url,
                        const QString &title,
-                       const QString &contents)
+                       const QString &contents,
+                       const QByteArray &hash)
 {
     m_namespaces.append(namespaceName);
     m_attributes.append(attributes);
     m_urls.append(url);
     m_titles.append(title);
     m_contents.append(contents);
+    m_hashes.append(hash);
 }
 
 void Writer::startTransaction()
@@ -363,6 +426,28 @@ static bool clearIndexMap(QHelpEngineCore *engine)
     return engine->removeCustomValue(QLatin1String(IndexedNamespacesKey));
 }
 
+// Returns the URL of the file in the help system, or an empty
+// string if it is not a file to be indexed.
+static QString documentUrl(const QString &namespaceName, const QString &virtualFolder,
+                           const QString &fileName)
+{
+    QUrl url;
+    url.setScheme(QLatin1String("qthelp"));
+    url.setAuthority(namespaceName);
+    url.setPath(QLatin1Char('/') + virtualFolder + QLatin1Char('/') + fileName);
+
+    if (url.hasFragment())
+        url.setFragment(QString());
+
+    const QString &fullFileName = url.toString();
+    if (!fullFileName.endsWith(QLatin1String(".html"))
+            && !fullFileName.endsWith(QLatin1String(".htm"))
+            && !fullFileName.endsWith(QLatin1String(".txt"))) {
+        return QString();
+    }
+    return fullFileName;
+}
+
 void QHelpSearchIndexWriter::run()
 {
     QMutexLocker lock(&m_mutex);
@@ -398,9 +483,8 @@ void QHelpSearchIndexWriter::run()
             if (indexMap.contains(namespaceName)) {
                 const QString path = engine.documentationFileName(namespaceName);
                 if (indexMap.value(namespaceName) < QFileInfo(path).lastModified()) {
-                    // Remove some outdated indexed stuff
+                    // Outdated, only the changed documents are indexed again
                     indexMap.remove(namespaceName);
-                    writer.removeNamespace(namespaceName);
                 } else if (!writer.hasNamespace(namespaceName)) {
                     // No data in fts db for namespace.
                     // The namespace could have been removed from fts db
@@ -408,13 +492,11 @@ void QHelpSearchIndexWriter::run()
                     // without removing it from indexMap.
                     indexMap.remove(namespaceName);
                 }
-            } else {
-                // Needed in case namespaceName was removed from indexMap
-                // without removing it from fts db.
-                // May happen when e.g. qch file was removed manually
-                // without removing fts db.
-                writer.removeNamespace(namespaceName);
             }
+            // Otherwise namespaceName may have been removed from indexMap
+            // without removing it from fts db, e.g. when indexing was
+            // cancelled or the qch file was removed manually. The data
+            // left in fts db is compared with the qch file below.
         // TODO: we may also detect if there are any other data
         // and remove it
         }
@@ -429,6 +511,8 @@ void QHelpSearchIndexWriter::run()
         }
     }
 
+    QThreadPool pool;
+
     for (const QString &namespaceName : registeredDocs) {
         lock.relock();
         if (m_cancel) {
@@ -452,81 +536,110 @@ void QHelpSearchIndexWriter::run()
 
         const QString virtualFolder = reader.virtualFolder();
 
+        // Documents whose content hash did not change are kept, the
+        // ones left in this hash after indexing are removed.
+        QHash<QString, Writer::IndexedFile> indexedFiles = writer.indexedFiles(namespaceName);
+        const auto isIndexed = [&indexedFiles](const QString &key, const QByteArray &hash,
+                                               QList<qint64> *outdatedIds) {
+            const auto it = indexedFiles.constFind(key);
+            if (it == indexedFiles.cend())
+                return false;
+            const bool unchanged = it->hash == hash;
+            if (!unchanged)
+                outdatedIds->append(it->id);
+            indexedFiles.erase(it);
+            return unchanged;
+        };
+
+        // The text may have been extracted by qhelpgenerator already.
+        const bool hasSearchText =
+                reader.searchTextVersion() == QHelpHtmlTextExtractor::SearchTextVersion;
+
         const QList<QStringList> &attributeSets =
             engine.filterAttributeSets(namespaceName);
 
         for (const QStringList &attributes : attributeSets) {
             const QString &attributesString = attributes.join(QLatin1Char('|'));
+            const QString keyPrefix = attributesString + QLatin1Char('\t');
+            QList<qint64> outdatedIds;
+
+            if (hasSearchText) {
+                for (const char *extension : {"html", "htm", "txt"}) {
+                    const QList<QHelpDBReader::SearchText> texts =
+                            reader.searchTexts(attributes, QLatin1String(extension));
+                    for (const QHelpDBReader::SearchText &text : texts) {
+                        const QString fullFileName =
+                                documentUrl(namespaceName, virtualFolder, text.name);
+                        if (fullFileName.isEmpty())
+                            continue;
+                        QCryptographicHash hash(QCryptographicHash::Sha1);
+                        hash.addData(text.title.toUtf8());
+                        hash.addData(QByteArray(1, '\0'));
+                        hash.addData(text.contents.toUtf8());
+                        const QByteArray result = hash.result();
+                        if (!isIndexed(keyPrefix + fullFileName, result, &outdatedIds)) {
+                            writer.insertDoc(namespaceName, attributesString, fullFileName,
+                                             text.title, text.contents, result);
+                        }
+                    }
+                    writer.removeDocuments(outdatedIds);
+                    outdatedIds.clear();
+                    writer.flush();
+                }
 
-            const QMultiMap<QString, QByteArray> htmlFiles =
-                    reader.filesData(attributes, QLatin1String("html"));
-            const QMultiMap<QString, QByteArray> htmFiles =
-                    reader.filesData(attributes, QLatin1String("htm"));
-            const QMultiMap<QString, QByteArray> txtFiles =
-                    reader.filesData(attributes, QLatin1String("txt"));
-
-            QMultiMap<QString, QByteArray> files = htmlFiles;
-            files.unite(htmFiles);
-            files.unite(txtFiles);
-
-            for (auto it = files.cbegin(), end = files.cend(); it != end ; ++it) {
-                lock.relock();
-                if (m_cancel) {
+                if (isCancelled()) {
                     // store what we have done so far
                     writeIndexMap(&engine, indexMap);
                     writer.endTransaction();
                     emit indexingFinished();
                     return;
                 }
-                lock.unlock();
-
-                const QString &file = it.key();
-                const QByteArray &data = it.value();
-
-                if (data.isEmpty())
-                    continue;
-
-                QUrl url;
-                url.setScheme(QLatin1String("qthelp"));
-                url.setAuthority(namespaceName);
-                url.setPath(QLatin1Char('/') + virtualFolder + QLatin1Char('/') + file);
-
-                if (url.hasFragment())
-                    url.setFragment(QString());
+            }
 
-                const QString &fullFileName = url.toString();
-                if (!fullFileName.endsWith(QLatin1String(".html"))
-                        && !fullFileName.endsWith(QLatin1String(".htm"))
-                        && !fullFileName.endsWith(QLatin1String(".txt"))) {
-                    continue;
-                }
+            // The text of the files qhelpgenerator did not store it for is extracted here.
+            const QMultiMap<QString, QByteArray> htmlFiles =
+                    reader.compressedFilesData(attributes, QLatin1String("html"), hasSearchText);
+            const QMultiMap<QString, QByteArray> htmFiles =
+                    reader.compressedFilesData(attributes, QLatin1String("htm"), hasSearchText);
+            const QMultiMap<QString, QByteArray> txtFiles =
+                    reader.compressedFilesData(attributes, QLatin1String("txt"), hasSearchText);
 
-                QTextStream s(data);
-                auto encoding = QStringDecoder::encodingForHtml(data.constData(), data.size());
-                if (encoding)
-                    s.setEncoding(*encoding);
+            QMultiMap<QString, QByteArray> files = htmlFiles;
+            files.unite(htmFiles);
+            files.unite(txtFiles);
 
-                const QString &text = s.readAll();
-                if (text.isEmpty())
+            const int codec = reader.fileDataCodec();
+            QList<FileToIndex> filesToIndex;
+            for (auto it = files.cbegin(), end = files.cend(); it != end ; ++it) {
+                const QString fullFileName = documentUrl(namespaceName, virtualFolder, it.key());
+                if (fullFileName.isEmpty())
                     continue;
-
-                QString title;
-                QString contents;
-                if (fullFileName.endsWith(QLatin1String(".txt"))) {
-                    title = fullFileName.mid(fullFileName.lastIndexOf(QLatin1Char('/')) + 1);
-                    contents = text.toHtmlEscaped();
-                } else {
-                    QTextDocument doc;
-                    doc.setHtml(text);
-
-                    title = doc.metaInformation(QTextDocument::DocumentTitle).toHtmlEscaped();
-                    contents = doc.toPlainText().toHtmlEscaped();
-                }
-
-                writer.insertDoc(namespaceName, attributesString, fullFileName, title, contents);
+                const QByteArray hash =
+                        QCryptographicHash::hash(it.value(), QCryptographicHash::Sha1);
+                if (!isIndexed(keyPrefix + fullFileName, hash, &outdatedIds))
+                    filesToIndex.append({fullFileName, it.value(), hash, codec});
+            }
+            // Remove the outdated documents first, so that a cancelled
+            // update does not leave both versions in the index.
+            writer.removeDocuments(outdatedIds);
+
+            if (!indexFiles(&writer, &pool, namespaceName, attributesString, filesToIndex)) {
+                // store what we have done so far
+                writeIndexMap(&engine, indexMap);
+                writer.endTransaction();
+                emit indexingFinished();
+                return;
             }
         }
         writer.flush();
+
+        // Remove the documents which are not part of the namespace anymore.
+        QList<qint64> removedIds;
+        removedIds.reserve(indexedFiles.size());
+        for (const Writer::IndexedFile &file : qAsConst(indexedFiles))
+            removedIds.append(file.id);
+        writer.removeDocuments(removedIds);
+
         const QString &path = engine.documentationFileName(namespaceName);
         indexMap.insert(namespaceName, QFileInfo(path).lastModified());
     }
@@ -537,6 +650,69 @@ void QHelpSearchIndexWriter::run()
     emit indexingFinished();
 }
 
+bool QHelpSearchIndexWriter::isCancelled()
+{
+    QMutexLocker lock(&m_mutex);
+    return m_cancel;
+}
+
+namespace {
+
+struct IndexedDocument
+{
+    QString url;
+    QString title;
+    QString contents;
+    QByteArray hash;
+};
+
+} // namespace
+
+static bool extractDocument(const FileToIndex &file, IndexedDocument *document)
+{
+    document->url = file.url;
+    document->hash = file.hash;
+    const QByteArray data = QHelpFileDataCodec::uncompress(file.compressedData, file.codec);
+    return QHelpHtmlTextExtractor::extractSearchText(file.url, data,
+                                                     &document->title, &document->contents);
+}
+
+static const int filesPerBatch = 32;
+
+// The files are decompressed and their text is extracted on the threads
+// of the pool, while this thread inserts the extracted documents into the
+// writer. Returns false when cancelled.
+bool QHelpSearchIndexWriter::indexFiles(Writer *writer, QThreadPool *pool,
+                                        const QString &namespaceName,
+                                        const QString &attributes,
+                                        const QList<FileToIndex> &files)
+{
+    const auto extract = [](const QList<FileToIndex> &batch) {
+        QThread::currentThread()->setPriority(QThread::LowestPriority);
+        QList<IndexedDocument> documents;
+        documents.reserve(batch.size());
+        for (const FileToIndex &file : batch) {
+            IndexedDocument document;
+            if (extractDocument(file, &document))
+                documents.append(document);
+        }
+        return documents;
+    };
+
+    const auto insert = [&](const QList<IndexedDocument> &documents) {
+        if (isCancelled())
+            return false;
+        for (const IndexedDocument &document : documents) {
+            writer->insertDoc(namespaceName, attributes, document.url,
+                              document.title, document.contents, document.hash);
+        }
+        writer->flush();
+        return true;
+    };
+
+    return QHelpBatchProcessor::processInOrder(pool, files, filesPerBatch, extract, insert);
+}
+
 }   // namespace std
 }   // namespace fulltextsearch
 
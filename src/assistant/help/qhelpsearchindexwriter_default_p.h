@@ -51,10 +51,15 @@
 // We mean it.
 //
 
+#include "qhelpfiledatacodec_p.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
 #include <QtCore/QMutex>
 #include <QtCore/QThread>
 
 QT_FORWARD_DECLARE_CLASS(QSqlDatabase)
+QT_FORWARD_DECLARE_CLASS(QThreadPool)
 
 QT_BEGIN_NAMESPACE
 
@@ -64,6 +69,12 @@ namespace qt {
 class Writer
 {
 public:
+    struct IndexedFile
+    {
+        qint64 id = 0;
+        QByteArray hash;
+    };
+
     Writer(const QString &path);
     ~Writer();
 
@@ -72,11 +83,14 @@ public:
 
     void removeNamespace(const QString &namespaceName);
     bool hasNamespace(const QString &namespaceName);
+    QHash<QString, IndexedFile> indexedFiles(const QString &namespaceName);
+    void removeDocuments(const QList<qint64> &ids);
     void insertDoc(const QString &namespaceName,
                    const QString &attributes,
                    const QString &url,
                    const QString &title,
-                   const QString &contents);
+                   const QString &contents,
+                   const QByteArray &hash);
     void startTransaction();
     void endTransaction();
 private:
@@ -94,6 +108,15 @@ private:
     QVariantList m_urls;
     QVariantList m_titles;
     QVariantList m_contents;
+    QVariantList m_hashes;
+};
+
+struct FileToIndex
+{
+    QString url;
+    QByteArray compressedData;
+    QByteArray hash;
+    int codec = QHelpFileDataCodec::Zlib;
 };
 
 
@@ -115,6 +138,10 @@ signals:
 
 private:
     void run() override;
+    bool isCancelled();
+    bool indexFiles(Writer *writer, QThreadPool *pool,
+                    const QString &namespaceName, const QString &attributes,
+                    const QList<FileToIndex> &files);
 
 private:
     QMutex m_mutex;
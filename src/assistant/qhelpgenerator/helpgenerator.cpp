@@ -40,6 +40,9 @@
 #include "helpgenerator.h"
 #include "qhelpprojectdata_p.h"
 #include <qhelp_global.h>
+#include <QtHelp/private/qhelpbatchprocessor_p.h>
+#include <QtHelp/private/qhelpfiledatacodec_p.h>
+#include <QtHelp/private/qhelphtmltextextractor_p.h>
 
 #include <QtCore/QtMath>
 #include <QtCore/QFile>
@@ -52,6 +55,7 @@
 #include <QtCore/QDateTime>
 #include <QtCore/QStringConverter>
 #include <QtCore/QDataStream>
+#include <QtCore/QThreadPool>
 #include <QtSql/QSqlQuery>
 
 #include <stdio.h>
@@ -70,21 +74,18 @@ public:
     bool checkLinks(const QHelpProjectData &helpData);
     QString error() const;
 
+    bool storeSearchText = false;
+    int fileDataCodec = QHelpFileDataCodec::Zlib;
+
 Q_SIGNALS:
     void statusChanged(const QString &msg);
     void progressChanged(double progress);
     void warning(const QString &msg);
 
 private:
-    struct FileNameTableData
-    {
-        QString name;
-        int fileId;
-        QString title;
-    };
-
     void writeTree(QDataStream &s, QHelpDataContentItem *item, int depth);
     bool createTables();
+    bool createIndexes();
     bool insertFileNotFoundFile();
     bool registerCustomFilter(const QString &filterName,
         const QStringList &filterAttribs, bool forceUpdate = false);
@@ -205,6 +206,12 @@ bool HelpGeneratorPrivate::generate(QHelpProjectData *helpData,
         }
     }
 
+    emit statusChanged(tr("Creating indexes..."));
+    if (!createIndexes()) {
+        cleanupDB();
+        return false;
+    }
+
     cleanupDB();
     emit progressChanged(100);
     emit statusChanged(tr("Documentation successfully generated."));
@@ -342,6 +349,65 @@ bool HelpGeneratorPrivate::createTables()
 
     m_query->exec(QLatin1String("INSERT INTO MetaDataTable VALUES('qchVersion', '1.0')"));
 
+    if (storeSearchText) {
+        if (!m_query->exec(QLatin1String("CREATE TABLE SearchTextTable("
+                                         "FileId INTEGER PRIMARY KEY, "
+                                         "Title TEXT, "
+                                         "Contents TEXT )"))) {
+            m_error = tr("Cannot create tables.");
+            return false;
+        }
+        m_query->prepare(QLatin1String("INSERT INTO MetaDataTable VALUES('searchTextVersion', ?)"));
+        m_query->bindValue(0, QHelpHtmlTextExtractor::SearchTextVersion);
+        m_query->exec();
+    }
+
+    // Only recorded for other codecs, so that zlib compressed files
+    // stay readable by older versions of Qt Help.
+    if (fileDataCodec != QHelpFileDataCodec::Zlib) {
+        m_query->prepare(QLatin1String("INSERT INTO MetaDataTable VALUES('fileDataCodec', ?)"));
+        m_query->bindValue(0, fileDataCodec);
+        m_query->exec();
+    }
+
+    return true;
+}
+
+/*!
+    Creates the indexes used by QHelpDBReader for file and keyword
+    lookups. They are created once all data has been inserted, which
+    is considerably cheaper than keeping them up to date row by row.
+*/
+bool HelpGeneratorPrivate::createIndexes()
+{
+    if (!m_query)
+        return false;
+
+    const QStringList indexes = QStringList()
+            << QLatin1String("CREATE INDEX IF NOT EXISTS FileNameTableNameIndex "
+                             "ON FileNameTable (Name, FolderId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS FileNameTableFileIdIndex "
+                             "ON FileNameTable (FileId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS FolderTableNameIndex "
+                             "ON FolderTable (Name)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS NamespaceTableNameIndex "
+                             "ON NamespaceTable (Name)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS IndexTableNameIndex "
+                             "ON IndexTable (Name)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS IndexTableIdentifierIndex "
+                             "ON IndexTable (Identifier)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS FileFilterTableFileIdIndex "
+                             "ON FileFilterTable (FileId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS IndexFilterTableIndexIdIndex "
+                             "ON IndexFilterTable (IndexId)");
+
+    for (const QString &q : indexes) {
+        if (!m_query->exec(q)) {
+            m_error = tr("Cannot create indexes.");
+            return false;
+        }
+    }
+
     return true;
 }
 
@@ -421,6 +487,59 @@ bool HelpGeneratorPrivate::registerVirtualFolder(const QString &folderName, cons
     return false;
 }
 
+namespace {
+
+struct ProcessedFile
+{
+    enum Status { Ok, Missing, Unreadable };
+
+    QString name;
+    Status status = Ok;
+    QString title;
+    QByteArray compressedData;
+    bool hasSearchText = false;
+    QString searchTitle;
+    QString searchContents;
+};
+
+} // namespace
+
+static void processFile(const QString &rootPath, bool storeSearchText, int codec,
+                        ProcessedFile *file)
+{
+    const QString &fileName = file->name;
+
+    QFile fi(rootPath + QDir::separator() + fileName);
+    if (!fi.exists()) {
+        file->status = ProcessedFile::Missing;
+        return;
+    }
+
+    if (!fi.open(QIODevice::ReadOnly)) {
+        file->status = ProcessedFile::Unreadable;
+        return;
+    }
+
+    const QByteArray data = fi.readAll();
+    if (fileName.endsWith(QLatin1String(".html"))
+        || fileName.endsWith(QLatin1String(".htm"))) {
+            file->title = QHelpGlobal::documentTitle(data);
+    } else {
+        file->title = fileName.mid(fileName.lastIndexOf(QLatin1Char('/')) + 1);
+    }
+
+    file->compressedData = QHelpFileDataCodec::compress(data, codec);
+
+    if (storeSearchText && (fileName.endsWith(QLatin1String(".html"))
+                            || fileName.endsWith(QLatin1String(".htm"))
+                            || fileName.endsWith(QLatin1String(".txt")))) {
+        file->hasSearchText = QHelpHtmlTextExtractor::extractSearchText(
+                    fileName, data, &file->searchTitle, &file->searchContents);
+    }
+}
+
+static const int filesPerBatch = 16;
+
 bool HelpGeneratorPrivate::insertFiles(const QStringList &files, const QString &rootPath,
                                  const QStringList &filterAttributes)
 {
@@ -458,58 +577,25 @@ bool HelpGeneratorPrivate::insertFiles(const QStringList &files, const QString &
     if (m_query->next())
         tableFileId = m_query->value(0).toInt() + 1;
 
-    QString title;
-    QString charSet;
-    QList<QByteArray> fileDataList;
     QMap<int, QSet<int> > tmpFileFilterMap;
-    QList<FileNameTableData> fileNameDataList;
 
-    int i = 0;
+    // Files inserted before only get the new filter attributes, the
+    // others are read, compressed and inserted below. A file listed
+    // twice in this section gets the same attributes, so it is
+    // processed once.
+    QStringList newFiles;
+    QSet<QString> queuedFiles;
     for (const QString &file : files) {
         const QString fileName = QDir::cleanPath(file);
 
-        QFile fi(rootPath + QDir::separator() + fileName);
-        if (!fi.exists()) {
-            emit warning(tr("The file %1 does not exist, skipping it...")
-                .arg(QDir::cleanPath(rootPath + QDir::separator() + fileName)));
-            continue;
-        }
-
-        if (!fi.open(QIODevice::ReadOnly)) {
-            emit warning(tr("Cannot open file %1, skipping it...")
-                .arg(QDir::cleanPath(rootPath + QDir::separator() + fileName)));
-            continue;
-        }
-
-        QByteArray data = fi.readAll();
-        if (fileName.endsWith(QLatin1String(".html"))
-            || fileName.endsWith(QLatin1String(".htm"))) {
-                auto encoding = QStringDecoder::encodingForHtml(data.constData(), data.size());
-                if (!encoding)
-                    encoding = QStringDecoder::Utf8;
-                title = QHelpGlobal::documentTitle(QStringDecoder(*encoding)(data));
-        } else {
-            title = fileName.mid(fileName.lastIndexOf(QLatin1Char('/')) + 1);
-        }
-
-        int fileId = -1;
         const auto &it = m_fileMap.constFind(fileName);
         if (it == m_fileMap.cend()) {
-            fileDataList.append(qCompress(data));
-
-            FileNameTableData fileNameData;
-            fileNameData.name = fileName;
-            fileNameData.fileId = tableFileId;
-            fileNameData.title = title;
-            fileNameDataList.append(fileNameData);
-
-            m_fileMap.insert(fileName, tableFileId);
-            m_fileFilterMap.insert(tableFileId, filterAtts);
-            tmpFileFilterMap.insert(tableFileId, filterAtts);
-
-            ++tableFileId;
+            if (!queuedFiles.contains(fileName)) {
+                queuedFiles.insert(fileName);
+                newFiles.append(fileName);
+            }
         } else {
-            fileId = it.value();
+            const int fileId = it.value();
             QSet<int> &fileFilterSet = m_fileFilterMap[fileId];
             QSet<int> &tmpFileFilterSet = tmpFileFilterMap[fileId];
             for (int filter : qAsConst(filterAtts)) {
@@ -522,40 +608,127 @@ bool HelpGeneratorPrivate::insertFiles(const QStringList &files, const QString &
         }
     }
 
+    const QSqlDatabase db = QSqlDatabase::database(QLatin1String("builder"), false);
+    QSqlQuery dataQuery(db);
+    dataQuery.prepare(QLatin1String("INSERT INTO FileDataTable VALUES (Null, ?)"));
+    QSqlQuery nameQuery(db);
+    nameQuery.prepare(QLatin1String("INSERT INTO FileNameTable "
+        "(FolderId, Name, FileId, Title) VALUES (?, ?, ?, ?)"));
+    QSqlQuery searchTextQuery(db);
+    if (storeSearchText) {
+        searchTextQuery.prepare(QLatin1String("INSERT INTO SearchTextTable "
+            "(FileId, Title, Contents) VALUES (?, ?, ?)"));
+    }
+
+    m_query->exec(QLatin1String("BEGIN"));
+
+    // The files are read, compressed and their titles are extracted on
+    // the threads of the pool, this thread inserts them into the database.
+    const bool extractSearchText = storeSearchText;
+    const int codec = fileDataCodec;
+    const auto process = [rootPath, extractSearchText, codec](const QStringList &names) {
+        QList<ProcessedFile> batch;
+        batch.reserve(names.size());
+        for (const QString &name : names) {
+            ProcessedFile file;
+            file.name = name;
+            processFile(rootPath, extractSearchText, codec, &file);
+            batch.append(file);
+        }
+        return batch;
+    };
+
+    int i = 0;
+    const auto insert = [&](const QList<ProcessedFile> &batch) {
+        QVariantList fileData;
+        QVariantList folderIds;
+        QVariantList names;
+        QVariantList fileIds;
+        QVariantList titles;
+        QVariantList searchTextFileIds;
+        QVariantList searchTitles;
+        QVariantList searchContents;
+
+        for (const ProcessedFile &file : batch) {
+            if (file.status == ProcessedFile::Missing) {
+                emit warning(tr("The file %1 does not exist, skipping it...")
+                    .arg(QDir::cleanPath(rootPath + QDir::separator() + file.name)));
+                continue;
+            }
+            if (file.status == ProcessedFile::Unreadable) {
+                emit warning(tr("Cannot open file %1, skipping it...")
+                    .arg(QDir::cleanPath(rootPath + QDir::separator() + file.name)));
+                continue;
+            }
+
+            fileData.append(file.compressedData);
+            folderIds.append(1);
+            names.append(file.name);
+            fileIds.append(tableFileId);
+            titles.append(file.title);
+            if (file.hasSearchText) {
+                searchTextFileIds.append(tableFileId);
+                searchTitles.append(file.searchTitle);
+                searchContents.append(file.searchContents);
+            }
+
+            m_fileMap.insert(file.name, tableFileId);
+            m_fileFilterMap.insert(tableFileId, filterAtts);
+            tmpFileFilterMap.insert(tableFileId, filterAtts);
+
+            ++tableFileId;
+        }
+
+        if (!fileData.isEmpty()) {
+            dataQuery.addBindValue(fileData);
+            dataQuery.execBatch();
+
+            nameQuery.addBindValue(folderIds);
+            nameQuery.addBindValue(names);
+            nameQuery.addBindValue(fileIds);
+            nameQuery.addBindValue(titles);
+            nameQuery.execBatch();
+        }
+
+        if (!searchTextFileIds.isEmpty()) {
+            searchTextQuery.addBindValue(searchTextFileIds);
+            searchTextQuery.addBindValue(searchTitles);
+            searchTextQuery.addBindValue(searchContents);
+            searchTextQuery.execBatch();
+        }
+
+        for (int j = 0; j < fileData.count(); ++j) {
+            if (++i % 20 == 0)
+                addProgress(m_fileStep * 20.0);
+        }
+        return true;
+    };
+
+    QThreadPool pool;
+    QHelpBatchProcessor::processInOrder(&pool, newFiles, filesPerBatch, process, insert);
+
     if (!tmpFileFilterMap.isEmpty()) {
-        m_query->exec(QLatin1String("BEGIN"));
+        QVariantList filterIds;
+        QVariantList fileIds;
         for (auto it = tmpFileFilterMap.cbegin(), end = tmpFileFilterMap.cend(); it != end; ++it) {
             QList<int> filterValues = it.value().values();
             std::sort(filterValues.begin(), filterValues.end());
             for (int fv : qAsConst(filterValues)) {
-                m_query->prepare(QLatin1String("INSERT INTO FileFilterTable "
-                    "VALUES(?, ?)"));
-                m_query->bindValue(0, fv);
-                m_query->bindValue(1, it.key());
-                m_query->exec();
+                filterIds.append(fv);
+                fileIds.append(it.key());
             }
         }
 
-        for (const QByteArray &fileData : qAsConst(fileDataList)) {
-            m_query->prepare(QLatin1String("INSERT INTO FileDataTable VALUES "
-                "(Null, ?)"));
-            m_query->bindValue(0, fileData);
-            m_query->exec();
-            if (++i % 20 == 0)
-                addProgress(m_fileStep * 20.0);
-        }
-
-        for (const FileNameTableData &fnd : qAsConst(fileNameDataList)) {
-            m_query->prepare(QLatin1String("INSERT INTO FileNameTable "
-                "(FolderId, Name, FileId, Title) VALUES (?, ?, ?, ?)"));
-            m_query->bindValue(0, 1);
-            m_query->bindValue(1, fnd.name);
-            m_query->bindValue(2, fnd.fileId);
-            m_query->bindValue(3, fnd.title);
-            m_query->exec();
+        if (!filterIds.isEmpty()) {
+            QSqlQuery filterQuery(db);
+            filterQuery.prepare(QLatin1String("INSERT INTO FileFilterTable "
+                "VALUES(?, ?)"));
+            filterQuery.addBindValue(filterIds);
+            filterQuery.addBindValue(fileIds);
+            filterQuery.execBatch();
         }
-        m_query->exec(QLatin1String("COMMIT"));
     }
+    m_query->exec(QLatin1String("COMMIT"));
 
     m_query->exec(QLatin1String("SELECT MAX(Id) FROM FileDataTable"));
     if (m_query->next()
@@ -852,6 +1025,26 @@ HelpGenerator::HelpGenerator(bool silent)
             this, &HelpGenerator::printWarning);
 }
 
+/*!
+    Sets whether the text of HTML and text files is extracted and stored
+    along with them, so that it does not need to be extracted again when
+    the documentation is indexed for full text search.
+*/
+void HelpGenerator::setStoreSearchText(bool store)
+{
+    m_private->storeSearchText = store;
+}
+
+/*!
+    Sets the \a codec the file data is compressed with, see
+    QHelpFileDataCodec. Zlib is used by default, as other codecs
+    cannot be read by versions of Qt Help before 6.0.
+*/
+void HelpGenerator::setFileDataCodec(int codec)
+{
+    m_private->fileDataCodec = codec;
+}
+
 bool HelpGenerator::generate(QHelpProjectData *helpData,
                              const QString &outputFileName)
 {
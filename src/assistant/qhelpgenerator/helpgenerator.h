@@ -53,6 +53,8 @@ class HelpGenerator : public QObject
 
 public:
     HelpGenerator(bool silent = false);
+    void setStoreSearchText(bool store);
+    void setFileDataCodec(int codec);
     bool generate(QHelpProjectData *helpData,
         const QString &outputFileName);
     bool checkLinks(const QHelpProjectData &helpData);
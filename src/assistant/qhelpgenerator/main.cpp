@@ -42,6 +42,7 @@
 #include <QtGui/QGuiApplication>
 
 #include <QtHelp/QHelpEngineCore>
+#include <QtHelp/private/qhelpfiledatacodec_p.h>
 
 
 QT_USE_NAMESPACE
@@ -63,7 +64,8 @@ namespace {
     }
 }
 
-int generateCollectionFile(const QByteArray &data, const QString &basePath, const QString outputFile)
+int generateCollectionFile(const QByteArray &data, const QString &basePath, const QString outputFile,
+                           bool storeSearchText, int fileDataCodec)
 {
     fputs(qPrintable(QHG::tr("Reading collection config file...\n")), stdout);
     CollectionConfigReader config;
@@ -84,6 +86,8 @@ int generateCollectionFile(const QByteArray &data, const QString &basePath, cons
         }
 
         HelpGenerator helpGenerator;
+        helpGenerator.setStoreSearchText(storeSearchText);
+        helpGenerator.setFileDataCodec(fileDataCodec);
         if (!helpGenerator.generate(&helpData, absoluteFilePath(basePath, it.value()))) {
             fprintf(stderr, "%s\n", qPrintable(helpGenerator.error()));
             return 1;
@@ -256,6 +260,8 @@ int main(int argc, char *argv[])
     bool showVersion = false;
     bool checkLinks = false;
     bool silent = false;
+    bool storeSearchText = false;
+    int fileDataCodec = QHelpFileDataCodec::Zlib;
 
     // don't require a window manager even though we're a QGuiApplication
     qputenv("QT_QPA_PLATFORM", QByteArrayLiteral("minimal"));
@@ -293,6 +299,21 @@ int main(int argc, char *argv[])
             checkLinks = true;
         } else if (arg == QLatin1String("-s")) {
             silent = true;
+        } else if (arg == QLatin1String("-i")) {
+            storeSearchText = true;
+        } else if (arg == QLatin1String("-z")) {
+            if (++i < argc) {
+                const QString codecName = QString::fromLocal8Bit(argv[i]);
+                fileDataCodec = QHelpFileDataCodec::codecFromName(codecName);
+                if (fileDataCodec < 0) {
+                    error = QHG::tr("Unknown compression codec %1.").arg(codecName);
+                } else if (!QHelpFileDataCodec::isSupported(fileDataCodec)) {
+                    error = QHG::tr("Compression codec %1 is not supported by this build.")
+                            .arg(codecName);
+                }
+            } else {
+                error = QHG::tr("Missing compression codec.");
+            }
         } else {
             const QFileInfo fi(arg);
             inputFile = fi.absoluteFilePath();
@@ -343,6 +364,14 @@ int main(int argc, char *argv[])
         "  -c                     Checks whether all links in HTML files\n"
         "                         point to files in this help project.\n"
         "  -s                     Suppresses status messages.\n"
+        "  -i                     Stores the text of all HTML files\n"
+        "                         for the full text search, so that\n"
+        "                         it is not extracted again when the\n"
+        "                         documentation is indexed.\n"
+        "  -z <codec>             Compresses the files with <codec>,\n"
+        "                         zlib (the default) or zstd. Files\n"
+        "                         compressed with zstd load faster, but\n"
+        "                         cannot be read before Qt 6.0.\n"
         "  -v                     Displays the version of \n"
         "                         qhelpgenerator.\n\n");
 
@@ -390,6 +419,8 @@ int main(int argc, char *argv[])
         }
 
         HelpGenerator generator(silent);
+        generator.setStoreSearchText(storeSearchText);
+        generator.setFileDataCodec(fileDataCodec);
         bool success = true;
         if (checkLinks)
             success = generator.checkLinks(*helpData);
@@ -402,7 +433,8 @@ int main(int argc, char *argv[])
         }
     } else {
         const QByteArray data = file.readAll();
-        return generateCollectionFile(data, basePath, outputFile);
+        return generateCollectionFile(data, basePath, outputFile, storeSearchText,
+                                      fileDataCodec);
 
     }
 
@@ -76,6 +76,12 @@ PhraseView::PhraseView(MultiDataModel *model, QList<QHash<QString, QList<Phrase
 
     connect(this, &QAbstractItemView::activated,
             this, &PhraseView::selectPhrase);
+
+    // Model numbers and message positions change when files come and go
+    const auto dropGuessIndexes = [this]() { m_guessIndexes.clear(); };
+    connect(m_dataModel, &MultiDataModel::modelAppended, this, dropGuessIndexes);
+    connect(m_dataModel, &MultiDataModel::modelDeleted, this, dropGuessIndexes);
+    connect(m_dataModel, &MultiDataModel::allModelsDeleted, this, dropGuessIndexes);
 }
 
 PhraseView::~PhraseView()
@@ -192,49 +198,38 @@ void PhraseView::resetNumGuesses()
     setSourceText(m_modelIndex, m_sourceText);
 }
 
-static CandidateList similarTextHeuristicCandidates(MultiDataModel *model, int mi,
-    const char *text, int maxCandidates)
+CandidateList PhraseView::similarTextHeuristicCandidates(int mi, const char *text,
+                                                        int maxCandidates)
 {
+    auto indexIt = m_guessIndexes.find(mi);
+    if (indexIt == m_guessIndexes.end()) {
+        indexIt = m_guessIndexes.insert(mi, GuessIndex());
+        for (MultiDataModelIterator it(m_dataModel, mi); it.isValid(); ++it) {
+            if (MessageItem *m = it.current()) {
+                indexIt->texts.addText(m->text());
+                indexIt->messages.append(qMakePair(it.context(), it.message()));
+            }
+        }
+    }
+    const GuessIndex &index = *indexIt;
+
     QList<int> scores;
     CandidateList candidates;
 
-    StringSimilarityMatcher stringmatcher(QString::fromLatin1(text));
-
-    for (MultiDataModelIterator it(model, mi); it.isValid(); ++it) {
-        MessageItem *m = it.current();
-        if (!m)
-            continue;
+    const auto matches = index.texts.matches(QString::fromLatin1(text));
+    for (const auto &match : matches) {
+        const QPair<int, int> &pos = index.messages.at(match.first);
+        MessageItem *m = m_dataModel->messageItem(MultiDataIndex(mi, pos.first, pos.second));
 
+        // Translations change all the time, so they are not part of the index.
         TranslatorMessage mtm = m->message();
         if (mtm.type() == TranslatorMessage::Unfinished
             || mtm.translation().isEmpty())
             continue;
 
-        QString s = m->text();
-
-        int score = stringmatcher.getSimilarityScore(s);
-
-        if (candidates.count() == maxCandidates && score > scores[maxCandidates - 1])
-            candidates.removeLast();
-        if (candidates.count() < maxCandidates && score >= textSimilarityThreshold ) {
-            Candidate cand(mtm.context(), s, mtm.comment(), mtm.translation());
-
-            int i;
-            for (i = 0; i < candidates.size(); ++i) {
-                if (score >= scores.at(i)) {
-                    if (score == scores.at(i)) {
-                        if (candidates.at(i) == cand)
-                            goto continue_outer_loop;
-                    } else {
-                        break;
-                    }
-                }
-            }
-            scores.insert(i, score);
-            candidates.insert(i, cand);
-        }
-        continue_outer_loop:
-        ;
+        addSimilarTextCandidate(candidates, scores, maxCandidates, match.second,
+                                Candidate(mtm.context(), m->text(), mtm.comment(),
+                                          mtm.translation()));
     }
     return candidates;
 }
@@ -255,7 +250,7 @@ void PhraseView::setSourceText(int model, const QString &sourceText)
         m_phraseModel->addPhrase(p);
 
     if (!sourceText.isEmpty() && m_doGuesses) {
-        const CandidateList cl = similarTextHeuristicCandidates(m_dataModel, model,
+        const CandidateList cl = similarTextHeuristicCandidates(model,
             sourceText.toLatin1(), m_maxCandidates);
         int n = 0;
         for (const Candidate &candidate : cl) {
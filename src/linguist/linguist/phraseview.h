@@ -106,8 +106,15 @@ private slots:
 
 private:
     QList<Phrase *> getPhrases(int model, const QString &sourceText);
+    CandidateList similarTextHeuristicCandidates(int model, const char *text, int maxCandidates);
     void deleteGuesses();
 
+    // The source texts of the messages of a model, for finding guesses
+    struct GuessIndex {
+        SimilarTextIndex texts;
+        QList<QPair<int, int>> messages; // context and message numbers
+    };
+
     MultiDataModel *m_dataModel;
     QList<QHash<QString, QList<Phrase *> > > *m_phraseDict;
     QList<Phrase *> m_guesses;
@@ -116,6 +123,7 @@ private:
     int m_modelIndex;
     bool m_doGuesses;
     int m_maxCandidates = DefaultMaxCandidates;
+    QHash<int, GuessIndex> m_guessIndexes;
 };
 
 QT_END_NAMESPACE
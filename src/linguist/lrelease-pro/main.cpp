@@ -115,6 +115,16 @@ int main(int argc, char **argv)
         } else if (!strcmp(argv[i], "-help")) {
             printUsage();
             return 0;
+        } else if (!strcmp(argv[i], "-j") || !strcmp(argv[i], "-markuntranslated")) {
+            // lrelease options with a parameter
+            if (i == argc - 1) {
+                printErr(LR::tr("The option %1 requires a parameter.\n")
+                         .arg(QString::fromLocal8Bit(argv[i])));
+                return 1;
+            }
+            lreleaseOptions << QString::fromLocal8Bit(argv[i])
+                            << QString::fromLocal8Bit(argv[i + 1]);
+            ++i;
         } else if (strlen(argv[i]) > 0 && argv[i][0] == '-') {
             lreleaseOptions << QString::fromLocal8Bit(argv[i]);
         } else {
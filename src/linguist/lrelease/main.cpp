@@ -36,8 +36,10 @@
 #include <QtCore/QCoreApplication>
 #include <QtCore/QTranslator>
 #endif
+#include <QtCore/QDateTime>
 #include <QtCore/QDebug>
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QString>
@@ -45,6 +47,11 @@
 #include <QtCore/QTextStream>
 #include <QtCore/QLibraryInfo>
 
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include <vector>
+
 QT_USE_NAMESPACE
 
 #ifdef QT_BOOTSTRAPPED
@@ -72,6 +79,51 @@ static void printErr(const QString & out)
     stream << out;
 }
 
+/*
+  What releasing a file prints. When several files are released at once,
+  it is kept until the file is done, so the outputs do not get mixed up.
+*/
+class ReleaseOutput
+{
+public:
+    explicit ReleaseOutput(bool buffered = false) : m_buffered(buffered) {}
+
+    void printOut(const QString &text) { print(false, text); }
+    void printErr(const QString &text) { print(true, text); }
+
+    void flush()
+    {
+        for (const auto &chunk : qAsConst(m_chunks)) {
+            if (chunk.first)
+                ::printErr(chunk.second);
+            else
+                ::printOut(chunk.second);
+        }
+        m_chunks.clear();
+    }
+
+private:
+    void print(bool isErr, const QString &text)
+    {
+        if (m_buffered)
+            m_chunks.append(qMakePair(isErr, text));
+        else if (isErr)
+            ::printErr(text);
+        else
+            ::printOut(text);
+    }
+
+    bool m_buffered;
+    QList<QPair<bool, QString>> m_chunks;
+};
+
+struct ReleaseOptions
+{
+    bool removeIdentical = false;
+    bool incremental = false;
+    bool printTimings = false;
+};
+
 static void printUsage()
 {
     printOut(LR::tr(
@@ -101,6 +153,15 @@ static void printUsage()
         "    -project <filename>\n"
         "           Name of a file containing the project's description in JSON format.\n"
         "           Such a file may be generated from a .pro file using the lprodump tool.\n"
+        "    -j <n>\n"
+        "           Release up to <n> TS files at the same time. 0 means one per core.\n"
+        "           Does not apply to -qm (default: 1).\n"
+        "    -incremental\n"
+        "           Do not release QM files which are newer than their TS files, and\n"
+        "           were released with the same options. The options are kept in\n"
+        "           <qm-file>.stamp.\n"
+        "    -timings\n"
+        "           Print how long releasing each QM file took\n"
         "    -silent\n"
         "           Do not explain what is being done\n"
         "    -version\n"
@@ -108,36 +169,39 @@ static void printUsage()
     ));
 }
 
-static bool loadTsFile(Translator &tor, const QString &tsFileName, bool /* verbose */)
+static bool loadTsFile(Translator &tor, const QString &tsFileName, ReleaseOutput &output)
 {
     ConversionData cd;
     bool ok = tor.load(tsFileName, cd, QLatin1String("auto"));
     if (!ok) {
-        printErr(LR::tr("lrelease error: %1").arg(cd.error()));
+        output.printErr(LR::tr("lrelease error: %1").arg(cd.error()));
     } else {
         if (!cd.errors().isEmpty())
-            printOut(cd.error());
+            output.printOut(cd.error());
     }
     cd.clearErrors();
     return ok;
 }
 
 static bool releaseTranslator(Translator &tor, const QString &qmFileName,
-    ConversionData &cd, bool removeIdentical)
+    ConversionData &cd, const ReleaseOptions &options, ReleaseOutput &output)
 {
-    tor.reportDuplicates(tor.resolveDuplicates(), qmFileName, cd.isVerbose());
+    std::ostringstream duplicates;
+    tor.reportDuplicates(tor.resolveDuplicates(), qmFileName, cd.isVerbose(), duplicates);
+    if (duplicates.tellp() > 0)
+        output.printErr(QString::fromLocal8Bit(duplicates.str().c_str()));
 
     if (cd.isVerbose())
-        printOut(LR::tr("Updating '%1'...\n").arg(qmFileName));
-    if (removeIdentical) {
+        output.printOut(LR::tr("Updating '%1'...\n").arg(qmFileName));
+    if (options.removeIdentical) {
         if (cd.isVerbose())
-            printOut(LR::tr("Removing translations equal to source text in '%1'...\n").arg(qmFileName));
+            output.printOut(LR::tr("Removing translations equal to source text in '%1'...\n").arg(qmFileName));
         tor.stripIdenticalSourceTranslations();
     }
 
     QFile file(qmFileName);
     if (!file.open(QIODevice::WriteOnly)) {
-        printErr(LR::tr("lrelease error: cannot create '%1': %2\n")
+        output.printErr(LR::tr("lrelease error: cannot create '%1': %2\n")
                                 .arg(qmFileName, file.errorString()));
         return false;
     }
@@ -147,22 +211,100 @@ static bool releaseTranslator(Translator &tor, const QString &qmFileName,
     file.close();
 
     if (!ok) {
-        printErr(LR::tr("lrelease error: cannot save '%1': %2")
+        output.printErr(LR::tr("lrelease error: cannot save '%1': %2")
                                 .arg(qmFileName, cd.error()));
     } else if (!cd.errors().isEmpty()) {
-        printOut(cd.error());
+        output.printOut(cd.error());
     }
     cd.clearErrors();
     return ok;
 }
 
-static bool releaseTsFile(const QString& tsFileName,
-    ConversionData &cd, bool removeIdentical)
+static QString stampFileName(const QString &qmFileName)
 {
+    return qmFileName + QLatin1String(".stamp");
+}
+
+// Everything besides the contents of the TS files that makes up a QM file
+static QByteArray releaseStamp(const QStringList &tsFileNames, const ConversionData &cd,
+                               const ReleaseOptions &options)
+{
+    QByteArray stamp = "lrelease " QT_VERSION_STR "\n";
+    stamp += "idbased " + QByteArray::number(cd.m_idBased) + '\n';
+    stamp += "savemode " + QByteArray::number(int(cd.m_saveMode)) + '\n';
+    stamp += "nounfinished " + QByteArray::number(cd.m_ignoreUnfinished) + '\n';
+    stamp += "removeidentical " + QByteArray::number(options.removeIdentical) + '\n';
+    stamp += "markuntranslated " + cd.m_unTrPrefix.toUtf8() + '\n';
+    for (const QString &tsFileName : tsFileNames)
+        stamp += "source " + QFileInfo(tsFileName).absoluteFilePath().toUtf8() + '\n';
+    return stamp;
+}
+
+static bool isUpToDate(const QStringList &tsFileNames, const QString &qmFileName,
+                       const QByteArray &stamp)
+{
+    const QFileInfo qmInfo(qmFileName);
+    if (!qmInfo.exists())
+        return false;
+    const QDateTime released = qmInfo.lastModified();
+    for (const QString &tsFileName : tsFileNames) {
+        const QFileInfo tsInfo(tsFileName);
+        if (!tsInfo.exists() || tsInfo.lastModified() >= released)
+            return false;
+    }
+    QFile stampFile(stampFileName(qmFileName));
+    return stampFile.open(QIODevice::ReadOnly) && stampFile.readAll() == stamp;
+}
+
+static void writeStamp(const QString &qmFileName, const QByteArray &stamp)
+{
+    QFile stampFile(stampFileName(qmFileName));
+    if (stampFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        stampFile.write(stamp);
+}
+
+/*
+  Releases \a tsFileNames into \a qmFileName unless the QM file is up to
+  date, taking care of the stamp file and the timings.
+*/
+static bool releaseIfNeeded(const QStringList &tsFileNames,
+    const QString &qmFileName, ConversionData &cd, const ReleaseOptions &options,
+    ReleaseOutput &output)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QByteArray stamp;
+    if (options.incremental) {
+        stamp = releaseStamp(tsFileNames, cd, options);
+        if (isUpToDate(tsFileNames, qmFileName, stamp)) {
+            if (cd.isVerbose())
+                output.printOut(LR::tr("'%1' is up to date.\n").arg(qmFileName));
+            return true;
+        }
+        // A failed release must not look up to date next time.
+        QFile::remove(stampFileName(qmFileName));
+    }
+
     Translator tor;
-    if (!loadTsFile(tor, tsFileName, cd.isVerbose()))
+    for (const QString &tsFileName : tsFileNames) {
+        if (!loadTsFile(tor, tsFileName, output))
+            return false;
+    }
+
+    if (!releaseTranslator(tor, qmFileName, cd, options, output))
         return false;
+    if (options.incremental)
+        writeStamp(qmFileName, stamp);
+    if (options.printTimings) {
+        output.printOut(LR::tr("Released '%1' in %2 ms.\n")
+                        .arg(qmFileName).arg(timer.elapsed()));
+    }
+    return true;
+}
 
+static QString qmFileNameFor(const QString &tsFileName)
+{
     QString qmFileName = tsFileName;
     for (const Translator::FileFormat &fmt : qAsConst(Translator::registeredFileFormats())) {
         if (qmFileName.endsWith(QLatin1Char('.') + fmt.extension)) {
@@ -171,8 +313,67 @@ static bool releaseTsFile(const QString& tsFileName,
         }
     }
     qmFileName += QLatin1String(".qm");
+    return qmFileName;
+}
 
-    return releaseTranslator(tor, qmFileName, cd, removeIdentical);
+static bool releaseTsFile(const QString& tsFileName,
+    ConversionData &cd, const ReleaseOptions &options, ReleaseOutput &output)
+{
+    return releaseIfNeeded(QStringList(tsFileName), qmFileNameFor(tsFileName), cd,
+                           options, output);
+}
+
+/*
+  Releases each of \a tsFileNames into its own QM file, using up to
+  \a threads threads. The output is the same as when releasing the
+  files one after the other, and so is the point where it stops if a
+  file fails, except that files after the failing one may already
+  have been released.
+*/
+static bool releaseTsFiles(const QStringList &tsFileNames, ConversionData &cd,
+    const ReleaseOptions &options, int threads)
+{
+    if (threads <= 1 || tsFileNames.size() <= 1) {
+        for (const QString &tsFileName : tsFileNames) {
+            ReleaseOutput output;
+            if (!releaseTsFile(tsFileName, cd, options, output))
+                return false;
+        }
+        return true;
+    }
+
+    const int count = tsFileNames.size();
+    std::vector<ReleaseOutput> outputs(count, ReleaseOutput(true));
+    std::vector<char> results(count, false);
+    std::atomic<int> next(0);
+    std::atomic<int> firstFailure(count);
+
+    const auto worker = [&]() {
+        for (;;) {
+            const int i = next.fetch_add(1);
+            if (i >= count || i > firstFailure.load())
+                return;
+            ConversionData fileCd = cd;
+            results[i] = releaseTsFile(tsFileNames.at(i), fileCd, options, outputs[i]);
+            if (!results[i]) {
+                int failure = firstFailure.load();
+                while (i < failure && !firstFailure.compare_exchange_weak(failure, i)) {
+                }
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 0; t < qMin(threads, count); ++t)
+        workers.emplace_back(worker);
+    for (std::thread &t : workers)
+        t.join();
+
+    for (int i = 0; i < count; ++i) {
+        outputs[i].flush();
+        if (!results[i])
+            return false;
+    }
+    return true;
 }
 
 static QStringList translationsFromProjects(const Projects &projects, bool topLevel);
@@ -217,8 +418,8 @@ int main(int argc, char **argv)
 
     ConversionData cd;
     cd.m_verbose = true; // the default is true starting with Qt 4.2
-    bool removeIdentical = false;
-    Translator tor;
+    ReleaseOptions options;
+    int threads = 1;
     QStringList inputFiles;
     QString outputFile;
     QString projectDescriptionFile;
@@ -234,8 +435,27 @@ int main(int argc, char **argv)
             cd.m_saveMode = SaveEverything;
             continue;
         } else if (!strcmp(argv[i], "-removeidentical")) {
-            removeIdentical = true;
+            options.removeIdentical = true;
+            continue;
+        } else if (!strcmp(argv[i], "-incremental")) {
+            options.incremental = true;
             continue;
+        } else if (!strcmp(argv[i], "-timings")) {
+            options.printTimings = true;
+            continue;
+        } else if (!strcmp(argv[i], "-j")) {
+            if (i == argc - 1) {
+                printErr(LR::tr("The option -j requires a parameter.\n"));
+                return 1;
+            }
+            bool ok = false;
+            threads = QString::fromLocal8Bit(argv[++i]).toInt(&ok);
+            if (!ok || threads < 0) {
+                printErr(LR::tr("Invalid parameter passed to -j.\n"));
+                return 1;
+            }
+            if (threads == 0)
+                threads = qMax(1, int(std::thread::hardware_concurrency()));
         } else if (!strcmp(argv[i], "-nounfinished")) {
             cd.m_ignoreUnfinished = true;
             continue;
@@ -305,18 +525,9 @@ int main(int argc, char **argv)
         inputFiles = translationsFromProjects(projectDescription);
     }
 
-    for (const QString &inputFile : qAsConst(inputFiles)) {
-        if (outputFile.isEmpty()) {
-            if (!releaseTsFile(inputFile, cd, removeIdentical))
-                return 1;
-        } else {
-            if (!loadTsFile(tor, inputFile, cd.isVerbose()))
-                return 1;
-        }
-    }
-
-    if (!outputFile.isEmpty())
-        return releaseTranslator(tor, outputFile, cd, removeIdentical) ? 0 : 1;
+    if (outputFile.isEmpty())
+        return releaseTsFiles(inputFiles, cd, options, threads) ? 0 : 1;
 
-    return 0;
+    ReleaseOutput output;
+    return releaseIfNeeded(inputFiles, outputFile, cd, options, output) ? 0 : 1;
 }
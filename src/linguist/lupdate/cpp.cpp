@@ -27,12 +27,25 @@
 ****************************************************************************/
 
 #include "cpp.h"
+#include "synchronized.h"
 
 #include <translator.h>
 #include <QtCore/QBitArray>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QMutex>
+#include <QtCore/QSaveFile>
 #include <QtCore/QStack>
 #include <QtCore/QTextStream>
+#include <QtCore/QThread>
 #include <QtCore/QRegularExpression>
+#include <QtCore/QWaitCondition>
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <sstream>
+#include <thread>
 
 QT_BEGIN_NAMESPACE
 
@@ -65,7 +78,8 @@ size_t qHash(const HashStringList &list)
     return list.m_hash;
 }
 
-static int nextFileId;
+static std::atomic<int> nextFileId;
+static bool recordDependencies;
 
 class VisitRecorder {
 public:
@@ -75,6 +89,9 @@ public:
     }
     bool tryVisit(int fileId)
     {
+        // Other threads may have registered files since we were created.
+        if (fileId >= m_ba.size())
+            m_ba.resize(nextFileId);
         if (m_ba.at(fileId))
             return false;
         m_ba[fileId] = true;
@@ -263,9 +280,58 @@ CppParser::CppParser(ParseResults *_results)
 }
 
 
+/*
+  During a parallel run, the warnings are collected for each file which is parsed
+  stand-alone, i.e. the input files and the headers whose results are shared, along
+  with the shared headers that file included. Which thread parses a shared header
+  depends on scheduling, so its warnings are kept apart from the file which happened
+  to include it first. printCollectedWarnings() prints them in the order of a serial
+  run, and they are dropped if the run has to be repeated serially.
+*/
+struct CollectedWarnings {
+    std::string text;
+    QStringList includes;
+};
+
+struct WarningCollector {
+    std::ostringstream text;
+    QStringList includes;
+};
+
+static thread_local WarningCollector *yyWarnings = nullptr;
+static QMutex collectedWarningsMutex;
+static QHash<QString, CollectedWarnings> collectedWarnings;
+
+static void storeWarnings(const QString &cleanFile, const WarningCollector &collector)
+{
+    const std::string text = collector.text.str();
+    if (text.empty() && collector.includes.isEmpty())
+        return;
+    QMutexLocker locker(&collectedWarningsMutex);
+    CollectedWarnings &warnings = collectedWarnings[cleanFile];
+    warnings.text += text;
+    warnings.includes += collector.includes;
+}
+
+/*
+  A serial run parses a shared header when the first file including it is parsed,
+  so the warnings of the headers a file included are printed before its own.
+*/
+static void printCollectedWarnings(const QString &cleanFile, QSet<QString> *printed)
+{
+    if (printed->contains(cleanFile))
+        return;
+    printed->insert(cleanFile);
+    const CollectedWarnings warnings = collectedWarnings.value(cleanFile);
+    for (const QString &include : warnings.includes)
+        printCollectedWarnings(include, printed);
+    std::cerr << warnings.text;
+}
+
 std::ostream &CppParser::yyMsg(int line)
 {
-    return std::cerr << qPrintable(yyFileName) << ':' << (line ? line : yyLineNo) << ": ";
+    std::ostream &out = yyWarnings ? static_cast<std::ostream &>(yyWarnings->text) : std::cerr;
+    return out << qPrintable(yyFileName) << ':' << (line ? line : yyLineNo) << ": ";
 }
 
 void CppParser::setInput(const QString &in)
@@ -1023,6 +1089,12 @@ bool CppParser::qualifyOneCallbackOwn(const Namespace *ns, void *context) const
         *data->resolved << data->segment;
         return true;
     }
+    // Delayed alias resolution modifies namespaces which may belong to other files'
+    // results, and these are shared between parser threads.
+    static QRecursiveMutex aliasMutex;
+    QMutexLocker locker(&aliasMutex);
+    if (ns->aliases.isEmpty())
+        return false;
     auto nsai = ns->aliases.constFind(data->segment);
     if (nsai != ns->aliases.constEnd()) {
         const NamespaceList &nsl = *nsai;
@@ -1167,6 +1239,57 @@ void CppParser::truncateNamespaces(NamespaceList *namespaces, int length)
   Functions for processing include files.
 */
 
+/*
+  State shared between the threads of a parallel run of loadCPP().
+
+  All CppFiles caches are guarded by one mutex. Files which are parsed stand-alone
+  (i.e., whose results are cached) are claimed by the parsing thread, so other threads
+  wait for the results instead of parsing the same file again.
+
+  The outcome of a serial run depends on the order in which files are visited as soon
+  as a file is both parsed stand-alone and blacklisted, or an include cycle shows up.
+  In these cases the parallel run is flagged as order dependent, the caches are rolled
+  back to their state before the run, and the caller repeats the run serially.
+*/
+struct ParallelRun {
+    QMutex mutex;
+    QWaitCondition fileReleased;
+    bool active = false;
+    std::atomic<bool> orderDependent { false };
+    QHash<QString, Qt::HANDLE> owners;
+    QHash<Qt::HANDLE, QString> waiting;
+
+    // Copies of the caches taken by beginParallelRun()
+    IncludeCycleHash savedCycles;
+    TranslatorHash savedTranslators;
+    QSet<QString> savedBlacklist;
+    DependencyHash savedDependencies;
+};
+
+static ParallelRun &parallelRun()
+{
+    static ParallelRun run;
+
+    return run;
+}
+
+static QSet<IncludeCycle *> uniqueCycles(const IncludeCycleHash &cycles)
+{
+    QSet<IncludeCycle *> unique;
+    for (IncludeCycle *cycle : cycles)
+        unique.insert(cycle);
+    return unique;
+}
+
+// Must be called with the mutex locked
+static void markOrderDependent(ParallelRun &run)
+{
+    if (run.active && !run.orderDependent) {
+        run.orderDependent = true;
+        run.fileReleased.wakeAll();
+    }
+}
+
 IncludeCycleHash &CppFiles::includeCycles()
 {
     static IncludeCycleHash cycles;
@@ -1188,8 +1311,16 @@ QSet<QString> &CppFiles::blacklistedFiles()
     return blacklisted;
 }
 
+DependencyHash &CppFiles::fileDependencies()
+{
+    static DependencyHash dependencies;
+
+    return dependencies;
+}
+
 QSet<const ParseResults *> CppFiles::getResults(const QString &cleanFile)
 {
+    QMutexLocker locker(&parallelRun().mutex);
     IncludeCycle * const cycle = includeCycles().value(cleanFile);
 
     if (cycle)
@@ -1200,6 +1331,11 @@ QSet<const ParseResults *> CppFiles::getResults(const QString &cleanFile)
 
 void CppFiles::setResults(const QString &cleanFile, const ParseResults *results)
 {
+    ParallelRun &run = parallelRun();
+    QMutexLocker locker(&run.mutex);
+    if (blacklistedFiles().contains(cleanFile))
+        markOrderDependent(run);
+
     IncludeCycle *cycle = includeCycles().value(cleanFile);
 
     if (!cycle) {
@@ -1213,26 +1349,49 @@ void CppFiles::setResults(const QString &cleanFile, const ParseResults *results)
 
 const Translator *CppFiles::getTranslator(const QString &cleanFile)
 {
+    QMutexLocker locker(&parallelRun().mutex);
     return translatedFiles().value(cleanFile);
 }
 
 void CppFiles::setTranslator(const QString &cleanFile, const Translator *tor)
 {
+    QMutexLocker locker(&parallelRun().mutex);
     translatedFiles().insert(cleanFile, tor);
 }
 
 bool CppFiles::isBlacklisted(const QString &cleanFile)
 {
+    QMutexLocker locker(&parallelRun().mutex);
     return blacklistedFiles().contains(cleanFile);
 }
 
 void CppFiles::setBlacklisted(const QString &cleanFile)
 {
+    ParallelRun &run = parallelRun();
+    QMutexLocker locker(&run.mutex);
+    if (includeCycles().contains(cleanFile) || run.owners.contains(cleanFile))
+        markOrderDependent(run);
     blacklistedFiles().insert(cleanFile);
 }
 
+FileDependencies CppFiles::getDependencies(const QString &cleanFile)
+{
+    QMutexLocker locker(&parallelRun().mutex);
+    return fileDependencies().value(cleanFile);
+}
+
+void CppFiles::setDependencies(const QString &cleanFile, const FileDependencies &dependencies)
+{
+    QMutexLocker locker(&parallelRun().mutex);
+    fileDependencies().insert(cleanFile, dependencies);
+}
+
 void CppFiles::addIncludeCycle(const QSet<QString> &fileNames)
 {
+    ParallelRun &run = parallelRun();
+    QMutexLocker locker(&run.mutex);
+    markOrderDependent(run);
+
     IncludeCycle * const cycle = new IncludeCycle;
     cycle->fileNames = fileNames;
 
@@ -1253,6 +1412,127 @@ void CppFiles::addIncludeCycle(const QSet<QString> &fileNames)
         includeCycles().insert(fileName, cycle);
 }
 
+void CppFiles::beginParallelRun()
+{
+    ParallelRun &run = parallelRun();
+    QMutexLocker locker(&run.mutex);
+    Q_ASSERT(!run.active);
+    run.active = true;
+    run.orderDependent = false;
+
+    // addIncludeCycle() deletes cycles, so keep deep copies around.
+    QHash<IncludeCycle *, IncludeCycle *> copies;
+    for (IncludeCycle *cycle : uniqueCycles(includeCycles()))
+        copies.insert(cycle, new IncludeCycle(*cycle));
+    run.savedCycles.clear();
+    for (auto it = includeCycles().cbegin(), end = includeCycles().cend(); it != end; ++it)
+        run.savedCycles.insert(it.key(), copies.value(it.value()));
+    run.savedTranslators = translatedFiles();
+    run.savedBlacklist = blacklistedFiles();
+    run.savedDependencies = fileDependencies();
+}
+
+/*
+  Ends a parallel run. Returns false if the results depend on the order in
+  which the files were processed. In that case the caches have been restored
+  to the state they had when the run began.
+*/
+bool CppFiles::endParallelRun()
+{
+    ParallelRun &run = parallelRun();
+    QMutexLocker locker(&run.mutex);
+    Q_ASSERT(run.active && run.owners.isEmpty());
+    run.active = false;
+
+    const QSet<IncludeCycle *> savedCycles = uniqueCycles(run.savedCycles);
+    const QSet<IncludeCycle *> cycles = uniqueCycles(includeCycles());
+    if (!run.orderDependent) {
+        qDeleteAll(savedCycles);
+    } else {
+        QSet<const ParseResults *> savedResults;
+        for (const IncludeCycle *cycle : savedCycles)
+            savedResults.unite(cycle->results);
+        QSet<const ParseResults *> newResults;
+        for (const IncludeCycle *cycle : cycles)
+            newResults.unite(cycle->results);
+        newResults.subtract(savedResults);
+        for (const ParseResults *results : qAsConst(newResults))
+            delete results;
+        qDeleteAll(cycles);
+        includeCycles() = run.savedCycles;
+
+        for (auto it = translatedFiles().cbegin(), end = translatedFiles().cend(); it != end; ++it) {
+            if (run.savedTranslators.value(it.key()) != it.value())
+                delete it.value();
+        }
+        translatedFiles() = run.savedTranslators;
+        blacklistedFiles() = run.savedBlacklist;
+        fileDependencies() = run.savedDependencies;
+    }
+    run.savedCycles.clear();
+    run.savedTranslators.clear();
+    run.savedBlacklist.clear();
+    run.savedDependencies.clear();
+    return !run.orderDependent;
+}
+
+bool CppFiles::isOrderDependent()
+{
+    return parallelRun().orderDependent;
+}
+
+/*
+  Claims \a cleanFile for stand-alone parsing by the calling thread. Returns false
+  if the file must not be parsed, because another thread has parsed it meanwhile
+  (use getResults()), or because the run turned out to be order dependent.
+*/
+bool CppFiles::acquireFile(const QString &cleanFile)
+{
+    ParallelRun &run = parallelRun();
+    QMutexLocker locker(&run.mutex);
+    if (!run.active)
+        return true;
+
+    const Qt::HANDLE self = QThread::currentThreadId();
+    forever {
+        if (run.orderDependent)
+            return false;
+        const auto owner = run.owners.constFind(cleanFile);
+        if (owner == run.owners.cend()) {
+            if (includeCycles().contains(cleanFile))
+                return false;
+            run.owners.insert(cleanFile, self);
+            return true;
+        }
+        // Parsing the file again from within its own parse (or waiting for a thread
+        // which waits for us) means that we are in an include cycle.
+        for (Qt::HANDLE thread = owner.value(); ; ) {
+            if (thread == self) {
+                markOrderDependent(run);
+                return false;
+            }
+            const auto wanted = run.waiting.constFind(thread);
+            if (wanted == run.waiting.cend())
+                break;
+            const auto next = run.owners.constFind(wanted.value());
+            if (next == run.owners.cend())
+                break;
+            thread = next.value();
+        }
+        run.waiting.insert(self, cleanFile);
+        run.fileReleased.wait(&run.mutex);
+        run.waiting.remove(self);
+    }
+}
+
+void CppFiles::releaseFile(const QString &cleanFile)
+{
+    ParallelRun &run = parallelRun();
+    QMutexLocker locker(&run.mutex);
+    if (run.active && run.owners.remove(cleanFile))
+        run.fileReleased.wakeAll();
+}
+
 static bool isHeader(const QString &name)
 {
     QString fileExt = QFileInfo(name).suffix();
@@ -1276,6 +1556,9 @@ void CppParser::processInclude(const QString &file, ConversionData &cd, const QS
         return;
     }
 
+    if (recordDependencies)
+        results->dependencies.files.insert(cleanFile);
+
     // If the #include is in any kind of namespace, has been blacklisted previously,
     // or is not a header file (stdc++ extensionless or *.h*), then really include
     // it. Otherwise it is safe to process it stand-alone and re-use the parsed
@@ -1286,18 +1569,29 @@ void CppParser::processInclude(const QString &file, ConversionData &cd, const QS
         && !CppFiles::isBlacklisted(cleanFile)
         && isHeader(cleanFile)) {
 
+        if (yyWarnings)
+            yyWarnings->includes.append(cleanFile);
+
         QSet<const ParseResults *> res = CppFiles::getResults(cleanFile);
         if (!res.isEmpty()) {
             results->includes.unite(res);
             return;
         }
 
+        if (!CppFiles::acquireFile(cleanFile)) {
+            // Another thread has parsed the file in the meantime.
+            results->includes.unite(CppFiles::getResults(cleanFile));
+            return;
+        }
+
         isIndirect = true;
     }
 
     QFile f(cleanFile);
     if (!f.open(QIODevice::ReadOnly)) {
         yyMsg() << qPrintable(LU::tr("Cannot open %1: %2\n").arg(cleanFile, f.errorString()));
+        if (isIndirect)
+            CppFiles::releaseFile(cleanFile);
         return;
     }
 
@@ -1316,8 +1610,17 @@ void CppParser::processInclude(const QString &file, ConversionData &cd, const QS
         parser.setInput(ts, cleanFile);
         QStringList stack = includeStack;
         stack << cleanFile;
+        WarningCollector *const includerWarnings = yyWarnings;
+        WarningCollector headerWarnings;
+        if (includerWarnings)
+            yyWarnings = &headerWarnings;
         parser.parse(cd, stack, inclusions);
         results->includes.insert(parser.recordResults(true));
+        if (includerWarnings) {
+            yyWarnings = includerWarnings;
+            storeWarnings(cleanFile, headerWarnings);
+        }
+        CppFiles::releaseFile(cleanFile);
     } else {
         CppParser parser(results);
         parser.namespaces = namespaces;
@@ -1330,6 +1633,8 @@ void CppParser::processInclude(const QString &file, ConversionData &cd, const QS
         parser.parseInternal(cd, stack, inclusions);
         // Avoid that messages obtained by direct scanning are used
         CppFiles::setBlacklisted(cleanFile);
+        if (recordDependencies)
+            results->dependencies.directIncludes.insert(cleanFile);
     }
     inclusions.remove(cleanFile);
 
@@ -2195,6 +2500,15 @@ void CppParser::processComment()
 
 const ParseResults *CppParser::recordResults(bool isHeader)
 {
+    if (recordDependencies) {
+        FileDependencies &dependencies = results->dependencies;
+        dependencies.files.insert(yyFileName);
+        for (const ParseResults *include : qAsConst(results->includes)) {
+            dependencies.files.unite(include->dependencies.files);
+            dependencies.directIncludes.unite(include->dependencies.directIncludes);
+        }
+        CppFiles::setDependencies(yyFileName, dependencies);
+    }
     if (tor) {
         if (tor->messageCount()) {
             CppFiles::setTranslator(yyFileName, tor);
@@ -2206,6 +2520,7 @@ const ParseResults *CppParser::recordResults(bool isHeader)
     if (isHeader) {
         const ParseResults *pr;
         if (!tor && results->includes.count() == 1
+            && results->dependencies.directIncludes.isEmpty()
             && results->rootNamespace.children.isEmpty()
             && results->rootNamespace.aliases.isEmpty()
             && results->rootNamespace.usings.isEmpty()) {
@@ -2224,30 +2539,372 @@ const ParseResults *CppParser::recordResults(bool isHeader)
     }
 }
 
-void loadCPP(Translator &translator, const QStringList &filenames, ConversionData &cd)
+/*
+  On-disk cache of the messages extracted from each input file, see -cache-dir.
+
+  An entry is valid as long as the parser configuration and the contents of all files
+  which went into the parse (the file itself and everything it included) are unchanged.
+  Entries also record which files were included in-place, so the blacklisting done by
+  the parse can be replayed without parsing. Namespace information is not cached; it is
+  recomputed on demand when a file which needs it has to be parsed again.
+
+  Entries are keyed by the path of their file, so a changed file overwrites its entry.
+  The entries of files which do not exist anymore, or which were written by another
+  version of the cache, are removed by prune(). Entries of other projects sharing the
+  directory stay.
+*/
+class ParseCache
 {
-    QStringConverter::Encoding e = cd.m_sourceIsUtf16 ? QStringConverter::Utf16 : QStringConverter::Utf8;
+public:
+    ParseCache(const QString &directory, const ConversionData &cd);
 
-    for (const QString &filename : filenames) {
-        if (!CppFiles::getResults(filename).isEmpty() || CppFiles::isBlacklisted(filename))
-            continue;
+    bool isEnabled() const { return !m_directory.isEmpty(); }
+    bool restore(const QString &cleanFile);
+    void save(const QString &cleanFile);
+    bool isRestored(const QString &cleanFile) const;
+    void forgetRestored();
+    void prune();
+
+private:
+    QByteArray contentHash(const QString &cleanFile);
+    QString entryPath(const QString &cleanFile) const;
+
+    QString m_directory;
+    QByteArray m_configHash;
+    mutable QMutex m_mutex;
+    QHash<QString, QByteArray> m_contentHashes;
+    QSet<QString> m_restored;
+};
+
+static const quint32 parseCacheMagic = 0x4c55504b; // "LUPK"
+static const quint32 parseCacheVersion = 1;
+
+static std::atomic<int> parseCacheHits;
+static std::atomic<int> parseCacheMisses;
+
+static void writeMessage(QDataStream &stream, const TranslatorMessage &msg)
+{
+    stream << msg.id() << msg.context() << msg.sourceText() << msg.oldSourceText()
+           << msg.comment() << msg.oldComment() << msg.userData() << msg.extras()
+           << msg.extraComment() << msg.translatorComment() << msg.translations()
+           << msg.fileName() << qint32(msg.lineNumber()) << qint32(msg.type()) << msg.isPlural();
+    const TranslatorMessage::References refs = msg.extraReferences();
+    stream << quint32(refs.size());
+    for (const TranslatorMessage::Reference &ref : refs)
+        stream << ref.fileName() << qint32(ref.lineNumber());
+}
+
+static TranslatorMessage readMessage(QDataStream &stream)
+{
+    QString id, context, sourceText, oldSourceText, comment, oldComment, userData;
+    QString extraComment, translatorComment, fileName;
+    TranslatorMessage::ExtraData extras;
+    QStringList translations;
+    qint32 lineNumber, type;
+    bool plural;
+    stream >> id >> context >> sourceText >> oldSourceText >> comment >> oldComment >> userData
+           >> extras >> extraComment >> translatorComment >> translations >> fileName
+           >> lineNumber >> type >> plural;
+
+    TranslatorMessage msg(context, sourceText, comment, userData, fileName, lineNumber,
+                          translations, TranslatorMessage::Type(type), plural);
+    msg.setId(id);
+    msg.setOldSourceText(oldSourceText);
+    msg.setOldComment(oldComment);
+    msg.setExtras(extras);
+    msg.setExtraComment(extraComment);
+    msg.setTranslatorComment(translatorComment);
+    quint32 refCount;
+    stream >> refCount;
+    for (quint32 i = 0; i < refCount && stream.status() == QDataStream::Ok; ++i) {
+        QString refFileName;
+        qint32 refLineNumber;
+        stream >> refFileName >> refLineNumber;
+        msg.addReference(refFileName, refLineNumber);
+    }
+    return msg;
+}
+
+ParseCache::ParseCache(const QString &directory, const ConversionData &cd)
+{
+    if (directory.isEmpty() || !QDir().mkpath(directory))
+        return;
+    m_directory = directory;
+
+    // Everything besides the file contents that influences the parse.
+    QByteArray config;
+    QDataStream stream(&config, QIODevice::WriteOnly);
+    QStringList projectRoots(cd.m_projectRoots.cbegin(), cd.m_projectRoots.cend());
+    projectRoots.sort();
+    QStringList allCSources;
+    for (auto it = cd.m_allCSources.cbegin(), end = cd.m_allCSources.cend(); it != end; ++it)
+        allCSources << it.key() + QLatin1Char('\0') + it.value();
+    allCSources.sort();
+    stream << QString::fromLatin1(QT_VERSION_STR) << cd.m_includePath << cd.m_excludes << projectRoots
+           << allCSources << cd.m_sourceIsUtf16
+           << trFunctionAliasManager.availableFunctionsWithAliases();
+    m_configHash = QCryptographicHash::hash(config, QCryptographicHash::Sha1);
+}
+
+QString ParseCache::entryPath(const QString &cleanFile) const
+{
+    const QByteArray key = QCryptographicHash::hash(cleanFile.toUtf8(), QCryptographicHash::Sha1);
+    return m_directory + QLatin1Char('/') + QString::fromLatin1(key.toHex()) + QLatin1String(".lupdatecache");
+}
+
+QByteArray ParseCache::contentHash(const QString &cleanFile)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        const auto it = m_contentHashes.constFind(cleanFile);
+        if (it != m_contentHashes.cend())
+            return *it;
+    }
+
+    QByteArray hash;
+    QFile file(cleanFile);
+    if (file.open(QIODevice::ReadOnly)) {
+        QCryptographicHash hasher(QCryptographicHash::Sha1);
+        if (hasher.addData(&file))
+            hash = hasher.result();
+    }
+    QMutexLocker locker(&m_mutex);
+    m_contentHashes.insert(cleanFile, hash);
+    return hash;
+}
+
+bool ParseCache::restore(const QString &cleanFile)
+{
+    QFile file(entryPath(cleanFile));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic, version;
+    QByteArray configHash;
+    QString fileName;
+    stream >> magic >> version >> configHash >> fileName;
+    if (magic != parseCacheMagic || version != parseCacheVersion
+        || configHash != m_configHash || fileName != cleanFile) {
+        return false;
+    }
 
-        QFile file(filename);
-        if (!file.open(QIODevice::ReadOnly)) {
-            cd.appendError(LU::tr("Cannot open %1: %2").arg(filename, file.errorString()));
+    quint32 dependencyCount;
+    stream >> dependencyCount;
+    for (quint32 i = 0; i < dependencyCount; ++i) {
+        QString dependency;
+        QByteArray hash;
+        stream >> dependency >> hash;
+        if (stream.status() != QDataStream::Ok || hash.isEmpty()
+            || hash != contentHash(dependency)) {
+            return false;
+        }
+    }
+
+    QStringList directIncludes;
+    quint32 messageCount;
+    stream >> directIncludes >> messageCount;
+    Translator *tor = new Translator;
+    for (quint32 i = 0; i < messageCount && stream.status() == QDataStream::Ok; ++i)
+        tor->append(readMessage(stream));
+    if (stream.status() != QDataStream::Ok) {
+        delete tor;
+        return false;
+    }
+
+    for (const QString &directInclude : qAsConst(directIncludes))
+        CppFiles::setBlacklisted(directInclude);
+    if (tor->messageCount())
+        CppFiles::setTranslator(cleanFile, tor);
+    else
+        delete tor;
+
+    QMutexLocker locker(&m_mutex);
+    m_restored.insert(cleanFile);
+    return true;
+}
+
+void ParseCache::save(const QString &cleanFile)
+{
+    const FileDependencies dependencies = CppFiles::getDependencies(cleanFile);
+    if (dependencies.files.isEmpty())
+        return; // not parsed stand-alone
+
+    QSaveFile file(entryPath(cleanFile));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    stream << parseCacheMagic << parseCacheVersion << m_configHash << cleanFile;
+    stream << quint32(dependencies.files.size());
+    for (const QString &dependency : dependencies.files)
+        stream << dependency << contentHash(dependency);
+    stream << QStringList(dependencies.directIncludes.cbegin(), dependencies.directIncludes.cend());
+
+    const Translator *tor = CppFiles::getTranslator(cleanFile);
+    stream << quint32(tor ? tor->messageCount() : 0);
+    if (tor) {
+        for (const TranslatorMessage &msg : tor->messages())
+            writeMessage(stream, msg);
+    }
+    file.commit();
+}
+
+bool ParseCache::isRestored(const QString &cleanFile) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_restored.contains(cleanFile);
+}
+
+void ParseCache::forgetRestored()
+{
+    QMutexLocker locker(&m_mutex);
+    m_restored.clear();
+}
+
+void ParseCache::prune()
+{
+    const QDir directory(m_directory);
+    const QStringList entries =
+            directory.entryList({ QLatin1String("*.lupdatecache") }, QDir::Files);
+    for (const QString &entry : entries) {
+        QFile file(directory.filePath(entry));
+        if (!file.open(QIODevice::ReadOnly))
             continue;
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_6_0);
+
+        quint32 magic, version;
+        QByteArray configHash;
+        QString fileName;
+        stream >> magic >> version >> configHash >> fileName;
+        file.close();
+        if (stream.status() != QDataStream::Ok || magic != parseCacheMagic
+            || version != parseCacheVersion || !QFile::exists(fileName)) {
+            file.remove();
         }
+    }
+}
 
-        CppParser parser;
-        QTextStream ts(&file);
-        ts.setEncoding(e);
-        ts.setAutoDetectUnicode(true);
-        parser.setInput(ts, filename);
-        Translator *tor = new Translator;
-        parser.setTranslator(tor);
-        QSet<QString> inclusions;
-        parser.parse(cd, QStringList(), inclusions);
-        parser.recordResults(isHeader(filename));
+ParseCacheStatistics cppParseCacheStatistics()
+{
+    return { parseCacheHits, parseCacheMisses };
+}
+
+static void parseCppFile(const QString &filename, QStringConverter::Encoding e,
+                         ConversionData &cd, ParseCache &cache, QString *error)
+{
+    if (!CppFiles::getResults(filename).isEmpty() || CppFiles::isBlacklisted(filename))
+        return;
+
+    if (cache.isEnabled() && cache.restore(filename))
+        return;
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = LU::tr("Cannot open %1: %2").arg(filename, file.errorString());
+        return;
+    }
+
+    const bool header = isHeader(filename);
+    if (header && !CppFiles::acquireFile(filename))
+        return;
+
+    CppParser parser;
+    QTextStream ts(&file);
+    ts.setEncoding(e);
+    ts.setAutoDetectUnicode(true);
+    parser.setInput(ts, filename);
+    Translator *tor = new Translator;
+    parser.setTranslator(tor);
+    QSet<QString> inclusions;
+    parser.parse(cd, QStringList(), inclusions);
+    parser.recordResults(header);
+    if (header)
+        CppFiles::releaseFile(filename);
+}
+
+static bool parseCppFilesParallel(const QStringList &filenames, QStringConverter::Encoding e,
+                                  ConversionData &cd, ParseCache &cache, int threadCount)
+{
+    // Make sure the lazily built lookup table is not populated concurrently.
+    trFunctionAliasManager.trFunctionByName(QString());
+
+    std::vector<int> indices(filenames.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    ReadSynchronizedRef<int> pending(indices);
+    std::vector<QString> errors(filenames.size());
+
+    CppFiles::beginParallelRun();
+    std::vector<std::thread> producers;
+    for (int i = 0; i < threadCount; ++i) {
+        std::thread producer([&]() {
+            int index;
+            while (!CppFiles::isOrderDependent() && pending.next(&index)) {
+                WarningCollector warnings;
+                yyWarnings = &warnings;
+                parseCppFile(filenames.at(index), e, cd, cache, &errors[index]);
+                yyWarnings = nullptr;
+                storeWarnings(filenames.at(index), warnings);
+            }
+        });
+        producers.emplace_back(std::move(producer));
+    }
+    for (auto &producer : producers)
+        producer.join();
+    if (!CppFiles::endParallelRun()) {
+        collectedWarnings.clear();
+        cache.forgetRestored();
+        return false;
+    }
+
+    // Report warnings and errors in the order a serial run would. The warnings
+    // can only be printed now; until the run has ended, it may still turn out
+    // to be order dependent and be repeated.
+    QSet<QString> printed;
+    for (const QString &filename : filenames)
+        printCollectedWarnings(filename, &printed);
+    collectedWarnings.clear();
+    for (const QString &error : errors) {
+        if (!error.isEmpty())
+            cd.appendError(error);
+    }
+    return true;
+}
+
+void loadCPP(Translator &translator, const QStringList &filenames, ConversionData &cd)
+{
+    QStringConverter::Encoding e = cd.m_sourceIsUtf16 ? QStringConverter::Utf16 : QStringConverter::Utf8;
+
+    ParseCache cache(cd.m_cacheDir, cd);
+    recordDependencies = cache.isEnabled();
+
+    int threadCount = cd.m_parserThreads > 0 ? cd.m_parserThreads
+                                             : int(std::thread::hardware_concurrency());
+    threadCount = std::min(threadCount, int(filenames.size()));
+    // If the outcome of the parallel run would depend on the order in which files
+    // are parsed, fall back to a serial run to get the same results as without -j.
+    if (threadCount <= 1 || !parseCppFilesParallel(filenames, e, cd, cache, threadCount)) {
+        for (const QString &filename : filenames) {
+            QString error;
+            parseCppFile(filename, e, cd, cache, &error);
+            if (!error.isEmpty())
+                cd.appendError(error);
+        }
+    }
+
+    if (cache.isEnabled()) {
+        for (const QString &filename : filenames) {
+            if (cache.isRestored(filename)) {
+                ++parseCacheHits;
+            } else if (!CppFiles::getDependencies(filename).files.isEmpty()) {
+                ++parseCacheMisses;
+                cache.save(filename);
+            }
+        }
+        cache.prune();
     }
 
     for (const QString &filename : filenames) {
@@ -93,10 +93,17 @@ struct Namespace {
     bool complained; // ... that tr functions are missing.
 };
 
+// Only recorded when a parse cache is used, see loadCPP()
+struct FileDependencies {
+    QSet<QString> files; // all files which went into the results
+    QSet<QString> directIncludes; // files included in-place, and thus blacklisted
+};
+
 struct ParseResults {
     int fileId;
     Namespace rootNamespace;
     QSet<const ParseResults *> includes;
+    FileDependencies dependencies;
 };
 
 struct IncludeCycle {
@@ -106,6 +113,7 @@ struct IncludeCycle {
 
 typedef QHash<QString, IncludeCycle *> IncludeCycleHash;
 typedef QHash<QString, const Translator *> TranslatorHash;
+typedef QHash<QString, FileDependencies> DependencyHash;
 
 class CppFiles {
 
@@ -117,11 +125,21 @@ public:
     static bool isBlacklisted(const QString &cleanFile);
     static void setBlacklisted(const QString &cleanFile);
     static void addIncludeCycle(const QSet<QString> &fileNames);
+    static FileDependencies getDependencies(const QString &cleanFile);
+    static void setDependencies(const QString &cleanFile, const FileDependencies &dependencies);
+
+    // Support for parsing several files concurrently, see loadCPP().
+    static void beginParallelRun();
+    static bool endParallelRun();
+    static bool isOrderDependent();
+    static bool acquireFile(const QString &cleanFile);
+    static void releaseFile(const QString &cleanFile);
 
 private:
     static IncludeCycleHash &includeCycles();
     static TranslatorHash &translatedFiles();
     static QSet<QString> &blacklistedFiles();
+    static DependencyHash &fileDependencies();
 };
 
 QT_END_NAMESPACE
@@ -67,7 +67,13 @@ Translator merge(
     const Translator &tor, const Translator &virginTor, const QList<Translator> &aliens,
     UpdateOptions options, QString &err);
 
+struct ParseCacheStatistics {
+    int hits;
+    int misses;
+};
+
 void loadCPP(Translator &translator, const QStringList &filenames, ConversionData &cd);
+ParseCacheStatistics cppParseCacheStatistics();
 bool loadJava(Translator &translator, const QString &filename, ConversionData &cd);
 bool loadUI(Translator &translator, const QString &filename, ConversionData &cd);
 
@@ -47,6 +47,7 @@ qtHaveModule(qmldevtools-private): SOURCES += qdeclarative.cpp
 HEADERS += \
     lupdate.h \
     cpp.h \
+    synchronized.h \
     ../shared/projectdescriptionreader.h \
     ../shared/qrcreader.h \
     ../shared/runqttool.h \
@@ -60,8 +61,7 @@ qtConfig(clangcpp) {
     HEADERS += \
         cpp_clang.h \
         clangtoolastreader.h \
-        lupdatepreprocessoraction.h \
-        synchronized.h
+        lupdatepreprocessoraction.h
 }
 
 mingw {
@@ -52,6 +52,8 @@
 bool useClangToParseCpp = false;
 QString commandLineCompileCommands; // for the path to the json file passed as a command line argument.
                                     // Has priority over what is in the .pro file and passed to the project.
+int cppParserThreads = 1; // number of threads used by the built-in C++ parser
+QString cppParseCacheDir;
 
 // Can't have an array of QStaticStringData<N> for different N, so
 // use QString, which requires constructor calls. Doesn't matter
@@ -280,6 +282,13 @@ static void printUsage()
         "           Specify the output file(s). This will override the TRANSLATIONS.\n"
         "    -version\n"
         "           Display the version of lupdate and exit.\n"
+        "    -j <n>\n"
+        "           Parse C++ sources with <n> threads. 0 means one thread per core.\n"
+        "           The output is identical to a run with one thread (default: 1).\n"
+        "    -cache-dir <directory>\n"
+        "           Keep the messages extracted from C++ sources in <directory>, and\n"
+        "           reuse them for files which did not change, including the files\n"
+        "           they include. Does not apply to -clang-parser.\n"
         "    -clang-parser \n"
         "           Use clang to parse cpp files. Otherwise a custom parser is used.\n"
         "           Need a compile_commands.json for the files that needs to be parsed.\n"
@@ -598,6 +607,8 @@ private:
         cd.m_includePath = prj.includePaths;
         cd.m_excludes = prj.excluded;
         cd.m_sourceIsUtf16 = options & SourceIsUtf16;
+        cd.m_parserThreads = cppParserThreads;
+        cd.m_cacheDir = cppParseCacheDir;
         if (commandLineCompileCommands.isEmpty())
             cd.m_compileCommandsPath = prj.compileCommands;
         else
@@ -809,6 +820,27 @@ int main(int argc, char **argv)
             metTsFlag = false;
             metXTsFlag = true;
             continue;
+        } else if (arg == QLatin1String("-j")) {
+            ++i;
+            if (i == argc) {
+                printErr(LU::tr("The option -j requires a parameter.\n"));
+                return 1;
+            }
+            bool ok = false;
+            cppParserThreads = args[i].toInt(&ok);
+            if (!ok || cppParserThreads < 0) {
+                printErr(LU::tr("Invalid parameter passed to -j.\n"));
+                return 1;
+            }
+            continue;
+        } else if (arg == QLatin1String("-cache-dir")) {
+            ++i;
+            if (i == argc) {
+                printErr(LU::tr("The option -cache-dir requires a parameter.\n"));
+                return 1;
+            }
+            cppParseCacheDir = QDir::cleanPath(QFileInfo(args[i]).absoluteFilePath());
+            continue;
         } else if (arg == QLatin1String("-extensions")) {
             ++i;
             if (i == argc) {
@@ -1031,6 +1063,8 @@ int main(int argc, char **argv)
         cd.m_includePath = includePath;
         cd.m_allCSources = allCSources;
         cd.m_compileCommandsPath = commandLineCompileCommands;
+        cd.m_parserThreads = cppParserThreads;
+        cd.m_cacheDir = cppParseCacheDir;
         for (const QString &resource : qAsConst(resourceFiles))
             sourceFiles << getResources(resource);
         processSources(fetchedTor, sourceFiles, cd);
@@ -1057,5 +1091,10 @@ int main(int argc, char **argv)
                                              &fail);
         }
     }
+    if (!cppParseCacheDir.isEmpty() && !useClangToParseCpp && (options & Verbose)) {
+        const ParseCacheStatistics stats = cppParseCacheStatistics();
+        printOut(LU::tr("C++ parse cache: %n file(s) reused", 0, stats.hits)
+                 + LU::tr(", %n file(s) parsed.\n", 0, stats.misses));
+    }
     return fail ? 1 : 0;
 }
@@ -96,10 +96,10 @@ public:
 
     bool next(T *value) const
     {
-        m_next.fetch_add(1, std::memory_order_acquire);
-        const bool hasNext = m_next < m_vector.size();
+        const int next = m_next.fetch_add(1, std::memory_order_acquire) + 1;
+        const bool hasNext = next < int(m_vector.size());
         if (hasNext)
-            *value = m_vector[m_next];
+            *value = m_vector[next];
         return hasNext;
     }
 
@@ -29,14 +29,17 @@
 #include "translator.h"
 
 #include <QtCore/QDebug>
+#include <QtCore/QFile>
 #include <QtCore/QIODevice>
 #include <QtCore/QHash>
 #include <QtCore/QRegularExpression>
 #include <QtCore/QString>
 #include <QtCore/QStringConverter>
 #include <QtCore/QTextStream>
+#include <QtCore/QVarLengthArray>
 
 #include <ctype.h>
+#include <string.h>
 
 // Uncomment if you wish to hard wrap long lines in .po files. Note that this
 // affects only msg strings, not comments.
@@ -46,19 +49,20 @@ QT_BEGIN_NAMESPACE
 
 static const int MAX_LEN = 79;
 
-static QString poEscapedString(const QString &prefix, const QString &keyword,
-                               bool noWrap, const QString &ba)
+static void poEscapedString(QTextStream &out, const QString &prefix, const QString &keyword,
+                            bool noWrap, const QString &ba)
 {
-    QStringList lines;
-    int off = 0;
+    // Escape the string in one go, remembering where the lines end.
     QString res;
+    res.reserve(ba.length() + 16);
+    QVarLengthArray<int, 16> lineEnds;
+    int off = 0;
     while (off < ba.length()) {
         ushort c = ba[off++].unicode();
         switch (c) {
         case '\n':
             res += QLatin1String("\\n");
-            lines.append(res);
-            res.clear();
+            lineEnds.append(res.length());
             break;
         case '\r':
             res += QLatin1String("\\r");
@@ -96,17 +100,29 @@ static QString poEscapedString(const QString &prefix, const QString &keyword,
             break;
         }
     }
-    if (!res.isEmpty())
-        lines.append(res);
-    if (!lines.isEmpty()) {
+    if (res.length() > (lineEnds.isEmpty() ? 0 : lineEnds.last()))
+        lineEnds.append(res.length());
+
+    out << prefix << keyword << " \"";
+    bool firstLine = true;
+    auto writeLine = [&](QStringView line) {
+        if (!firstLine)
+            out << "\"\n" << prefix << '"';
+        firstLine = false;
+        out << line;
+    };
+    const QStringView escaped(res);
+    if (!lineEnds.isEmpty()) {
         if (!noWrap) {
-            if (lines.count() != 1 ||
-                lines.first().length() > MAX_LEN - keyword.length() - prefix.length() - 3)
+            if (lineEnds.count() != 1 ||
+                lineEnds.first() > MAX_LEN - keyword.length() - prefix.length() - 3)
             {
-                const QStringList olines = lines;
-                lines = QStringList(QString());
+                writeLine(QStringView());
                 const int maxlen = MAX_LEN - prefix.length() - 2;
-                for (const QString &line : olines) {
+                int start = 0;
+                for (int end : lineEnds) {
+                    const QStringView line = escaped.mid(start, end - start);
+                    start = end;
                     int off = 0;
                     while (off + maxlen < line.length()) {
                         int idx = line.lastIndexOf(QLatin1Char(' '), off + maxlen - 1) + 1;
@@ -120,46 +136,54 @@ static QString poEscapedString(const QString &prefix, const QString &keyword,
                                 break;
 #endif
                         }
-                        lines.append(line.mid(off, idx - off));
+                        writeLine(line.mid(off, idx - off));
                         off = idx;
                     }
-                    lines.append(line.mid(off));
+                    writeLine(line.mid(off));
                 }
+                out << "\"\n";
+                return;
             }
-        } else if (lines.count() > 1) {
-            lines.prepend(QString());
+        } else if (lineEnds.count() > 1) {
+            writeLine(QStringView());
         }
     }
-    return prefix + keyword + QLatin1String(" \"") +
-           lines.join(QLatin1String("\"\n") + prefix + QLatin1Char('"')) +
-           QLatin1String("\"\n");
+    int start = 0;
+    for (int end : lineEnds) {
+        writeLine(escaped.mid(start, end - start));
+        start = end;
+    }
+    out << "\"\n";
 }
 
-static QString poEscapedLines(const QString &prefix, bool addSpace, const QStringList &lines)
+static void poEscapedLine(QTextStream &out, const QString &prefix, bool addSpace,
+                          QStringView line)
 {
-    QString out;
-    for (const QString &line : lines) {
-        out += prefix;
-        if (addSpace && !line.isEmpty())
-            out += QLatin1Char(' ' );
-        out += line;
-        out += QLatin1Char('\n');
-    }
-    return out;
+    out << prefix;
+    if (addSpace && !line.isEmpty())
+        out << ' ';
+    out << line << '\n';
 }
 
-static QString poEscapedLines(const QString &prefix, bool addSpace, const QString &in0)
+static void poEscapedLines(QTextStream &out, const QString &prefix, bool addSpace,
+                           const QString &in)
 {
-    QString in = in0;
-    if (in == QString::fromLatin1("\n"))
-        in.chop(1);
-    return poEscapedLines(prefix, addSpace, in.split(QLatin1Char('\n')));
+    if (in == QLatin1String("\n")) {
+        poEscapedLine(out, prefix, addSpace, QStringView());
+        return;
+    }
+    const QStringView view(in);
+    int start = 0;
+    for (int end; (end = in.indexOf(QLatin1Char('\n'), start)) >= 0; start = end + 1)
+        poEscapedLine(out, prefix, addSpace, view.mid(start, end - start));
+    poEscapedLine(out, prefix, addSpace, view.mid(start));
 }
 
-static QString poWrappedEscapedLines(const QString &prefix, bool addSpace, const QString &line)
+static void poWrappedEscapedLines(QTextStream &out, const QString &prefix, bool addSpace,
+                                  const QString &in)
 {
     const int maxlen = MAX_LEN - prefix.length() - addSpace;
-    QStringList lines;
+    const QStringView line(in);
     int off = 0;
     while (off + maxlen < line.length()) {
         int idx = line.lastIndexOf(QLatin1Char(' '), off + maxlen - 1);
@@ -172,11 +196,10 @@ static QString poWrappedEscapedLines(const QString &prefix, bool addSpace, const
                 break;
 #endif
         }
-        lines.append(line.mid(off, idx - off));
+        poEscapedLine(out, prefix, addSpace, line.mid(off, idx - off));
         off = idx + 1;
     }
-    lines.append(line.mid(off));
-    return poEscapedLines(prefix, addSpace, lines);
+    poEscapedLine(out, prefix, addSpace, line.mid(off));
 }
 
 struct PoItem
@@ -206,19 +229,105 @@ public:
 };
 
 
+/*
+  Hands out the lines of a PO file one by one, with surrounding white space
+  removed, as views into the file data. Like the files loadPO() used to read
+  line by line into a list, the file always ends with an empty line.
+  A line can be given back, so it is handed out once more by next().
+*/
+class PoLineReader
+{
+public:
+    PoLineReader(const char *data, qsizetype size)
+        : m_data(data), m_size(size), m_pos(0), m_lineStart(0),
+          m_lineNo(-1), m_prevLineNo(-1), m_atEnd(false)
+    {}
+
+    bool next()
+    {
+        if (m_atEnd)
+            return false;
+        m_prevLine = m_line;
+        m_prevLineNo = m_lineNo;
+        m_lineStart = m_pos;
+        ++m_lineNo;
+        if (m_pos > m_size) {
+            // Past the trailing empty line
+            m_atEnd = true;
+            return false;
+        }
+        if (m_pos == m_size) {
+            m_line = QByteArray();
+            ++m_pos;
+            return true;
+        }
+        const char *start = m_data + m_pos;
+        const char *nl = static_cast<const char *>(memchr(start, '\n', m_size - m_pos));
+        const char *end = nl ? nl : m_data + m_size;
+        m_pos = nl ? nl + 1 - m_data : m_size;
+        m_line = trimmed(start, end);
+        return true;
+    }
+
+    // Makes the previous line the current one again
+    void unread()
+    {
+        m_pos = m_lineStart;
+        m_line = m_prevLine;
+        m_lineNo = m_prevLineNo;
+        m_atEnd = false;
+    }
+
+    const QByteArray &line() const { return m_line; }
+    int lineNumber() const { return m_lineNo; }
+
+    // The first count lines of the file, joined by newlines
+    QByteArray joinedLines(int count) const
+    {
+        PoLineReader reader(m_data, m_size);
+        QByteArray res;
+        for (int i = 0; i < count && reader.next(); ++i) {
+            if (i)
+                res += '\n';
+            res += reader.line();
+        }
+        return res;
+    }
+
+private:
+    static QByteArray trimmed(const char *start, const char *end)
+    {
+        while (start < end && isspace(uchar(*start)))
+            ++start;
+        while (end > start && isspace(uchar(end[-1])))
+            --end;
+        return QByteArray::fromRawData(start, end - start);
+    }
+
+    const char *m_data;
+    qsizetype m_size;
+    qsizetype m_pos;
+    qsizetype m_lineStart;
+    int m_lineNo;
+    int m_prevLineNo;
+    bool m_atEnd;
+    QByteArray m_line;
+    QByteArray m_prevLine;
+};
+
 static bool isTranslationLine(const QByteArray &line)
 {
     return line.startsWith("#~ msgstr") || line.startsWith("msgstr");
 }
 
-static QByteArray slurpEscapedString(const QList<QByteArray> &lines, int &l,
+static QByteArray slurpEscapedString(PoLineReader &lines,
         int offset, const QByteArray &prefix, ConversionData &cd)
 {
     QByteArray msg;
     int stoff;
 
-    for (; l < lines.size(); ++l) {
-        const QByteArray &line = lines.at(l);
+    do {
+        const QByteArray &line = lines.line();
         if (line.isEmpty() || !line.startsWith(prefix))
             break;
         while (isspace(line[offset])) // No length check, as string has no trailing spaces.
@@ -238,7 +347,7 @@ static QByteArray slurpEscapedString(const QList<QByteArray> &lines, int &l,
                 if (line[offset++] != '"') {
                     cd.appendError(QString::fromLatin1(
                             "PO parsing error: extra characters on line %1.")
-                            .arg(l + 1));
+                            .arg(lines.lineNumber() + 1));
                     break;
                 }
                 continue;
@@ -299,7 +408,7 @@ static QByteArray slurpEscapedString(const QList<QByteArray> &lines, int &l,
                 default:
                     cd.appendError(QString::fromLatin1(
                             "PO parsing error: invalid escape '\\%1' (line %2).")
-                            .arg(QChar((uint)c)).arg(l + 1));
+                            .arg(QChar((uint)c)).arg(lines.lineNumber() + 1));
                     msg += '\\';
                     msg += c;
                     break;
@@ -309,30 +418,30 @@ static QByteArray slurpEscapedString(const QList<QByteArray> &lines, int &l,
             }
         }
         offset = prefix.size();
-    }
-    --l;
+    } while (lines.next());
+    lines.unread();
     return msg;
 
 premature_eol:
     cd.appendError(QString::fromLatin1(
-            "PO parsing error: premature end of line %1.").arg(l + 1));
+            "PO parsing error: premature end of line %1.").arg(lines.lineNumber() + 1));
     return QByteArray();
 }
 
-static void slurpComment(QByteArray &msg, const QList<QByteArray> &lines, int & l)
+static void slurpComment(QByteArray &msg, PoLineReader &lines)
 {
-    int firstLine = l;
-    QByteArray prefix = lines.at(l);
+    int firstLine = lines.lineNumber();
+    QByteArray prefix = lines.line();
     for (int i = 1; ; i++) {
         if (prefix.at(i) != ' ') {
             prefix.truncate(i);
             break;
         }
     }
-    for (; l < lines.size(); ++l) {
-        const QByteArray &line = lines.at(l);
+    do {
+        const QByteArray &line = lines.line();
         if (line.startsWith(prefix)) {
-            if (l > firstLine)
+            if (lines.lineNumber() > firstLine)
                 msg += '\n';
             msg += line.mid(prefix.size());
         } else if (line == "#") {
@@ -340,8 +449,8 @@ static void slurpComment(QByteArray &msg, const QList<QByteArray> &lines, int &
         } else {
             break;
         }
-    }
-    --l;
+    } while (lines.next());
+    lines.unread();
 }
 
 static void splitContext(QByteArray *comment, QByteArray *context)
@@ -395,7 +504,7 @@ static QByteArray QByteArrayList_join(const QList<QByteArray> &that, char sep)
     return res;
 }
 
-bool loadPO(Translator &translator, QIODevice &dev, ConversionData &cd)
+static bool loadPO(Translator &translator, const QByteArray &data, ConversionData &cd)
 {
     QStringDecoder toUnicode(QStringConverter::Utf8, QStringDecoder::Flag::Stateless);
     bool error = false;
@@ -419,16 +528,13 @@ bool loadPO(Translator &translator, QIODevice &dev, ConversionData &cd)
     // ...
 
     // we need line based lookahead below.
-    QList<QByteArray> lines;
-    while (!dev.atEnd())
-        lines.append(dev.readLine().trimmed());
-    lines.append(QByteArray());
+    PoLineReader lines(data.constData(), data.size());
 
-    int l = 0, lastCmtLine = -1;
+    int lastCmtLine = -1;
     bool qtContexts = false;
     PoItem item;
-    for (; l != lines.size(); ++l) {
-        QByteArray line = lines.at(l);
+    while (lines.next()) {
+        QByteArray line = lines.line();
         if (line.isEmpty())
            continue;
         if (isTranslationLine(line)) {
@@ -436,12 +542,15 @@ bool loadPO(Translator &translator, QIODevice &dev, ConversionData &cd)
             const QByteArray prefix = isObsolete ? "#~ " : "";
             while (true) {
                 int idx = line.indexOf(' ', prefix.length());
-                QByteArray str = slurpEscapedString(lines, l, idx, prefix, cd);
+                QByteArray str = slurpEscapedString(lines, idx, prefix, cd);
                 item.msgStr.append(str);
-                if (l + 1 >= lines.size() || !isTranslationLine(lines.at(l + 1)))
+                if (!lines.next())
+                    break;
+                if (!isTranslationLine(lines.line())) {
+                    lines.unread();
                     break;
-                ++l;
-                line = lines.at(l);
+                }
+                line = lines.line();
             }
             if (item.msgId.isEmpty()) {
                 QHash<QString, QByteArray> extras;
@@ -532,7 +641,7 @@ bool loadPO(Translator &translator, QIODevice &dev, ConversionData &cd)
               doneho:
                 if (lastCmtLine != -1) {
                     extras[QLatin1String("po-header_comment")] =
-                            QByteArrayList_join(lines.mid(0, lastCmtLine + 1), '\n');
+                            lines.joinedLines(lastCmtLine + 1);
                 }
                 for (auto it = extras.cbegin(), end = extras.cend(); it != end; ++it)
                     translator.setExtra(it.key(), toUnicode(it.value()));
@@ -620,7 +729,7 @@ bool loadPO(Translator &translator, QIODevice &dev, ConversionData &cd)
                     item.translatorComments += '\n';
                     break;
                 case ' ':
-                    slurpComment(item.translatorComments, lines, l);
+                    slurpComment(item.translatorComments, lines);
                     break;
                 case '.':
                     if (line.startsWith("#. ts-context ")) { // legacy
@@ -634,79 +743,97 @@ bool loadPO(Translator &translator, QIODevice &dev, ConversionData &cd)
                     break;
                 case '|':
                     if (line.startsWith("#| msgid ")) {
-                        item.oldMsgId = slurpEscapedString(lines, l, 9, "#| ", cd);
+                        item.oldMsgId = slurpEscapedString(lines, 9, "#| ", cd);
                     } else if (line.startsWith("#| msgid_plural ")) {
-                        QByteArray extra = slurpEscapedString(lines, l, 16, "#| ", cd);
+                        QByteArray extra = slurpEscapedString(lines, 16, "#| ", cd);
                         if (extra != item.oldMsgId)
                             item.extra[QLatin1String("po-old_msgid_plural")] =
                                     toUnicode(extra);
                     } else if (line.startsWith("#| msgctxt ")) {
-                        item.oldTscomment = slurpEscapedString(lines, l, 11, "#| ", cd);
+                        item.oldTscomment = slurpEscapedString(lines, 11, "#| ", cd);
                         if (qtContexts)
                             splitContext(&item.oldTscomment, &item.context);
                     } else {
                         cd.appendError(QString(QLatin1String("PO-format parse error in line %1: '%2'"))
-                            .arg(l + 1).arg(toUnicode(lines[l])));
+                            .arg(lines.lineNumber() + 1).arg(toUnicode(lines.line())));
                         error = true;
                     }
                     break;
                 case '~':
                     if (line.startsWith("#~ msgid ")) {
-                        item.msgId = slurpEscapedString(lines, l, 9, "#~ ", cd);
+                        item.msgId = slurpEscapedString(lines, 9, "#~ ", cd);
                     } else if (line.startsWith("#~ msgid_plural ")) {
-                        QByteArray extra = slurpEscapedString(lines, l, 16, "#~ ", cd);
+                        QByteArray extra = slurpEscapedString(lines, 16, "#~ ", cd);
                         if (extra != item.msgId)
                             item.extra[QLatin1String("po-msgid_plural")] =
                                     toUnicode(extra);
                         item.isPlural = true;
                     } else if (line.startsWith("#~ msgctxt ")) {
-                        item.tscomment = slurpEscapedString(lines, l, 11, "#~ ", cd);
+                        item.tscomment = slurpEscapedString(lines, 11, "#~ ", cd);
                         if (qtContexts)
                             splitContext(&item.tscomment, &item.context);
                     } else if (line.startsWith("#~| msgid ")) {
-                        item.oldMsgId = slurpEscapedString(lines, l, 10, "#~| ", cd);
+                        item.oldMsgId = slurpEscapedString(lines, 10, "#~| ", cd);
                     } else if (line.startsWith("#~| msgid_plural ")) {
-                        QByteArray extra = slurpEscapedString(lines, l, 17, "#~| ", cd);
+                        QByteArray extra = slurpEscapedString(lines, 17, "#~| ", cd);
                         if (extra != item.oldMsgId)
                             item.extra[QLatin1String("po-old_msgid_plural")] =
                                     toUnicode(extra);
                     } else if (line.startsWith("#~| msgctxt ")) {
-                        item.oldTscomment = slurpEscapedString(lines, l, 12, "#~| ", cd);
+                        item.oldTscomment = slurpEscapedString(lines, 12, "#~| ", cd);
                         if (qtContexts)
                             splitContext(&item.oldTscomment, &item.context);
                     } else {
                         cd.appendError(QString(QLatin1String("PO-format parse error in line %1: '%2'"))
-                            .arg(l + 1).arg(toUnicode(lines[l])));
+                            .arg(lines.lineNumber() + 1).arg(toUnicode(lines.line())));
                         error = true;
                     }
                     break;
                 default:
                     cd.appendError(QString(QLatin1String("PO-format parse error in line %1: '%2'"))
-                        .arg(l + 1).arg(toUnicode(lines[l])));
+                        .arg(lines.lineNumber() + 1).arg(toUnicode(lines.line())));
                     error = true;
                     break;
             }
-            lastCmtLine = l;
+            lastCmtLine = lines.lineNumber();
         } else if (line.startsWith("msgctxt ")) {
-            item.tscomment = slurpEscapedString(lines, l, 8, QByteArray(), cd);
+            item.tscomment = slurpEscapedString(lines, 8, QByteArray(), cd);
             if (qtContexts)
                 splitContext(&item.tscomment, &item.context);
         } else if (line.startsWith("msgid ")) {
-            item.msgId = slurpEscapedString(lines, l, 6, QByteArray(), cd);
+            item.msgId = slurpEscapedString(lines, 6, QByteArray(), cd);
         } else if (line.startsWith("msgid_plural ")) {
-            QByteArray extra = slurpEscapedString(lines, l, 13, QByteArray(), cd);
+            QByteArray extra = slurpEscapedString(lines, 13, QByteArray(), cd);
             if (extra != item.msgId)
                 item.extra[QLatin1String("po-msgid_plural")] = toUnicode(extra);
             item.isPlural = true;
         } else {
             cd.appendError(QString(QLatin1String("PO-format error in line %1: '%2'"))
-                .arg(l + 1).arg(toUnicode(lines[l])));
+                .arg(lines.lineNumber() + 1).arg(toUnicode(lines.line())));
             error = true;
         }
     }
     return !error && cd.errors().isEmpty();
 }
 
+bool loadPO(Translator &translator, QIODevice &dev, ConversionData &cd)
+{
+    // Map the file if possible; the lines are read straight from it.
+    QByteArray data;
+    QFile *file = qobject_cast<QFile *>(&dev);
+    const uchar *mapped = nullptr;
+    if (file && file->pos() == 0 && file->size() > 0)
+        mapped = file->map(0, file->size());
+    if (mapped)
+        data = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), file->size());
+    else
+        data = dev.readAll();
+    const bool ok = loadPO(translator, data, cd);
+    if (mapped)
+        file->unmap(const_cast<uchar *>(mapped));
+    return ok;
+}
+
 static void addPoHeader(Translator::ExtraData &headers, QStringList &hdrOrder,
                         const char *name, const QString &value)
 {
@@ -772,16 +899,16 @@ bool savePO(const Translator &translator, QIODevice &dev, ConversionData &)
         hdrStr += headers.value(makePoHeader(hdr));
         hdrStr += QLatin1Char('\n');
     }
-    out << poEscapedString(QString(), QString::fromLatin1("msgstr"), true, hdrStr);
+    poEscapedString(out, QString(), QString::fromLatin1("msgstr"), true, hdrStr);
 
     for (const TranslatorMessage &msg : translator.messages()) {
-        out << Qt::endl;
+        out << '\n';
 
         if (!msg.translatorComment().isEmpty())
-            out << poEscapedLines(QLatin1String("#"), true, msg.translatorComment());
+            poEscapedLines(out, QLatin1String("#"), true, msg.translatorComment());
 
         if (!msg.extraComment().isEmpty())
-            out << poEscapedLines(QLatin1String("#."), true, msg.extraComment());
+            poEscapedLines(out, QLatin1String("#."), true, msg.extraComment());
 
         if (!msg.id().isEmpty())
             out << QLatin1String("#. ts-id ") << msg.id() << '\n';
@@ -794,7 +921,7 @@ bool savePO(const Translator &translator, QIODevice &dev, ConversionData &)
                                     .arg(ref.lineNumber()).arg(ref.fileName()));
             if (!xrefs.isEmpty())
                 refs << xrefs;
-            out << poWrappedEscapedLines(QLatin1String("#:"), true, refs.join(QLatin1Char(' ')));
+            poWrappedEscapedLines(out, QLatin1String("#:"), true, refs.join(QLatin1Char(' ')));
         }
 
         bool noWrap = false;
@@ -835,39 +962,39 @@ bool savePO(const Translator &translator, QIODevice &dev, ConversionData &)
                            || msg.type() == TranslatorMessage::Vanished);
         QString prefix = QLatin1String(isObsolete ? "#~| " : "#| ");
         if (!msg.oldComment().isEmpty())
-            out << poEscapedString(prefix, QLatin1String("msgctxt"), noWrap,
-                                   escapeComment(msg.oldComment(), qtContexts));
+            poEscapedString(out, prefix, QLatin1String("msgctxt"), noWrap,
+                            escapeComment(msg.oldComment(), qtContexts));
         if (!msg.oldSourceText().isEmpty())
-            out << poEscapedString(prefix, QLatin1String("msgid"), noWrap, msg.oldSourceText());
+            poEscapedString(out, prefix, QLatin1String("msgid"), noWrap, msg.oldSourceText());
         QString plural = msg.extra(QLatin1String("po-old_msgid_plural"));
         if (!plural.isEmpty())
-            out << poEscapedString(prefix, QLatin1String("msgid_plural"), noWrap, plural);
+            poEscapedString(out, prefix, QLatin1String("msgid_plural"), noWrap, plural);
         prefix = QLatin1String(isObsolete ? "#~ " : "");
         if (!msg.context().isEmpty())
-            out << poEscapedString(prefix, QLatin1String("msgctxt"), noWrap,
-                                   escapeComment(msg.context(), true) + QLatin1Char('|')
-                                   + escapeComment(msg.comment(), true));
+            poEscapedString(out, prefix, QLatin1String("msgctxt"), noWrap,
+                            escapeComment(msg.context(), true) + QLatin1Char('|')
+                            + escapeComment(msg.comment(), true));
         else if (!msg.comment().isEmpty())
-            out << poEscapedString(prefix, QLatin1String("msgctxt"), noWrap,
-                                   escapeComment(msg.comment(), qtContexts));
-        out << poEscapedString(prefix, QLatin1String("msgid"), noWrap, msg.sourceText());
+            poEscapedString(out, prefix, QLatin1String("msgctxt"), noWrap,
+                            escapeComment(msg.comment(), qtContexts));
+        poEscapedString(out, prefix, QLatin1String("msgid"), noWrap, msg.sourceText());
         if (!msg.isPlural()) {
             QString transl = msg.translation();
             transl.replace(QChar(Translator::BinaryVariantSeparator),
                            QChar(Translator::TextVariantSeparator));
-            out << poEscapedString(prefix, QLatin1String("msgstr"), noWrap, transl);
+            poEscapedString(out, prefix, QLatin1String("msgstr"), noWrap, transl);
         } else {
             QString plural = msg.extra(QLatin1String("po-msgid_plural"));
             if (plural.isEmpty())
                 plural = msg.sourceText();
-            out << poEscapedString(prefix, QLatin1String("msgid_plural"), noWrap, plural);
+            poEscapedString(out, prefix, QLatin1String("msgid_plural"), noWrap, plural);
             const QStringList &translations = msg.translations();
             for (int i = 0; i != translations.size(); ++i) {
                 QString str = translations.at(i);
                 str.replace(QChar(Translator::BinaryVariantSeparator),
                             QChar(Translator::TextVariantSeparator));
-                out << poEscapedString(prefix, QString::fromLatin1("msgstr[%1]").arg(i), noWrap,
-                                       str);
+                poEscapedString(out, prefix, QString::fromLatin1("msgstr[%1]").arg(i), noWrap,
+                                str);
             }
         }
     }
@@ -36,8 +36,12 @@
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
-#include <QtCore/QMap>
+#include <QtCore/QSet>
 #include <QtCore/QString>
+#include <QtCore/QtEndian>
+
+#include <algorithm>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 
@@ -73,20 +77,23 @@ enum Prefix {
 
 } // namespace anon
 
-static uint elfHash(const QByteArray &ba)
+// Hashes the concatenation of ba1 and ba2, up to the first null byte
+static uint elfHash(const QByteArray &ba1, const QByteArray &ba2 = QByteArray())
 {
-    const uchar *k = (const uchar *)ba.data();
     uint h = 0;
     uint g;
 
-    if (k) {
-        while (*k) {
-            h = (h << 4) + *k++;
+    for (const QByteArray *ba : { &ba1, &ba2 }) {
+        for (const char c : *ba) {
+            if (!c)
+                goto done;
+            h = (h << 4) + uchar(c);
             if ((g = (h & 0xf0000000)) != 0)
                 h ^= g >> 24;
             h &= ~g;
         }
     }
+  done:
     if (!h)
         h = 1;
     return h;
@@ -110,6 +117,11 @@ public:
     const QByteArray &comment() const { return m_comment; }
     const QStringList &translations() const { return m_translations; }
     bool operator<(const ByteTranslatorMessage& m) const;
+    bool operator==(const ByteTranslatorMessage& m) const
+    {
+        return m_context == m.m_context && m_sourcetext == m.m_sourcetext
+                && m_comment == m.m_comment;
+    }
 
 private:
     QByteArray m_context;
@@ -129,6 +141,64 @@ bool ByteTranslatorMessage::operator<(const ByteTranslatorMessage& m) const
     return m_comment < m.m_comment;
 }
 
+// Like operator==(), this ignores the translations.
+static size_t qHash(const ByteTranslatorMessage &msg, size_t seed = 0)
+{
+    return qHash(msg.context(), seed) ^ qHash(msg.sourceText(), seed)
+            ^ qHash(msg.comment(), seed);
+}
+
+/*
+  Writing the binary sections. This produces the same bytes as a
+  QDataStream with the default (big endian) byte order, but writes
+  directly into buffers which have the final size already.
+*/
+static inline uint streamedSize(const QByteArray &ba)
+{
+    return 4 + (ba.isNull() ? 0 : uint(ba.size()));
+}
+
+static inline uint streamedSize(const QString &str)
+{
+    return 4 + (str.isNull() ? 0 : uint(str.size()) * 2);
+}
+
+static inline uchar *write8(uchar *p, quint8 v)
+{
+    *p = v;
+    return p + 1;
+}
+
+static inline uchar *write16(uchar *p, quint16 v)
+{
+    qToBigEndian(v, p);
+    return p + 2;
+}
+
+static inline uchar *write32(uchar *p, quint32 v)
+{
+    qToBigEndian(v, p);
+    return p + 4;
+}
+
+static inline uchar *write(uchar *p, const QByteArray &ba)
+{
+    if (ba.isNull())
+        return write32(p, 0xffffffff);
+    p = write32(p, quint32(ba.size()));
+    memcpy(p, ba.constData(), ba.size());
+    return p + ba.size();
+}
+
+static inline uchar *write(uchar *p, const QString &str)
+{
+    if (str.isNull())
+        return write32(p, 0xffffffff);
+    p = write32(p, quint32(str.size()) * 2);
+    qToBigEndian<quint16>(str.utf16(), str.size(), p);
+    return p + str.size() * 2;
+}
+
 class Releaser
 {
 public:
@@ -171,19 +241,23 @@ private:
     // on turn should be the same as passed to the actual tr(...) calls
     QByteArray originalBytes(const QString &str) const;
 
-    static Prefix commonPrefix(const ByteTranslatorMessage &m1, const ByteTranslatorMessage &m2);
+    static Prefix commonPrefix(const ByteTranslatorMessage &m1, uint hash1,
+                               const ByteTranslatorMessage &m2, uint hash2);
 
     static uint msgHash(const ByteTranslatorMessage &msg);
 
-    void writeMessage(const ByteTranslatorMessage & msg, QDataStream & stream,
-        TranslatorSaveMode strip, Prefix prefix) const;
+    static uint messageSize(const ByteTranslatorMessage &msg, Prefix prefix);
+    static uchar *writeMessage(uchar *p, const ByteTranslatorMessage &msg, Prefix prefix);
+
+    void squeezeContexts(const QList<ByteTranslatorMessage> &messages);
 
     QString m_language;
     // for squeezed but non-file data, this is what needs to be deleted
     QByteArray m_messageArray;
     QByteArray m_offsetArray;
     QByteArray m_contextArray;
-    QMap<ByteTranslatorMessage, void *> m_messages;
+    QList<ByteTranslatorMessage> m_messages;
+    QSet<ByteTranslatorMessage> m_messageSet;
     QByteArray m_numerusRules;
     QStringList m_dependencies;
     QByteArray m_dependencyArray;
@@ -201,12 +275,13 @@ QByteArray Releaser::originalBytes(const QString &str) const
 
 uint Releaser::msgHash(const ByteTranslatorMessage &msg)
 {
-    return elfHash(msg.sourceText() + msg.comment());
+    return elfHash(msg.sourceText(), msg.comment());
 }
 
-Prefix Releaser::commonPrefix(const ByteTranslatorMessage &m1, const ByteTranslatorMessage &m2)
+Prefix Releaser::commonPrefix(const ByteTranslatorMessage &m1, uint hash1,
+                              const ByteTranslatorMessage &m2, uint hash2)
 {
-    if (msgHash(m1) != msgHash(m2))
+    if (hash1 != hash2)
         return NoPrefix;
     if (m1.context() != m2.context())
         return Hash;
@@ -217,30 +292,53 @@ Prefix Releaser::commonPrefix(const ByteTranslatorMessage &m1, const ByteTransla
     return HashContextSourceTextComment;
 }
 
-void Releaser::writeMessage(const ByteTranslatorMessage &msg, QDataStream &stream,
-    TranslatorSaveMode mode, Prefix prefix) const
+uint Releaser::messageSize(const ByteTranslatorMessage &msg, Prefix prefix)
 {
-    for (int i = 0; i < msg.translations().count(); ++i)
-        stream << quint8(Tag_Translation) << msg.translations().at(i);
+    uint size = 0;
+    for (const QString &translation : msg.translations())
+        size += 1 + streamedSize(translation);
+
+    switch (prefix) {
+    default:
+    case HashContextSourceTextComment:
+        size += 1 + streamedSize(msg.comment());
+        Q_FALLTHROUGH();
+    case HashContextSourceText:
+        size += 1 + streamedSize(msg.sourceText());
+        Q_FALLTHROUGH();
+    case HashContext:
+        size += 1 + streamedSize(msg.context());
+        break;
+    }
 
-    if (mode == SaveEverything)
-        prefix = HashContextSourceTextComment;
+    return size + 1;
+}
+
+uchar *Releaser::writeMessage(uchar *p, const ByteTranslatorMessage &msg, Prefix prefix)
+{
+    for (const QString &translation : msg.translations()) {
+        p = write8(p, Tag_Translation);
+        p = write(p, translation);
+    }
 
     // lrelease produces "wrong" QM files for QByteArrays that are .isNull().
     switch (prefix) {
     default:
     case HashContextSourceTextComment:
-        stream << quint8(Tag_Comment) << msg.comment();
+        p = write8(p, Tag_Comment);
+        p = write(p, msg.comment());
         Q_FALLTHROUGH();
     case HashContextSourceText:
-        stream << quint8(Tag_SourceText) << msg.sourceText();
+        p = write8(p, Tag_SourceText);
+        p = write(p, msg.sourceText());
         Q_FALLTHROUGH();
     case HashContext:
-        stream << quint8(Tag_Context) << msg.context();
+        p = write8(p, Tag_Context);
+        p = write(p, msg.context());
         break;
     }
 
-    stream << quint8(Tag_End);
+    return write8(p, Tag_End);
 }
 
 
@@ -293,117 +391,148 @@ void Releaser::squeeze(TranslatorSaveMode mode)
     if (m_messages.isEmpty() && mode == SaveEverything)
         return;
 
-    const auto messages = m_messages;
+    QList<ByteTranslatorMessage> messages;
+    messages.swap(m_messages);
+    m_messageSet.clear();
+    std::sort(messages.begin(), messages.end());
 
     // re-build contents
     m_messageArray.clear();
     m_offsetArray.clear();
     m_contextArray.clear();
-    m_messages.clear();
 
-    QMap<Offset, void *> offsets;
+    const int count = messages.size();
+    std::vector<uint> hashes(count);
+    for (int i = 0; i < count; ++i)
+        hashes[i] = msgHash(messages.at(i));
 
-    QDataStream ms(&m_messageArray, QIODevice::WriteOnly);
+    // How much of each message can be left out, because it is implied by the hash
+    std::vector<Prefix> prefixes(count, HashContextSourceTextComment);
+    uint messageArraySize = 0;
     int cpPrev = 0, cpNext = 0;
-    for (auto it = messages.cbegin(), end = messages.cend(); it != end; ++it) {
+    for (int i = 0; i < count; ++i) {
         cpPrev = cpNext;
-        const auto next = std::next(it);
-        if (next == end)
+        if (i + 1 == count)
             cpNext = 0;
         else
-            cpNext = commonPrefix(it.key(), next.key());
-        offsets.insert(Offset(msgHash(it.key()), ms.device()->pos()), (void *)0);
-        writeMessage(it.key(), ms, mode, Prefix(qMax(cpPrev, cpNext + 1)));
+            cpNext = commonPrefix(messages.at(i), hashes[i], messages.at(i + 1), hashes[i + 1]);
+        if (mode != SaveEverything)
+            prefixes[i] = Prefix(qMax(cpPrev, cpNext + 1));
+        messageArraySize += messageSize(messages.at(i), prefixes[i]);
     }
 
-    auto offset = offsets.cbegin();
-    QDataStream ds(&m_offsetArray, QIODevice::WriteOnly);
-    while (offset != offsets.cend()) {
-        Offset k = offset.key();
-        ++offset;
-        ds << quint32(k.h) << quint32(k.o);
+    std::vector<Offset> offsets;
+    offsets.reserve(count);
+    m_messageArray.resize(messageArraySize);
+    uchar *const messageData = reinterpret_cast<uchar *>(m_messageArray.data());
+    uchar *p = messageData;
+    for (int i = 0; i < count; ++i) {
+        offsets.push_back(Offset(hashes[i], uint(p - messageData)));
+        p = writeMessage(p, messages.at(i), prefixes[i]);
+    }
+    Q_ASSERT(p == messageData + messageArraySize);
+
+    std::sort(offsets.begin(), offsets.end());
+    m_offsetArray.resize(int(offsets.size()) * 8);
+    p = reinterpret_cast<uchar *>(m_offsetArray.data());
+    for (const Offset &offset : offsets) {
+        p = write32(p, offset.h);
+        p = write32(p, offset.o);
     }
 
-    if (mode == SaveStripped) {
-        QMap<QByteArray, int> contextSet;
-        for (auto it = messages.cbegin(), end = messages.cend(); it != end; ++it)
-            ++contextSet[it.key().context()];
+    if (mode == SaveStripped)
+        squeezeContexts(messages);
+}
 
-        quint16 hTableSize;
-        if (contextSet.size() < 200)
-            hTableSize = (contextSet.size() < 60) ? 151 : 503;
-        else if (contextSet.size() < 2500)
-            hTableSize = (contextSet.size() < 750) ? 1511 : 5003;
-        else
-            hTableSize = (contextSet.size() < 10000) ? 15013 : 3 * contextSet.size() / 2;
-
-        QMultiMap<int, QByteArray> hashMap;
-        for (auto c = contextSet.cbegin(), end = contextSet.cend(); c != end; ++c)
-            hashMap.insert(elfHash(c.key()) % hTableSize, c.key());
-
-        /*
-          The contexts found in this translator are stored in a hash
-          table to provide fast lookup. The context array has the
-          following format:
-
-              quint16 hTableSize;
-              quint16 hTable[hTableSize];
-              quint8  contextPool[...];
-
-          The context pool stores the contexts as Pascal strings:
-
-              quint8  len;
-              quint8  data[len];
-
-          Let's consider the look-up of context "FunnyDialog".  A
-          hash value between 0 and hTableSize - 1 is computed, say h.
-          If hTable[h] is 0, "FunnyDialog" is not covered by this
-          translator. Else, we check in the contextPool at offset
-          2 * hTable[h] to see if "FunnyDialog" is one of the
-          contexts stored there, until we find it or we meet the
-          empty string.
-        */
-        m_contextArray.resize(2 + (hTableSize << 1));
-        QDataStream t(&m_contextArray, QIODevice::WriteOnly);
-
-        quint16 *hTable = new quint16[hTableSize];
-        memset(hTable, 0, hTableSize * sizeof(quint16));
-
-        t << hTableSize;
-        t.device()->seek(2 + (hTableSize << 1));
-        t << quint16(0); // the entry at offset 0 cannot be used
-        uint upto = 2;
-
-        auto entry = hashMap.constBegin();
-        while (entry != hashMap.constEnd()) {
-            int i = entry.key();
-            hTable[i] = quint16(upto >> 1);
-
-            do {
-                const char *con = entry.value().constData();
-                uint len = uint(entry.value().length());
-                len = qMin(len, 255u);
-                t << quint8(len);
-                t.writeRawData(con, len);
-                upto += 1 + len;
-                ++entry;
-            } while (entry != hashMap.constEnd() && entry.key() == i);
-            if (upto & 0x1) {
-                // offsets have to be even
-                t << quint8(0); // empty string
-                ++upto;
-            }
+void Releaser::squeezeContexts(const QList<ByteTranslatorMessage> &messages)
+{
+    // The messages are sorted, so this is sorted, too.
+    QList<QByteArray> contexts;
+    for (const ByteTranslatorMessage &msg : messages) {
+        if (contexts.isEmpty() || contexts.constLast() != msg.context())
+            contexts.append(msg.context());
+    }
+
+    quint16 hTableSize;
+    if (contexts.size() < 200)
+        hTableSize = (contexts.size() < 60) ? 151 : 503;
+    else if (contexts.size() < 2500)
+        hTableSize = (contexts.size() < 750) ? 1511 : 5003;
+    else
+        hTableSize = (contexts.size() < 10000) ? 15013 : 3 * contexts.size() / 2;
+
+    // Bucket the contexts; within a bucket, they come in descending order.
+    std::vector<std::pair<int, int>> buckets; // bucket, -index into contexts
+    buckets.reserve(contexts.size());
+    for (int i = 0; i < contexts.size(); ++i)
+        buckets.emplace_back(int(elfHash(contexts.at(i)) % hTableSize), -i);
+    std::sort(buckets.begin(), buckets.end());
+
+    /*
+      The contexts found in this translator are stored in a hash
+      table to provide fast lookup. The context array has the
+      following format:
+
+          quint16 hTableSize;
+          quint16 hTable[hTableSize];
+          quint8  contextPool[...];
+
+      The context pool stores the contexts as Pascal strings:
+
+          quint8  len;
+          quint8  data[len];
+
+      Let's consider the look-up of context "FunnyDialog".  A
+      hash value between 0 and hTableSize - 1 is computed, say h.
+      If hTable[h] is 0, "FunnyDialog" is not covered by this
+      translator. Else, we check in the contextPool at offset
+      2 * hTable[h] to see if "FunnyDialog" is one of the
+      contexts stored there, until we find it or we meet the
+      empty string.
+    */
+    uint poolSize = 2; // the entry at offset 0 cannot be used
+    for (size_t j = 0; j < buckets.size(); ++j) {
+        poolSize += 1 + qMin(uint(contexts.at(-buckets[j].second).length()), 255u);
+        if ((j + 1 == buckets.size() || buckets[j + 1].first != buckets[j].first)
+            && (poolSize & 0x1)) {
+            ++poolSize;
         }
-        t.device()->seek(2);
-        for (int j = 0; j < hTableSize; j++)
-            t << hTable[j];
-        delete [] hTable;
-
-        if (upto > 131072) {
-            qWarning("Releaser::squeeze: Too many contexts");
-            m_contextArray.clear();
+    }
+
+    m_contextArray.resize(2 + (hTableSize << 1) + poolSize);
+    uchar *const contextData = reinterpret_cast<uchar *>(m_contextArray.data());
+    write16(contextData, hTableSize);
+    uchar *const hTable = contextData + 2;
+    memset(hTable, 0, hTableSize << 1);
+    uchar *p = write16(hTable + (hTableSize << 1), 0);
+    uint upto = 2;
+
+    auto entry = buckets.cbegin();
+    while (entry != buckets.cend()) {
+        int i = entry->first;
+        write16(hTable + (i << 1), quint16(upto >> 1));
+
+        do {
+            const QByteArray &context = contexts.at(-entry->second);
+            uint len = qMin(uint(context.length()), 255u);
+            p = write8(p, quint8(len));
+            memcpy(p, context.constData(), len);
+            p += len;
+            upto += 1 + len;
+            ++entry;
+        } while (entry != buckets.cend() && entry->first == i);
+        if (upto & 0x1) {
+            // offsets have to be even
+            p = write8(p, 0); // empty string
+            ++upto;
         }
     }
+    Q_ASSERT(p == contextData + m_contextArray.size());
+
+    if (upto > 131072) {
+        qWarning("Releaser::squeeze: Too many contexts");
+        m_contextArray.clear();
+    }
 }
 
 void Releaser::insert(const TranslatorMessage &message, const QStringList &tlns, bool forceComment)
@@ -415,18 +544,26 @@ void Releaser::insert(const TranslatorMessage &message, const QStringList &tlns,
     if (!forceComment) {
         ByteTranslatorMessage bmsg2(
                 bmsg.context(), bmsg.sourceText(), QByteArray(""), bmsg.translations());
-        if (!m_messages.contains(bmsg2)) {
-            m_messages.insert(bmsg2, 0);
+        if (!m_messageSet.contains(bmsg2)) {
+            m_messageSet.insert(bmsg2);
+            m_messages.append(bmsg2);
             return;
         }
     }
-    m_messages.insert(bmsg, 0);
+    // The first translations of a message win.
+    if (!m_messageSet.contains(bmsg)) {
+        m_messageSet.insert(bmsg);
+        m_messages.append(bmsg);
+    }
 }
 
 void Releaser::insertIdBased(const TranslatorMessage &message, const QStringList &tlns)
 {
     ByteTranslatorMessage bmsg("", originalBytes(message.id()), "", tlns);
-    m_messages.insert(bmsg, 0);
+    if (!m_messageSet.contains(bmsg)) {
+        m_messageSet.insert(bmsg);
+        m_messages.append(bmsg);
+    }
 }
 
 void Releaser::setNumerusRules(const QByteArray &rules)
@@ -456,25 +593,73 @@ static void fromBytes(const char *str, int len, QString *out, bool *utf8Fail)
     *utf8Fail = toUnicode.hasError();
 }
 
-bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
+QMReader::QMReader()
+    : m_file(nullptr),
+      m_mapped(nullptr),
+      m_messageArray(nullptr),
+      m_messageLength(0),
+      m_offsetArray(nullptr),
+      m_messageCount(0),
+      m_current(0),
+      m_guessPlurals(true),
+      m_utf8Fail(false),
+      m_formatError(false)
+{
+}
+
+QMReader::~QMReader()
+{
+    close();
+}
+
+void QMReader::close()
+{
+    if (m_mapped)
+        m_file->unmap(const_cast<uchar *>(m_mapped));
+    m_file = nullptr;
+    m_mapped = nullptr;
+    m_data.clear();
+    m_messageArray = nullptr;
+    m_messageLength = 0;
+    m_offsetArray = nullptr;
+    m_messageCount = 0;
+    m_current = 0;
+    m_guessPlurals = true;
+    m_utf8Fail = false;
+    m_formatError = false;
+    m_language.clear();
+    m_dependencies.clear();
+    m_context.clear();
+    m_sourceText.clear();
+    m_comment.clear();
+}
+
+bool QMReader::open(QIODevice &dev, ConversionData &cd)
 {
-    QByteArray ba = dev.readAll();
-    const uchar *data = (uchar*)ba.data();
-    int len = ba.size();
+    close();
+
+    // Map the file if possible, so the messages are read straight from it.
+    QFile *file = qobject_cast<QFile *>(&dev);
+    if (file && file->pos() == 0 && file->size() > 0)
+        m_mapped = file->map(0, file->size());
+    if (m_mapped) {
+        m_file = file;
+        m_data = QByteArray::fromRawData(reinterpret_cast<const char *>(m_mapped), file->size());
+    } else {
+        m_data = dev.readAll();
+    }
+
+    const uchar *data = reinterpret_cast<const uchar *>(m_data.constData());
+    int len = m_data.size();
     if (len < MagicLength || memcmp(data, magic, MagicLength) != 0) {
         cd.appendError(QLatin1String("QM-Format error: magic marker missing"));
+        close();
         return false;
     }
 
     enum { Contexts = 0x2f, Hashes = 0x42, Messages = 0x69, NumerusRules = 0x88, Dependencies = 0x96, Language = 0xa7 };
 
-    // for squeezed but non-file data, this is what needs to be deleted
-    const uchar *messageArray = 0;
-    const uchar *offsetArray = 0;
     uint offsetLength = 0;
-
-    bool ok = true;
-    bool utf8Fail = false;
     const uchar *end = data + len;
 
     data += MagicLength;
@@ -482,157 +667,176 @@ bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
     while (data < end - 4) {
         quint8 tag = read8(data++);
         quint32 blockLen = read32(data);
-        //qDebug() << "TAG:" << tag <<  "BLOCKLEN:" << blockLen;
         data += 4;
         if (!tag || !blockLen)
             break;
-        if (data + blockLen > end) {
-            ok = false;
+        if (blockLen > quint32(end - data)) {
+            m_formatError = true;
             break;
         }
 
         if (tag == Hashes) {
-            offsetArray = data;
+            m_offsetArray = data;
             offsetLength = blockLen;
-            //qDebug() << "HASHES: " << blockLen << QByteArray((const char *)data, blockLen).toHex();
         } else if (tag == Messages) {
-            messageArray = data;
-            //qDebug() << "MESSAGES: " << blockLen << QByteArray((const char *)data, blockLen).toHex();
+            m_messageArray = data;
+            m_messageLength = blockLen;
         } else if (tag == Dependencies) {
-            QStringList dependencies;
             QDataStream stream(QByteArray::fromRawData((const char*)data, blockLen));
             QString dep;
             while (!stream.atEnd()) {
                 stream >> dep;
-                dependencies.append(dep);
+                m_dependencies.append(dep);
             }
-            translator.setDependencies(dependencies);
         } else if (tag == Language) {
-            QString language;
-            fromBytes((const char *)data, blockLen, &language, &utf8Fail);
-            translator.setLanguageCode(language);
+            fromBytes((const char *)data, blockLen, &m_language, &m_utf8Fail);
         }
 
         data += blockLen;
     }
 
+    m_messageCount = m_offsetArray ? int(offsetLength / (2 * sizeof(quint32))) : 0;
 
-    size_t numItems = offsetLength / (2 * sizeof(quint32));
-    //qDebug() << "NUMITEMS: " << numItems;
-
-    QString strProN = QLatin1String("%n");
     QLocale::Language l;
     QLocale::Country c;
-    Translator::languageAndCountry(translator.languageCode(), &l, &c);
+    Translator::languageAndCountry(m_language, &l, &c);
     QStringList numerusForms;
-    bool guessPlurals = true;
     if (getNumerusInfo(l, c, 0, &numerusForms, 0))
-        guessPlurals = (numerusForms.count() == 1);
+        m_guessPlurals = (numerusForms.count() == 1);
 
-    QString context, sourcetext, comment;
-    QStringList translations;
+    return true;
+}
 
-    for (const uchar *start = offsetArray; start != offsetArray + (numItems << 3); start += 8) {
-        //quint32 hash = read32(start);
-        quint32 ro = read32(start + 4);
-        //qDebug() << "\nHASH:" << hash;
-        const uchar *m = messageArray + ro;
-
-        for (;;) {
-            uchar tag = read8(m++);
-            //qDebug() << "Tag:" << tag << " ADDR: " << m;
-            switch(tag) {
-            case Tag_End:
-                goto end;
-            case Tag_Translation: {
-                int len = read32(m);
-                if (len % 1) {
-                    cd.appendError(QLatin1String("QM-Format error"));
-                    return false;
-                }
-                m += 4;
-                QString str = QString((const QChar *)m, len/2);
-                if (QSysInfo::ByteOrder == QSysInfo::LittleEndian) {
-                    for (int i = 0; i < str.length(); ++i)
-                        str[i] = QChar((str.at(i).unicode() >> 8) +
-                            ((str.at(i).unicode() << 8) & 0xff00));
-                }
-                translations << str;
-                m += len;
-                break;
-            }
-            case Tag_Obsolete1:
-                m += 4;
-                //qDebug() << "OBSOLETE";
-                break;
-            case Tag_SourceText: {
-                quint32 len = read32(m);
-                m += 4;
-                //qDebug() << "SOURCE LEN: " << len;
-                //qDebug() << "SOURCE: " << QByteArray((const char*)m, len);
-                fromBytes((const char*)m, len, &sourcetext, &utf8Fail);
-                m += len;
-                break;
+bool QMReader::readMessage(TranslatorMessage *msg)
+{
+    if (atEnd())
+        return false;
+
+    const uchar *start = m_offsetArray + (m_current++ << 3);
+    quint32 ro = read32(start + 4);
+    if (!m_messageArray || ro >= m_messageLength) {
+        m_formatError = true;
+        return false;
+    }
+    const uchar *m = m_messageArray + ro;
+    const uchar *end = m_messageArray + m_messageLength;
+
+    // Reads the length of a string, and checks that the string is in the message array
+    auto stringLength = [&](quint32 *len) {
+        if (end - m < 4)
+            return false;
+        *len = read32(m);
+        m += 4;
+        return *len == 0xffffffff || *len <= quint32(end - m);
+    };
+
+    QStringList translations;
+    while (m < end) {
+        uchar tag = read8(m++);
+        quint32 len;
+        switch (tag) {
+        case Tag_End:
+            goto end;
+        case Tag_Translation: {
+            if (!stringLength(&len) || (len != 0xffffffff && (len & 1))) {
+                m_formatError = true;
+                return false;
             }
-            case Tag_Context: {
-                quint32 len = read32(m);
-                m += 4;
-                //qDebug() << "CONTEXT LEN: " << len;
-                //qDebug() << "CONTEXT: " << QByteArray((const char*)m, len);
-                fromBytes((const char*)m, len, &context, &utf8Fail);
-                m += len;
+            if (len == 0xffffffff) {
+                translations << QString();
                 break;
             }
-            case Tag_Comment: {
-                quint32 len = read32(m);
-                m += 4;
-                //qDebug() << "COMMENT LEN: " << len;
-                //qDebug() << "COMMENT: " << QByteArray((const char*)m, len);
-                fromBytes((const char*)m, len, &comment, &utf8Fail);
-                m += len;
-                break;
+            QString str(len / 2, Qt::Uninitialized);
+            qFromBigEndian<ushort>(m, len / 2, str.data());
+            translations << str;
+            m += len;
+            break;
+        }
+        case Tag_Obsolete1:
+            if (end - m < 4) {
+                m_formatError = true;
+                return false;
             }
-            default:
-                //qDebug() << "UNKNOWN TAG" << tag;
-                break;
+            m += 4;
+            break;
+        case Tag_SourceText:
+        case Tag_Context:
+        case Tag_Comment: {
+            if (!stringLength(&len)) {
+                m_formatError = true;
+                return false;
             }
+            if (len == 0xffffffff)
+                len = 0;
+            QString *str = tag == Tag_SourceText ? &m_sourceText
+                    : tag == Tag_Context ? &m_context : &m_comment;
+            fromBytes((const char*)m, len, str, &m_utf8Fail);
+            m += len;
+            break;
         }
-    end:;
-        TranslatorMessage msg;
-        msg.setType(TranslatorMessage::Finished);
-        if (translations.count() > 1) {
-            // If guessPlurals is not false here, plural form discard messages
-            // will be spewn out later.
-            msg.setPlural(true);
-        } else if (guessPlurals) {
-            // This might cause false positives, so it is a fallback only.
-            if (sourcetext.contains(strProN))
-                msg.setPlural(true);
+        default:
+            break;
         }
-        msg.setTranslations(translations);
-        translations.clear();
-        msg.setContext(context);
-        msg.setSourceText(sourcetext);
-        msg.setComment(comment);
-        translator.append(msg);
     }
-    if (utf8Fail) {
+    // The message array ended in the middle of a message
+    m_formatError = true;
+    return false;
+  end:
+    *msg = TranslatorMessage();
+    msg->setType(TranslatorMessage::Finished);
+    if (translations.count() > 1) {
+        // If guessPlurals is not false here, plural form discard messages
+        // will be spewn out later.
+        msg->setPlural(true);
+    } else if (m_guessPlurals) {
+        // This might cause false positives, so it is a fallback only.
+        if (m_sourceText.contains(QLatin1String("%n")))
+            msg->setPlural(true);
+    }
+    msg->setTranslations(translations);
+    msg->setContext(m_context);
+    msg->setSourceText(m_sourceText);
+    msg->setComment(m_comment);
+    return true;
+}
+
+bool QMReader::finish(ConversionData &cd) const
+{
+    if (m_utf8Fail) {
         cd.appendError(QLatin1String("Error: File contains invalid UTF-8 sequences."));
         return false;
     }
-    return ok;
+    if (m_formatError) {
+        cd.appendError(QLatin1String("QM-Format error"));
+        return false;
+    }
+    return true;
 }
 
+bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
+{
+    QMReader reader;
+    if (!reader.open(dev, cd))
+        return false;
+
+    translator.setDependencies(reader.dependencies());
+    translator.setLanguageCode(reader.languageCode());
 
+    TranslatorMessage msg;
+    while (reader.readMessage(&msg))
+        translator.append(msg);
+    return reader.finish(cd);
+}
 
-static bool containsStripped(const Translator &translator, const TranslatorMessage &msg)
+// The (context, source text) pairs of the messages without comment
+static QSet<QPair<QString, QString>> strippedMessages(const Translator &translator)
 {
-    for (const TranslatorMessage &tmsg : translator.messages())
-        if (tmsg.sourceText() == msg.sourceText()
-            && tmsg.context() == msg.context()
-            && tmsg.comment().isEmpty())
-        return true;
-    return false;
+    QSet<QPair<QString, QString>> result;
+    for (const TranslatorMessage &tmsg : translator.messages()) {
+        if (tmsg.comment().isEmpty())
+            result.insert(qMakePair(tmsg.context(), tmsg.sourceText()));
+    }
+    return result;
 }
 
 bool saveQM(const Translator &translator, QIODevice &dev, ConversionData &cd)
@@ -650,6 +854,8 @@ bool saveQM(const Translator &translator, QIODevice &dev, ConversionData &cd)
     int untranslated = 0;
     int missingIds = 0;
     int droppedData = 0;
+    const QSet<QPair<QString, QString>> stripped = cd.m_idBased
+            ? QSet<QPair<QString, QString>>() : strippedMessages(translator);
 
     for (int i = 0; i != translator.messageCount(); ++i) {
         const TranslatorMessage &msg = translator.message(i);
@@ -690,7 +896,7 @@ bool saveQM(const Translator &translator, QIODevice &dev, ConversionData &cd)
                 bool forceComment =
                         msg.comment().isEmpty()
                         || msg.context().isEmpty()
-                        || containsStripped(translator, msg);
+                        || stripped.contains(qMakePair(msg.context(), msg.sourceText()));
                 releaser.insert(msg, tlns, forceComment);
             }
         }
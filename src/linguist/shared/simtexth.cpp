@@ -33,6 +33,9 @@
 #include <QtCore/QString>
 #include <QtCore/QList>
 
+#include <algorithm>
+#include <climits>
+
 
 QT_BEGIN_NAMESPACE
 
@@ -168,6 +171,14 @@ static inline CoMatrix intersection(const CoMatrix &m, const CoMatrix &n)
     return p;
 }
 
+static inline int similarityScore(const CoMatrix &m, int mLength, const CoMatrix &n, int nLength)
+{
+    int delta = qAbs(mLength - nLength);
+    int score = ( (worth(intersection(m, n)) + 1) << 10 ) /
+        ( worth(reunion(m, n)) + (delta << 1) + 1 );
+    return score;
+}
+
 StringSimilarityMatcher::StringSimilarityMatcher(const QString &stringToMatch)
     : m_cm(stringToMatch)
 {
@@ -176,11 +187,97 @@ StringSimilarityMatcher::StringSimilarityMatcher(const QString &stringToMatch)
 
 int StringSimilarityMatcher::getSimilarityScore(const QString &strCandidate)
 {
-    CoMatrix cmTarget(strCandidate);
-    int delta = qAbs(m_length - strCandidate.size());
-    int score = ( (worth(intersection(m_cm, cmTarget)) + 1) << 10 ) /
-        ( worth(reunion(m_cm, cmTarget)) + (delta << 1) + 1 );
-    return score;
+    return similarityScore(m_cm, m_length, CoMatrix(strCandidate), strCandidate.size());
+}
+
+void SimilarTextIndex::addText(const QString &text)
+{
+    Entry entry;
+    entry.matrix = CoMatrix(text);
+    entry.worth = worth(entry.matrix);
+    entry.length = text.length();
+    if (m_byWorth.size() <= entry.worth)
+        m_byWorth.resize(entry.worth + 1);
+    m_byWorth[entry.worth].append(m_entries.size());
+    m_entries.append(entry);
+    m_sorted = false;
+}
+
+void SimilarTextIndex::ensureSorted() const
+{
+    if (m_sorted)
+        return;
+    for (QList<int> &ids : m_byWorth) {
+        std::stable_sort(ids.begin(), ids.end(), [this](int a, int b) {
+            return m_entries.at(a).length < m_entries.at(b).length;
+        });
+    }
+    m_sorted = true;
+}
+
+QList<QPair<int, int>> SimilarTextIndex::matches(const QString &text, int threshold) const
+{
+    ensureSorted();
+
+    const CoMatrix cm(text);
+    const int cmWorth = worth(cm);
+    const int length = text.length();
+
+    QList<QPair<int, int>> result;
+    for (int w = 0; w < m_byWorth.size(); ++w) {
+        const QList<int> &ids = m_byWorth.at(w);
+        if (ids.isEmpty())
+            continue;
+        /*
+          The intersection cannot be worth more than the smaller matrix, and
+          the union not less than the bigger one. This leaves some room for
+          the difference in length, which is what makes the score:
+
+              (min + 1) << 10 >= threshold * (max + 2 * delta + 1)
+        */
+        int maxDelta = INT_MAX / 2;
+        if (threshold > 0) {
+            const int room = ((qMin(cmWorth, w) + 1) << 10) / threshold - qMax(cmWorth, w) - 1;
+            if (room < 0)
+                continue;
+            maxDelta = room / 2;
+        }
+        auto it = std::lower_bound(ids.cbegin(), ids.cend(), length - maxDelta,
+                                   [this](int id, int l) { return m_entries.at(id).length < l; });
+        for (; it != ids.cend(); ++it) {
+            const Entry &entry = m_entries.at(*it);
+            if (entry.length > length + maxDelta)
+                break;
+            const int score = similarityScore(cm, length, entry.matrix, entry.length);
+            if (score >= threshold)
+                result.append(qMakePair(*it, score));
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void addSimilarTextCandidate(CandidateList &candidates, QList<int> &scores,
+                             int maxCandidates, int score, const Candidate &candidate)
+{
+    if (candidates.size() == maxCandidates && score > scores[maxCandidates - 1] )
+        candidates.removeLast();
+
+    if (candidates.size() < maxCandidates && score >= textSimilarityThreshold) {
+        int i;
+        for (i = 0; i < candidates.size(); i++) {
+            if (score >= scores.at(i)) {
+                if (score == scores.at(i)) {
+                    if (candidates.at(i) == candidate)
+                        return;
+                } else {
+                    break;
+                }
+            }
+        }
+        scores.insert(i, score);
+        candidates.insert(i, candidate);
+    }
 }
 
 CandidateList similarTextHeuristicCandidates(const Translator *tor,
@@ -197,29 +294,11 @@ CandidateList similarTextHeuristicCandidates(const Translator *tor,
 
         QString s = mtm.sourceText();
         int score = matcher.getSimilarityScore(s);
+        if (score < textSimilarityThreshold)
+            continue;
 
-        if (candidates.size() == maxCandidates && score > scores[maxCandidates - 1] )
-            candidates.removeLast();
-
-        if (candidates.size() < maxCandidates && score >= textSimilarityThreshold) {
-            Candidate cand(mtm.context(), s, mtm.comment(), mtm.translation());
-
-            int i;
-            for (i = 0; i < candidates.size(); i++) {
-                if (score >= scores.at(i)) {
-                    if (score == scores.at(i)) {
-                        if (candidates.at(i) == cand)
-                            goto continue_outer_loop;
-                    } else {
-                        break;
-                    }
-                }
-            }
-            scores.insert(i, score);
-            candidates.insert(i, cand);
-        }
-        continue_outer_loop:
-        ;
+        addSimilarTextCandidate(candidates, scores, maxCandidates, score,
+                                Candidate(mtm.context(), s, mtm.comment(), mtm.translation()));
     }
     return candidates;
 }
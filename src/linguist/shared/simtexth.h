@@ -33,6 +33,7 @@ const int textSimilarityThreshold = 190;
 
 #include <QString>
 #include <QList>
+#include <QPair>
 
 QT_BEGIN_NAMESPACE
 
@@ -104,6 +105,47 @@ static inline int getSimilarityScore(const QString &str1, const QString &str2)
     return StringSimilarityMatcher(str1).getSimilarityScore(str2);
 }
 
+/**
+ * Indexes a list of texts, so the ones similar to some text can be found
+ * without computing the co-occurrence matrix of every text in the list
+ * for every lookup, and without even scoring the texts that cannot reach
+ * the threshold because of their length or number of co-occurrences.
+ * Texts are identified by the order in which they were added.
+ */
+class SimilarTextIndex {
+public:
+    void addText(const QString &text);
+    int count() const { return m_entries.size(); }
+
+    /**
+     * Returns the ids and scores of the texts which reach a similarity
+     * score of at least \a threshold with \a text, ordered by id. The scores
+     * are the ones getSimilarityScore() would return.
+     */
+    QList<QPair<int, int>> matches(const QString &text,
+                                   int threshold = textSimilarityThreshold) const;
+
+private:
+    struct Entry {
+        CoMatrix matrix;
+        int worth;
+        int length;
+    };
+    void ensureSorted() const;
+
+    QList<Entry> m_entries;
+    // The ids of the entries per worth, sorted by length
+    mutable QList<QList<int>> m_byWorth;
+    mutable bool m_sorted = true;
+};
+
+/**
+ * Adds \a candidate with \a score to the best \a maxCandidates
+ * \a candidates, which are ordered by their \a scores.
+ */
+void addSimilarTextCandidate(CandidateList &candidates, QList<int> &scores,
+                             int maxCandidates, int score, const Candidate &candidate);
+
 CandidateList similarTextHeuristicCandidates( const Translator *tor,
                                               const QString &text,
                                               int maxCandidates );
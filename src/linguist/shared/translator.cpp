@@ -53,7 +53,8 @@ QT_BEGIN_NAMESPACE
 
 Translator::Translator() :
     m_locationsType(AbsoluteLocations),
-    m_indexOk(true)
+    m_indexOk(true),
+    m_refIndexOk(false)
 {
 }
 
@@ -75,12 +76,52 @@ QList<Translator::FileFormat> &Translator::registeredFileFormats()
     return theFormats;
 }
 
+QString StringPool::intern(const QString &str, size_t *hash)
+{
+    auto it = m_strings.constFind(str);
+    if (it == m_strings.cend())
+        it = m_strings.insert(str, qHash(str));
+    if (hash)
+        *hash = it.value();
+    return it.key();
+}
+
+/*
+  Makes \a msg use the pooled copies of its context and file names, and
+  returns the hash of the context.
+*/
+size_t Translator::internStrings(TranslatorMessage &msg)
+{
+    size_t contextHash;
+    msg.setContext(m_stringPool.intern(msg.context(), &contextHash));
+    if (!msg.fileName().isEmpty()) {
+        const TranslatorMessage::References refs = msg.extraReferences();
+        msg.setFileName(m_stringPool.intern(msg.fileName()));
+        if (!refs.isEmpty()) {
+            TranslatorMessage::References interned;
+            interned.reserve(refs.size() + 1);
+            interned.append(TranslatorMessage::Reference(msg.fileName(), msg.lineNumber()));
+            for (const TranslatorMessage::Reference &ref : refs) {
+                interned.append(TranslatorMessage::Reference(m_stringPool.intern(ref.fileName()),
+                                                             ref.lineNumber()));
+            }
+            msg.setReferences(interned);
+        }
+    }
+    return contextHash;
+}
+
 void Translator::addIndex(int idx, const TranslatorMessage &msg) const
+{
+    addIndex(idx, msg, qHash(msg.context()));
+}
+
+void Translator::addIndex(int idx, const TranslatorMessage &msg, size_t contextHash) const
 {
     if (msg.sourceText().isEmpty() && msg.id().isEmpty()) {
         m_ctxCmtIdx[msg.context()] = idx;
     } else {
-        m_msgIdx[TMMKey(msg)] = idx;
+        m_msgIdx[TMMKey(msg, contextHash)] = idx;
         if (!msg.id().isEmpty())
             m_idMsgIdx[msg.id()] = idx;
     }
@@ -88,6 +129,7 @@ void Translator::addIndex(int idx, const TranslatorMessage &msg) const
 
 void Translator::delIndex(int idx) const
 {
+    m_refIndexOk = false;
     const TranslatorMessage &msg = m_messages.at(idx);
     if (msg.sourceText().isEmpty() && msg.id().isEmpty()) {
         m_ctxCmtIdx.remove(msg.context());
@@ -102,6 +144,7 @@ void Translator::ensureIndexed() const
 {
     if (!m_indexOk) {
         m_indexOk = true;
+        m_refIndexOk = false;
         m_ctxCmtIdx.clear();
         m_idMsgIdx.clear();
         m_msgIdx.clear();
@@ -110,6 +153,19 @@ void Translator::ensureIndexed() const
     }
 }
 
+void Translator::ensureReferencesIndexed() const
+{
+    ensureIndexed();
+    if (!m_refIndexOk) {
+        m_refIndexOk = true;
+        m_refIdx.clear();
+        for (int i = 0; i < m_messages.count(); i++) {
+            for (const auto &ref : m_messages.at(i).allReferences())
+                m_refIdx[qMakePair(ref.fileName(), ref.lineNumber())].append(i);
+        }
+    }
+}
+
 void Translator::replaceSorted(const TranslatorMessage &msg)
 {
     int index = find(msg);
@@ -117,8 +173,9 @@ void Translator::replaceSorted(const TranslatorMessage &msg)
         appendSorted(msg);
     } else {
         delIndex(index);
-        m_messages[index] = msg;
-        addIndex(index, msg);
+        TranslatorMessage &emsg = m_messages[index];
+        emsg = msg;
+        addIndex(index, emsg, internStrings(emsg));
     }
 }
 
@@ -160,7 +217,8 @@ void Translator::extend(const TranslatorMessage &msg, ConversionData &cd)
                                 : QString::fromLatin1("message '%1'").arg(makeMsgId(msg))));
             return;
         }
-        emsg.addReferenceUniq(msg.fileName(), msg.lineNumber());
+        emsg.addReferenceUniq(m_stringPool.intern(msg.fileName()), msg.lineNumber());
+        m_refIndexOk = false;
         if (!msg.extraComment().isEmpty()) {
             QString cmt = emsg.extraComment();
             if (!cmt.isEmpty()) {
@@ -179,13 +237,16 @@ void Translator::extend(const TranslatorMessage &msg, ConversionData &cd)
 
 void Translator::insert(int idx, const TranslatorMessage &msg)
 {
+    m_refIndexOk = false;
+    m_messages.insert(idx, msg);
+    TranslatorMessage &imsg = m_messages[idx];
+    const size_t contextHash = internStrings(imsg);
     if (m_indexOk) {
-        if (idx == m_messages.count())
-            addIndex(idx, msg);
+        if (idx == m_messages.count() - 1)
+            addIndex(idx, imsg, contextHash);
         else
             m_indexOk = false;
     }
-    m_messages.insert(idx, msg);
 }
 
 void Translator::append(const TranslatorMessage &msg)
@@ -369,12 +430,13 @@ void Translator::languageAndCountry(const QString &languageCode,
 int Translator::find(const TranslatorMessage &msg) const
 {
     ensureIndexed();
+    const TMMKey key(msg);
     if (msg.id().isEmpty())
-        return m_msgIdx.value(TMMKey(msg), -1);
+        return m_msgIdx.value(key, -1);
     int i = m_idMsgIdx.value(msg.id(), -1);
     if (i >= 0)
         return i;
-    i = m_msgIdx.value(TMMKey(msg), -1);
+    i = m_msgIdx.value(key, -1);
     // If both have an id, then find only by id.
     return i >= 0 && m_messages.at(i).id().isEmpty() ? i : -1;
 }
@@ -382,19 +444,26 @@ int Translator::find(const TranslatorMessage &msg) const
 int Translator::find(const QString &context,
     const QString &comment, const TranslatorMessage::References &refs) const
 {
+    // The first message with any of the references wins.
+    int found = -1;
     if (!refs.isEmpty()) {
-        for (auto it = m_messages.cbegin(), end = m_messages.cend(); it != end; ++it) {
-            if (it->context() == context && it->comment() == comment) {
-                for (const auto &itref : it->allReferences()) {
-                    for (const auto &ref : refs) {
-                        if (itref == ref)
-                            return it - m_messages.cbegin();
-                    }
+        ensureReferencesIndexed();
+        for (const auto &ref : refs) {
+            const auto it = m_refIdx.constFind(qMakePair(ref.fileName(), ref.lineNumber()));
+            if (it == m_refIdx.cend())
+                continue;
+            for (int i : *it) {
+                if (found >= 0 && i >= found)
+                    break;
+                const TranslatorMessage &msg = m_messages.at(i);
+                if (msg.context() == context && msg.comment() == comment) {
+                    found = i;
+                    break;
                 }
             }
         }
     }
-    return -1;
+    return found;
 }
 
 int Translator::find(const QString &context) const
@@ -501,6 +570,7 @@ void Translator::dropUiLines()
         }
         message.setReferences(refs);
     }
+    m_refIndexOk = false;
 }
 
 struct TranslatorMessageIdPtr {
@@ -621,23 +691,29 @@ Translator::Duplicates Translator::resolveDuplicates()
 
 void Translator::reportDuplicates(const Duplicates &dupes,
                                   const QString &fileName, bool verbose)
+{
+    reportDuplicates(dupes, fileName, verbose, std::cerr);
+}
+
+void Translator::reportDuplicates(const Duplicates &dupes,
+                                  const QString &fileName, bool verbose, std::ostream &out)
 {
     if (!dupes.byId.isEmpty() || !dupes.byContents.isEmpty()) {
-        std::cerr << "Warning: dropping duplicate messages in '" << qPrintable(fileName);
+        out << "Warning: dropping duplicate messages in '" << qPrintable(fileName);
         if (!verbose) {
-            std::cerr << "'\n(try -verbose for more info).\n";
+            out << "'\n(try -verbose for more info).\n";
         } else {
-            std::cerr << "':\n";
+            out << "':\n";
             for (int i : dupes.byId)
-                std::cerr << "\n* ID: " << qPrintable(message(i).id()) << std::endl;
+                out << "\n* ID: " << qPrintable(message(i).id()) << std::endl;
             for (int j : dupes.byContents) {
                 const TranslatorMessage &msg = message(j);
-                std::cerr << "\n* Context: " << qPrintable(msg.context())
-                          << "\n* Source: " << qPrintable(msg.sourceText()) << std::endl;
+                out << "\n* Context: " << qPrintable(msg.context())
+                     << "\n* Source: " << qPrintable(msg.sourceText()) << std::endl;
                 if (!msg.comment().isEmpty())
-                    std::cerr << "* Comment: " << qPrintable(msg.comment()) << std::endl;
+                    out << "* Comment: " << qPrintable(msg.comment()) << std::endl;
             }
-            std::cerr << std::endl;
+            out << std::endl;
         }
     }
 }
@@ -653,9 +729,10 @@ void Translator::makeFileNamesAbsolute(const QDir &originalPath)
             QFileInfo fi (fileName);
             if (fi.isRelative())
                 fileName = originalPath.absoluteFilePath(fileName);
-            msg.addReference(fileName, ref.lineNumber());
+            msg.addReference(m_stringPool.intern(fileName), ref.lineNumber());
         }
     }
+    m_refIndexOk = false;
 }
 
 const QList<TranslatorMessage> &Translator::messages() const
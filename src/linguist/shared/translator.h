@@ -39,6 +39,8 @@
 #include <QString>
 #include <QSet>
 
+#include <iosfwd>
+
 
 QT_BEGIN_NAMESPACE
 
@@ -46,6 +48,7 @@ class FMT {
     Q_DECLARE_TR_FUNCTIONS(Linguist)
 };
 
+class QFile;
 class QIODevice;
 
 // A struct of "interesting" data passed to and from the load and save routines
@@ -58,6 +61,7 @@ public:
         m_sortContexts(false),
         m_noUiLines(false),
         m_idBased(false),
+        m_parserThreads(1),
         m_saveMode(SaveEverything)
     {}
 
@@ -81,6 +85,7 @@ public:
     QString m_sourceFileName;
     QString m_targetFileName;
     QString m_compileCommandsPath;
+    QString m_cacheDir; // CPP specific
     QStringList m_excludes;
     QDir m_sourceDir;
     QDir m_targetDir; // FIXME: TS specific
@@ -94,23 +99,42 @@ public:
     bool m_sortContexts;
     bool m_noUiLines;
     bool m_idBased;
+    int m_parserThreads; // CPP specific
     TranslatorSaveMode m_saveMode;
 };
 
 class TMMKey {
 public:
     TMMKey(const TranslatorMessage &msg)
-        { context = msg.context(); source = msg.sourceText(); comment = msg.comment(); }
+        : TMMKey(msg, qHash(msg.context())) {}
+    TMMKey(const TranslatorMessage &msg, size_t contextHash)
+        : context(msg.context()), source(msg.sourceText()), comment(msg.comment()),
+          hash(contextHash ^ qHash(source) ^ qHash(comment)) {}
     bool operator==(const TMMKey &o) const
-        { return context == o.context && source == o.source && comment == o.comment; }
+        { return hash == o.hash && context == o.context && source == o.source && comment == o.comment; }
     QString context, source, comment;
+    size_t hash; // computed once; QHash needs it again whenever it grows
 };
 Q_DECLARE_TYPEINFO(TMMKey, Q_MOVABLE_TYPE);
 inline size_t qHash(const TMMKey &key)
 {
-    return qHash(key.context) ^ qHash(key.source) ^ qHash(key.comment);
+    return key.hash;
 }
 
+/*
+  Shares the data of strings which occur in many messages, like context
+  and file names, and remembers their hashes.
+*/
+class StringPool
+{
+public:
+    QString intern(const QString &str, size_t *hash = nullptr);
+    int size() const { return m_strings.size(); }
+
+private:
+    QHash<QString, size_t> m_strings;
+};
+
 class Translator
 {
 public:
@@ -144,6 +168,8 @@ public:
     struct Duplicates { QSet<int> byId, byContents; };
     Duplicates resolveDuplicates();
     void reportDuplicates(const Duplicates &dupes, const QString &fileName, bool verbose);
+    void reportDuplicates(const Duplicates &dupes, const QString &fileName, bool verbose,
+                          std::ostream &out);
 
     QString languageCode() const { return m_language; }
     QString sourceLanguageCode() const { return m_sourceLanguage; }
@@ -206,9 +232,12 @@ public:
 
 private:
     void insert(int idx, const TranslatorMessage &msg);
+    size_t internStrings(TranslatorMessage &msg);
     void addIndex(int idx, const TranslatorMessage &msg) const;
+    void addIndex(int idx, const TranslatorMessage &msg, size_t contextHash) const;
     void delIndex(int idx) const;
     void ensureIndexed() const;
+    void ensureReferencesIndexed() const;
 
     typedef QList<TranslatorMessage> TMM;       // int stores the sequence position.
 
@@ -228,11 +257,15 @@ private:
     QString m_sourceLanguage;
     QStringList m_dependencies;
     ExtraData m_extra;
+    StringPool m_stringPool;
 
     mutable bool m_indexOk;
     mutable QHash<QString, int> m_ctxCmtIdx;
     mutable QHash<QString, int> m_idMsgIdx;
     mutable QHash<TMMKey, int> m_msgIdx;
+    // Built on demand only, as it is needed for heuristic merging only
+    mutable bool m_refIndexOk;
+    mutable QHash<QPair<QString, int>, QList<int>> m_refIdx;
 };
 
 bool getNumerusInfo(QLocale::Language language, QLocale::Country country,
@@ -242,6 +275,51 @@ QString getNumerusInfoString();
 
 bool saveQM(const Translator &translator, QIODevice &dev, ConversionData &cd);
 
+/*
+  Reads the messages of a QM file one at a time, decoding each only when it
+  is asked for. Files are memory-mapped where possible, so the device
+  must outlive the reader.
+*/
+class QMReader
+{
+public:
+    QMReader();
+    ~QMReader();
+
+    bool open(QIODevice &dev, ConversionData &cd);
+    void close();
+
+    QString languageCode() const { return m_language; }
+    QStringList dependencies() const { return m_dependencies; }
+    int messageCount() const { return m_messageCount; }
+
+    bool atEnd() const { return m_current >= m_messageCount; }
+    bool readMessage(TranslatorMessage *msg);
+    // Reports decoding errors of the messages read so far
+    bool finish(ConversionData &cd) const;
+
+private:
+    Q_DISABLE_COPY(QMReader)
+
+    QFile *m_file;
+    const uchar *m_mapped;
+    QByteArray m_data;
+    const uchar *m_messageArray;
+    uint m_messageLength;
+    const uchar *m_offsetArray;
+    int m_messageCount;
+    int m_current;
+    bool m_guessPlurals;
+    bool m_utf8Fail;
+    bool m_formatError;
+    QString m_language;
+    QStringList m_dependencies;
+    // Messages may omit what they share with their predecessor
+    QString m_context;
+    QString m_sourceText;
+    QString m_comment;
+};
+
 /*
   This is a quick hack. The proper way to handle this would be
   to extend Translator's interface.
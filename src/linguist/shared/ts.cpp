@@ -28,15 +28,21 @@
 
 #include "translator.h"
 
+#include <QtCore/QBuffer>
 #include <QtCore/QByteArray>
 #include <QtCore/QDebug>
+#include <QtCore/QFile>
 #include <QtCore/QRegularExpression>
+#include <QtCore/QStringDecoder>
 #include <QtCore/QTextStream>
+#include <QtCore/QVarLengthArray>
 
 #include <QtCore/QXmlStreamReader>
 
 #include <algorithm>
 
+#include <ctype.h>
+
 #define STRINGIFY_INTERNAL(x) #x
 #define STRINGIFY(x) STRINGIFY_INTERNAL(x)
 #define STRING(s) static QString str##s(QLatin1String(STRINGIFY(s)))
@@ -427,6 +433,713 @@ bool TSReader::read(Translator &translator)
     return true;
 }
 
+/*
+  A fast path for loading TS files, see loadTS().
+
+  TS files use a small and regular subset of XML. TSFastReader parses that subset
+  directly on the UTF-8 bytes of the (usually memory-mapped) file, without creating
+  strings for markup, and shares the strings of context names, location file names
+  and extra tags between messages. As soon as it meets anything it does not handle
+  exactly like TSReader (other encodings, CDATA sections, unknown entities, comments
+  within text, malformed markup, ...), it gives up, and loadTS() falls back to
+  TSReader, which also takes care of reporting errors.
+*/
+class TSFastReader
+{
+public:
+    TSFastReader(const char *data, qsizetype size)
+        : m_pos(data), m_end(data + size),
+          m_decoder(QStringConverter::Utf8,
+                    QStringConverter::Flag::Stateless | QStringConverter::Flag::ConvertInitialBom)
+    {}
+
+    bool read(Translator &translator);
+
+private:
+    enum TokenType { StartElement, EndElement, Characters, Comment, Invalid };
+
+    struct Attribute {
+        QByteArray name;
+        QByteArray value;
+    };
+
+    TokenType readNext();
+    bool readProlog();
+    bool readEpilog();
+    bool skipComment();
+    bool readName();
+
+    bool elementStarts(const char *name) const
+    {
+        return m_token == StartElement && m_name == name;
+    }
+    bool isWhiteSpace() const;
+    QByteArray attribute(const char *name) const;
+    bool attributeEquals(const char *name, const char *value);
+
+    bool decode(QByteArray raw, bool isAttribute, QString *result);
+    bool intern(const QByteArray &raw, bool isAttribute, QString *result);
+    bool readContents(QString *result);
+    bool readTransContents(QString *result);
+    bool readElementText(QString *result);
+    bool skipElement();
+
+    const char *m_pos;
+    const char *m_end;
+    TokenType m_token = Invalid;
+    QByteArray m_name;
+    QByteArray m_text;
+    QVarLengthArray<Attribute, 8> m_attributes;
+    QVarLengthArray<QByteArray, 8> m_openElements;
+    bool m_pendingEnd = false;
+    QStringDecoder m_decoder;
+    QByteArray m_buffer;
+    QHash<QByteArray, QString> m_strings;
+};
+
+static bool isXmlSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool startsWith(const char *pos, const char *end, const char *str)
+{
+    const qsizetype len = qstrlen(str);
+    return end - pos >= len && !memcmp(pos, str, len);
+}
+
+// Returns the tail of raw data without copying it
+static QByteArray rawSlice(const QByteArray &raw, int pos)
+{
+    return QByteArray::fromRawData(raw.constData() + pos, raw.size() - pos);
+}
+
+bool TSFastReader::skipComment()
+{
+    // at "<!--"
+    for (const char *p = m_pos + 4; p + 3 <= m_end; ++p) {
+        if (p[0] == '-' && p[1] == '-') {
+            if (p[2] != '>')
+                return false;
+            m_pos = p + 3;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TSFastReader::readName()
+{
+    const char *start = m_pos;
+    while (m_pos < m_end && !isXmlSpace(*m_pos) && *m_pos != '/' && *m_pos != '>'
+           && *m_pos != '=' && *m_pos != '<' && *m_pos != '"' && *m_pos != '\'') {
+        ++m_pos;
+    }
+    m_name = QByteArray::fromRawData(start, m_pos - start);
+    return !m_name.isEmpty();
+}
+
+TSFastReader::TokenType TSFastReader::readNext()
+{
+    if (m_pendingEnd) {
+        // the end of an empty element <name/>
+        m_pendingEnd = false;
+        m_name = m_openElements.takeLast();
+        return m_token = EndElement;
+    }
+    if (m_pos >= m_end)
+        return m_token = Invalid;
+
+    if (*m_pos != '<') {
+        const char *start = m_pos;
+        m_pos = static_cast<const char *>(memchr(m_pos, '<', m_end - m_pos));
+        if (!m_pos)
+            return m_token = Invalid;
+        m_text = QByteArray::fromRawData(start, m_pos - start);
+        return m_token = Characters;
+    }
+
+    if (startsWith(m_pos, m_end, "<!--"))
+        return m_token = skipComment() ? Comment : Invalid;
+    if (startsWith(m_pos, m_end, "</")) {
+        m_pos += 2;
+        if (!readName() || m_openElements.isEmpty() || m_openElements.last() != m_name)
+            return m_token = Invalid;
+        while (m_pos < m_end && isXmlSpace(*m_pos))
+            ++m_pos;
+        if (m_pos >= m_end || *m_pos != '>')
+            return m_token = Invalid;
+        ++m_pos;
+        m_openElements.removeLast();
+        return m_token = EndElement;
+    }
+
+    // start tag; anything else (CDATA, processing instructions) is not expected in TS files
+    ++m_pos;
+    if (!readName() || m_name.at(0) == '!' || m_name.at(0) == '?')
+        return m_token = Invalid;
+    m_attributes.clear();
+    forever {
+        const char *beforeSpace = m_pos;
+        while (m_pos < m_end && isXmlSpace(*m_pos))
+            ++m_pos;
+        if (m_pos >= m_end)
+            return m_token = Invalid;
+        if (*m_pos == '>') {
+            ++m_pos;
+            break;
+        }
+        if (*m_pos == '/') {
+            if (m_pos + 1 >= m_end || m_pos[1] != '>')
+                return m_token = Invalid;
+            m_pos += 2;
+            m_pendingEnd = true;
+            break;
+        }
+        const QByteArray elementName = m_name;
+        if (m_pos == beforeSpace || !readName())
+            return m_token = Invalid;
+        Attribute attr;
+        attr.name = m_name;
+        m_name = elementName;
+        while (m_pos < m_end && isXmlSpace(*m_pos))
+            ++m_pos;
+        if (m_pos >= m_end || *m_pos != '=')
+            return m_token = Invalid;
+        ++m_pos;
+        while (m_pos < m_end && isXmlSpace(*m_pos))
+            ++m_pos;
+        if (m_pos >= m_end || (*m_pos != '"' && *m_pos != '\''))
+            return m_token = Invalid;
+        const char quote = *m_pos++;
+        const char *valueEnd = static_cast<const char *>(memchr(m_pos, quote, m_end - m_pos));
+        if (!valueEnd)
+            return m_token = Invalid;
+        attr.value = QByteArray::fromRawData(m_pos, valueEnd - m_pos);
+        if (attr.value.contains('<'))
+            return m_token = Invalid;
+        for (const Attribute &other : qAsConst(m_attributes)) {
+            if (other.name == attr.name)
+                return m_token = Invalid;
+        }
+        m_attributes.append(attr);
+        m_pos = valueEnd + 1;
+    }
+    m_openElements.append(m_name);
+    return m_token = StartElement;
+}
+
+bool TSFastReader::isWhiteSpace() const
+{
+    if (m_token != Characters)
+        return false;
+    for (char c : m_text) {
+        if (!isXmlSpace(c))
+            return false;
+    }
+    return true;
+}
+
+QByteArray TSFastReader::attribute(const char *name) const
+{
+    for (const Attribute &attr : m_attributes) {
+        if (attr.name == name)
+            return attr.value;
+    }
+    return QByteArray();
+}
+
+bool TSFastReader::attributeEquals(const char *name, const char *value)
+{
+    const QByteArray raw = attribute(name);
+    if (!raw.contains('&') && !raw.contains('\t') && !raw.contains('\n') && !raw.contains('\r'))
+        return raw == value;
+    QString decoded;
+    return decode(raw, true, &decoded) && decoded == QLatin1String(value);
+}
+
+static void appendUtf8(QByteArray *out, uint ucs)
+{
+    if (ucs < 0x80) {
+        out->append(char(ucs));
+    } else if (ucs < 0x800) {
+        out->append(char(0xc0 | (ucs >> 6)));
+        out->append(char(0x80 | (ucs & 0x3f)));
+    } else if (ucs < 0x10000) {
+        out->append(char(0xe0 | (ucs >> 12)));
+        out->append(char(0x80 | ((ucs >> 6) & 0x3f)));
+        out->append(char(0x80 | (ucs & 0x3f)));
+    } else {
+        out->append(char(0xf0 | (ucs >> 18)));
+        out->append(char(0x80 | ((ucs >> 12) & 0x3f)));
+        out->append(char(0x80 | ((ucs >> 6) & 0x3f)));
+        out->append(char(0x80 | (ucs & 0x3f)));
+    }
+}
+
+/*
+  Converts raw character data to a string, like QXmlStreamReader does:
+  entity and character references are resolved, line ends are normalized,
+  and in attribute values, white space is normalized to spaces.
+*/
+bool TSFastReader::decode(QByteArray raw, bool isAttribute, QString *result)
+{
+    if (raw.isEmpty()) {
+        result->clear();
+        return true;
+    }
+
+    bool plain = true;
+    for (char c : qAsConst(raw)) {
+        if (c == '&' || c == '\r' || (isAttribute && (c == '\t' || c == '\n'))) {
+            plain = false;
+        } else if (uchar(c) < 0x20 && c != '\t' && c != '\n') {
+            return false; // not allowed in XML
+        }
+    }
+
+    if (!plain) {
+        m_buffer.clear();
+        m_buffer.reserve(raw.size());
+        for (const char *p = raw.constBegin(), *end = raw.constEnd(); p < end; ++p) {
+            const char c = *p;
+            if (c == '&') {
+                const char *semicolon = static_cast<const char *>(memchr(p, ';', end - p));
+                if (!semicolon)
+                    return false;
+                const QByteArray entity = QByteArray::fromRawData(p + 1, semicolon - p - 1);
+                if (entity == "lt") {
+                    m_buffer.append('<');
+                } else if (entity == "gt") {
+                    m_buffer.append('>');
+                } else if (entity == "amp") {
+                    m_buffer.append('&');
+                } else if (entity == "quot") {
+                    m_buffer.append('"');
+                } else if (entity == "apos") {
+                    m_buffer.append('\'');
+                } else if (entity.size() > 1 && entity.at(0) == '#') {
+                    const bool hex = entity.at(1) == 'x';
+                    const QByteArray digits = rawSlice(entity, hex ? 2 : 1);
+                    if (digits.isEmpty() || digits.size() > 8)
+                        return false;
+                    for (char d : digits) {
+                        if (!isxdigit(uchar(d)) || (!hex && !isdigit(uchar(d))))
+                            return false;
+                    }
+                    bool ok;
+                    const uint ucs = digits.toUInt(&ok, hex ? 16 : 10);
+                    if (!ok || !(ucs == 0x9 || ucs == 0xa || ucs == 0xd
+                                 || (ucs >= 0x20 && ucs <= 0xd7ff)
+                                 || (ucs >= 0xe000 && ucs <= 0xfffd)
+                                 || (ucs >= 0x10000 && ucs <= 0x10ffff))) {
+                        return false;
+                    }
+                    appendUtf8(&m_buffer, ucs);
+                } else {
+                    return false; // would need a DTD
+                }
+                p = semicolon;
+            } else if (c == '\r') {
+                if (p + 1 < end && p[1] == '\n')
+                    ++p;
+                m_buffer.append(isAttribute ? ' ' : '\n');
+            } else if (isAttribute && (c == '\t' || c == '\n')) {
+                m_buffer.append(' ');
+            } else {
+                m_buffer.append(c);
+            }
+        }
+        raw = m_buffer;
+    }
+
+    *result = m_decoder(raw);
+    if (m_decoder.hasError()) {
+        m_decoder.resetState();
+        return false;
+    }
+    return true;
+}
+
+/*
+  Like decode(), but returns the same string for the same raw data, so messages
+  share the strings of their contexts and file names.
+*/
+bool TSFastReader::intern(const QByteArray &raw, bool isAttribute, QString *result)
+{
+    const auto it = m_strings.constFind(raw);
+    if (it != m_strings.cend()) {
+        *result = *it;
+        return true;
+    }
+    if (!decode(raw, isAttribute, result))
+        return false;
+    m_strings.insert(raw, *result);
+    return true;
+}
+
+// Mirrors TSReader::readContents()
+bool TSFastReader::readContents(QString *result)
+{
+    result->clear();
+    QString chunk;
+    forever {
+        switch (readNext()) {
+        case EndElement:
+            return true;
+        case Characters:
+            if (!decode(m_text, false, &chunk))
+                return false;
+            if (result->isEmpty())
+                *result = chunk;
+            else
+                *result += chunk;
+            break;
+        case StartElement:
+            if (m_name != "byte")
+                return false;
+            // <byte value="...">
+            if (!decode(attribute("value"), true, &chunk))
+                return false;
+            *result += byteValue(chunk);
+            if (readNext() != EndElement)
+                return false;
+            break;
+        default:
+            return false;
+        }
+    }
+}
+
+// Mirrors TSReader::readTransContents()
+bool TSFastReader::readTransContents(QString *result)
+{
+    if (!attributeEquals("variants", "yes"))
+        return readContents(result);
+
+    result->clear();
+    QString variant;
+    forever {
+        readNext();
+        if (m_token == EndElement) {
+            return true;
+        } else if (isWhiteSpace()) {
+            // ignore these, just whitespace
+        } else if (elementStarts("lengthvariant")) {
+            if (!result->isEmpty())
+                *result += QChar(Translator::BinaryVariantSeparator);
+            if (!readContents(&variant))
+                return false;
+            *result += variant;
+        } else {
+            return false;
+        }
+    }
+}
+
+// Mirrors QXmlStreamReader::readElementText()
+bool TSFastReader::readElementText(QString *result)
+{
+    if (readNext() == EndElement) {
+        result->clear();
+        return true;
+    }
+    const QByteArray text = m_text;
+    if (m_token != Characters || readNext() != EndElement)
+        return false;
+    return intern(text, false, result);
+}
+
+// Skips the current element, accepting only text and comments in it.
+bool TSFastReader::skipElement()
+{
+    forever {
+        switch (readNext()) {
+        case EndElement:
+            return true;
+        case Characters:
+        case Comment:
+            break;
+        default:
+            return false;
+        }
+    }
+}
+
+bool TSFastReader::readProlog()
+{
+    if (startsWith(m_pos, m_end, "\xef\xbb\xbf"))
+        m_pos += 3;
+    if (startsWith(m_pos, m_end, "<?xml")) {
+        const char *close = static_cast<const char *>(memchr(m_pos, '>', m_end - m_pos));
+        if (!close || close[-1] != '?')
+            return false;
+        const QByteArray decl(m_pos, close - m_pos);
+        const int encoding = decl.indexOf("encoding");
+        if (encoding >= 0) {
+            const QByteArray value = decl.mid(encoding + 8).trimmed();
+            if (!value.startsWith('='))
+                return false;
+            const QByteArray quoted = value.mid(1).trimmed();
+            if (quoted.size() < 7 || quoted.mid(1, 5).toLower() != "utf-8"
+                || quoted.at(6) != quoted.at(0)) {
+                return false;
+            }
+        }
+        m_pos = close + 1;
+    }
+    forever {
+        while (m_pos < m_end && isXmlSpace(*m_pos))
+            ++m_pos;
+        if (startsWith(m_pos, m_end, "<!--")) {
+            if (!skipComment())
+                return false;
+        } else if (startsWith(m_pos, m_end, "<!DOCTYPE")) {
+            const char *close = static_cast<const char *>(memchr(m_pos, '>', m_end - m_pos));
+            if (!close || memchr(m_pos, '[', close - m_pos))
+                return false; // no internal subsets, please
+            m_pos = close + 1;
+        } else {
+            return m_pos < m_end && *m_pos == '<';
+        }
+    }
+}
+
+bool TSFastReader::readEpilog()
+{
+    forever {
+        while (m_pos < m_end && isXmlSpace(*m_pos))
+            ++m_pos;
+        if (m_pos == m_end)
+            return true;
+        if (!startsWith(m_pos, m_end, "<!--") || !skipComment())
+            return false;
+    }
+}
+
+// Mirrors TSReader::read()
+bool TSFastReader::read(Translator &translator)
+{
+    if (!readProlog() || readNext() != StartElement || m_name != "TS")
+        return false;
+
+    QList<TranslatorMessage> messages;
+    Translator::ExtraData extras;
+    QHash<QString, int> currentLine;
+    QString currentFile;
+    bool maybeRelative = false, maybeAbsolute = false;
+    bool haveChildren = false;
+    bool haveDependencies = false;
+    QStringList dependencies;
+    QString str;
+
+    QString language;
+    QString sourceLanguage;
+    if (!decode(attribute("language"), true, &language)
+        || !decode(attribute("sourcelanguage"), true, &sourceLanguage)) {
+        return false;
+    }
+
+    forever {
+        readNext();
+        if (m_token == EndElement) {
+            // </TS> found
+            break;
+        } else if (m_token == Invalid) {
+            return false;
+        }
+        haveChildren = true;
+        if (isWhiteSpace() || m_token == Comment) {
+            // ignore these
+        } else if (m_token == StartElement && m_name.startsWith("extra-")) {
+            // <extra-...>
+            QString tag;
+            if (!intern(rawSlice(m_name, 6), false, &tag) || !readContents(&str))
+                return false;
+            extras.insert(tag, str);
+        } else if (elementStarts("dependencies")) {
+            // <dependencies>
+            haveDependencies = true;
+            dependencies.clear();
+            forever {
+                readNext();
+                if (m_token == EndElement) {
+                    break;
+                } else if (elementStarts("dependency")) {
+                    if (!decode(attribute("catalog"), true, &str) || !skipElement())
+                        return false;
+                    dependencies.append(str);
+                } else if (!isWhiteSpace() && m_token != Comment) {
+                    return false;
+                }
+            }
+        } else if (elementStarts("context")) {
+            // <context>
+            QString context;
+            forever {
+                readNext();
+                if (m_token == EndElement) {
+                    // </context> found
+                    break;
+                } else if (isWhiteSpace() || m_token == Comment) {
+                    // ignore these
+                } else if (elementStarts("name")) {
+                    if (!readElementText(&context))
+                        return false;
+                } else if (elementStarts("message")) {
+                    // <message>
+                    TranslatorMessage::References refs;
+                    QString currentMsgFile = currentFile;
+
+                    TranslatorMessage msg;
+                    if (!decode(attribute("id"), true, &str))
+                        return false;
+                    msg.setId(str);
+                    msg.setContext(context);
+                    msg.setType(TranslatorMessage::Finished);
+                    msg.setPlural(attributeEquals("numerus", "yes"));
+                    forever {
+                        readNext();
+                        if (m_token == EndElement) {
+                            // </message> found
+                            msg.setReferences(refs);
+                            messages.append(msg);
+                            break;
+                        } else if (isWhiteSpace() || m_token == Comment) {
+                            // ignore these
+                        } else if (m_token != StartElement) {
+                            return false;
+                        } else if (m_name == "source") {
+                            if (!readContents(&str))
+                                return false;
+                            msg.setSourceText(str);
+                        } else if (m_name == "oldsource") {
+                            if (!readContents(&str))
+                                return false;
+                            msg.setOldSourceText(str);
+                        } else if (m_name == "oldcomment") {
+                            if (!readContents(&str))
+                                return false;
+                            msg.setOldComment(str);
+                        } else if (m_name == "extracomment") {
+                            if (!readContents(&str))
+                                return false;
+                            msg.setExtraComment(str);
+                        } else if (m_name == "translatorcomment") {
+                            if (!readContents(&str))
+                                return false;
+                            msg.setTranslatorComment(str);
+                        } else if (m_name == "location") {
+                            // <location/>
+                            maybeAbsolute = true;
+                            QString fileName;
+                            if (!intern(attribute("filename"), true, &fileName))
+                                return false;
+                            if (fileName.isEmpty()) {
+                                fileName = currentMsgFile;
+                                maybeRelative = true;
+                            } else {
+                                if (refs.isEmpty())
+                                    currentFile = fileName;
+                                currentMsgFile = fileName;
+                            }
+                            QString lin;
+                            if (!decode(attribute("line"), true, &lin))
+                                return false;
+                            if (lin.isEmpty()) {
+                                refs.append(TranslatorMessage::Reference(fileName, -1));
+                            } else {
+                                bool bOK;
+                                int lineNo = lin.toInt(&bOK);
+                                if (bOK) {
+                                    if (lin.startsWith(QLatin1Char('+')) || lin.startsWith(QLatin1Char('-'))) {
+                                        lineNo = (currentLine[fileName] += lineNo);
+                                        maybeRelative = true;
+                                    }
+                                    refs.append(TranslatorMessage::Reference(fileName, lineNo));
+                                }
+                            }
+                            if (!readContents(&str))
+                                return false;
+                        } else if (m_name == "comment") {
+                            if (!readContents(&str))
+                                return false;
+                            msg.setComment(str);
+                        } else if (m_name == "userdata") {
+                            if (!readContents(&str))
+                                return false;
+                            msg.setUserData(str);
+                        } else if (m_name == "translation") {
+                            // <translation>
+                            if (attributeEquals("type", "unfinished"))
+                                msg.setType(TranslatorMessage::Unfinished);
+                            else if (attributeEquals("type", "vanished"))
+                                msg.setType(TranslatorMessage::Vanished);
+                            else if (attributeEquals("type", "obsolete"))
+                                msg.setType(TranslatorMessage::Obsolete);
+                            if (msg.isPlural()) {
+                                QStringList translations;
+                                forever {
+                                    readNext();
+                                    if (m_token == EndElement) {
+                                        break;
+                                    } else if (isWhiteSpace()) {
+                                        // ignore these, just whitespace
+                                    } else if (elementStarts("numerusform")) {
+                                        if (!readTransContents(&str))
+                                            return false;
+                                        translations.append(str);
+                                    } else {
+                                        return false;
+                                    }
+                                }
+                                msg.setTranslations(translations);
+                            } else {
+                                if (!readTransContents(&str))
+                                    return false;
+                                msg.setTranslation(str);
+                            }
+                            // </translation>
+                        } else if (m_name.startsWith("extra-")) {
+                            // <extra-...>
+                            QString tag;
+                            if (!intern(rawSlice(m_name, 6), false, &tag) || !readContents(&str))
+                                return false;
+                            msg.setExtra(tag, str);
+                        } else {
+                            return false;
+                        }
+                    }
+                    // </message>
+                } else {
+                    return false;
+                }
+            }
+            // </context>
+        } else {
+            return false;
+        }
+    }
+    if (!readEpilog())
+        return false;
+
+    // Only now that the whole file is known to be fine, touch the translator.
+    translator.setLanguageCode(language);
+    translator.setSourceLanguageCode(sourceLanguage);
+    for (auto it = extras.cbegin(), end = extras.cend(); it != end; ++it)
+        translator.setExtra(it.key(), it.value());
+    if (haveDependencies)
+        translator.setDependencies(dependencies);
+    for (const TranslatorMessage &msg : qAsConst(messages))
+        translator.append(msg);
+    if (haveChildren) {
+        translator.setLocationsType(maybeRelative ? Translator::RelativeLocations :
+                                    maybeAbsolute ? Translator::AbsoluteLocations :
+                                                    Translator::NoLocations);
+    }
+    return true;
+}
+
 static QString numericEntity(int ch)
 {
     return QString(ch <= 0x20 ? QLatin1String("<byte value=\"x%1\"/>")
@@ -664,12 +1377,37 @@ bool saveTS(const Translator &translator, QIODevice &dev, ConversionData &cd)
     return result;
 }
 
-bool loadTS(Translator &translator, QIODevice &dev, ConversionData &cd)
+bool loadTSWithXmlReader(Translator &translator, QIODevice &dev, ConversionData &cd)
 {
     TSReader reader(dev, cd);
     return reader.read(translator);
 }
 
+bool loadTS(Translator &translator, QIODevice &dev, ConversionData &cd)
+{
+    // Map the file if possible, so the fast reader does not need a copy of it.
+    QByteArray data;
+    QFile *file = qobject_cast<QFile *>(&dev);
+    const uchar *mapped = nullptr;
+    if (file && file->pos() == 0 && file->size() > 0)
+        mapped = file->map(0, file->size());
+    if (mapped)
+        data = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), file->size());
+    else
+        data = dev.readAll();
+
+    TSFastReader fastReader(data.constData(), data.size());
+    bool ok = fastReader.read(translator);
+    if (!ok) {
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+        ok = loadTSWithXmlReader(translator, buffer, cd);
+    }
+    if (mapped)
+        file->unmap(const_cast<uchar *>(mapped));
+    return ok;
+}
+
 int initTS()
 {
     Translator::FileFormat format;
@@ -0,0 +1,352 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "binaryindex.h"
+
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qsavefile.h>
+
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+namespace BinaryIndex {
+
+static const char magic[8] = { 'Q', 'D', 'O', 'C', 'B', 'I', 'D', 'X' };
+static const quint32 formatVersion = 1;
+static const quint32 byteOrderMark = 0x01020304;
+
+static_assert(sizeof(Header) % alignof(quint64) == 0, "Header must keep the tables aligned");
+
+/*!
+  Returns the name of the binary index file that belongs to the
+  XML index file \a indexFile.
+ */
+QString fileName(const QString &indexFile)
+{
+    return indexFile + QLatin1String(".bin");
+}
+
+/*!
+  Writes the element tree of the XML index \a xmlIndex to the binary
+  index file \a fileName. \a xmlSize is the size of the XML index file
+  on disk; readers use it to reject a binary index that does not
+  belong to the XML index next to it. Returns \c true on success.
+
+  The XML index is parsed once here, so that the modules that depend
+  on it do not have to.
+ */
+bool write(const QString &fileName, const QByteArray &xmlIndex, qint64 xmlSize)
+{
+    QList<String> strings;
+    QList<Element> elements;
+    QList<Attribute> attributes;
+    QString chars;
+    QHash<QString, quint32> ids;
+
+    auto intern = [&](QStringView s) {
+        const QString key = s.toString();
+        const auto it = ids.constFind(key);
+        if (it != ids.constEnd())
+            return it.value();
+        const auto id = quint32(strings.size());
+        strings.append(String { quint32(chars.size()), quint32(s.size()) });
+        chars.append(s);
+        ids.insert(key, id);
+        return id;
+    };
+
+    QXmlStreamReader reader(xmlIndex);
+    reader.setNamespaceProcessing(false);
+    QList<qsizetype> openElements;
+    while (!reader.atEnd()) {
+        switch (reader.readNext()) {
+        case QXmlStreamReader::StartElement: {
+            Element element;
+            element.name = intern(reader.name());
+            element.firstAttribute = quint32(attributes.size());
+            const QXmlStreamAttributes xmlAttributes = reader.attributes();
+            for (const auto &attribute : xmlAttributes)
+                attributes.append(Attribute { intern(attribute.qualifiedName()),
+                                              intern(attribute.value()) });
+            element.attributeCount = quint32(xmlAttributes.size());
+            element.end = 0;
+            openElements.append(elements.size());
+            elements.append(element);
+            break;
+        }
+        case QXmlStreamReader::EndElement:
+            elements[openElements.takeLast()].end = quint32(elements.size());
+            break;
+        default:
+            break;
+        }
+    }
+    if (reader.hasError() || elements.isEmpty())
+        return false;
+
+    Header header;
+    memcpy(header.magic, magic, sizeof(magic));
+    header.version = formatVersion;
+    header.byteOrder = byteOrderMark;
+    header.xmlSize = quint64(xmlSize);
+    header.stringCount = quint32(strings.size());
+    header.elementCount = quint32(elements.size());
+    header.attributeCount = quint32(attributes.size());
+    header.charCount = quint32(chars.size());
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(strings.constData()),
+               strings.size() * sizeof(String));
+    file.write(reinterpret_cast<const char *>(elements.constData()),
+               elements.size() * sizeof(Element));
+    file.write(reinterpret_cast<const char *>(attributes.constData()),
+               attributes.size() * sizeof(Attribute));
+    file.write(reinterpret_cast<const char *>(chars.constData()), chars.size() * sizeof(QChar));
+    return file.commit();
+}
+
+} // namespace BinaryIndex
+
+/*!
+  \class BinaryIndexAttributes
+
+  The attributes of an element in a binary index. The values are
+  views into the mapped file; they are only valid as long as the
+  BinaryIndexReader is.
+ */
+
+/*!
+  Returns \c true if there is an attribute called \a name.
+ */
+bool BinaryIndexAttributes::hasAttribute(QLatin1String name) const
+{
+    for (auto it = m_begin; it != m_end; ++it) {
+        if (m_reader->string(it->name) == name)
+            return true;
+    }
+    return false;
+}
+
+/*!
+  Returns the value of the attribute \a name, or an empty view if
+  there is no such attribute.
+ */
+QStringView BinaryIndexAttributes::value(QLatin1String name) const
+{
+    for (auto it = m_begin; it != m_end; ++it) {
+        if (m_reader->string(it->name) == name)
+            return m_reader->string(it->value);
+    }
+    return QStringView();
+}
+
+/*!
+  \class BinaryIndexReader
+
+  Reads a binary index file written by BinaryIndex::write(). The file
+  is memory mapped and walked in place; strings are only turned into
+  QString objects when the caller keeps them. The reader provides the
+  subset of the QXmlStreamReader API that QDocIndexFiles uses, so that
+  both formats are read by the same code.
+ */
+
+/*!
+  Maps the binary index \a fileName. Returns \c false if the file does
+  not exist, is older than or does not match the XML index \a xmlIndex,
+  or is not a valid binary index. The caller then reads the XML index.
+ */
+bool BinaryIndexReader::open(const QString &fileName, const QFileInfo &xmlIndex)
+{
+    using namespace BinaryIndex;
+
+    const QFileInfo info(fileName);
+    if (!info.exists() || info.lastModified() < xmlIndex.lastModified())
+        return false;
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+    const qint64 size = m_file.size();
+    if (size < qint64(sizeof(Header)))
+        return false;
+    const uchar *data = m_file.map(0, size);
+    if (!data)
+        return false;
+
+    const auto *header = reinterpret_cast<const Header *>(data);
+    if (memcmp(header->magic, magic, sizeof(magic)) != 0 || header->version != formatVersion
+        || header->byteOrder != byteOrderMark || header->xmlSize != quint64(xmlIndex.size())) {
+        return false;
+    }
+    const qint64 expectedSize = qint64(sizeof(Header))
+            + qint64(header->stringCount) * qint64(sizeof(String))
+            + qint64(header->elementCount) * qint64(sizeof(Element))
+            + qint64(header->attributeCount) * qint64(sizeof(Attribute))
+            + qint64(header->charCount) * qint64(sizeof(char16_t));
+    if (size != expectedSize)
+        return false;
+
+    m_header = header;
+    m_strings = reinterpret_cast<const String *>(data + sizeof(Header));
+    m_elements = reinterpret_cast<const Element *>(m_strings + header->stringCount);
+    m_attributes = reinterpret_cast<const Attribute *>(m_elements + header->elementCount);
+    m_chars = reinterpret_cast<const char16_t *>(m_attributes + header->attributeCount);
+    m_token = QXmlStreamReader::NoToken;
+    m_current = 0;
+    m_openElements.clear();
+    return validate();
+}
+
+/*!
+  Checks that all the offsets and indexes in the mapped file are in
+  range and that the elements nest, so that the reader never needs to
+  check them again.
+ */
+bool BinaryIndexReader::validate() const
+{
+    const BinaryIndex::Header &header = *m_header;
+    for (quint32 i = 0; i < header.stringCount; ++i) {
+        const BinaryIndex::String &s = m_strings[i];
+        if (s.offset > header.charCount || s.size > header.charCount - s.offset)
+            return false;
+    }
+    for (quint32 i = 0; i < header.attributeCount; ++i) {
+        const BinaryIndex::Attribute &a = m_attributes[i];
+        if (a.name >= header.stringCount || a.value >= header.stringCount)
+            return false;
+    }
+    if (header.elementCount == 0 || m_elements[0].end != header.elementCount)
+        return false;
+    QList<quint32> ends;
+    for (quint32 i = 0; i < header.elementCount; ++i) {
+        const BinaryIndex::Element &e = m_elements[i];
+        while (!ends.isEmpty() && ends.last() == i)
+            ends.removeLast();
+        if (e.name >= header.stringCount || e.firstAttribute > header.attributeCount
+            || e.attributeCount > header.attributeCount - e.firstAttribute) {
+            return false;
+        }
+        const quint32 limit = ends.isEmpty() ? header.elementCount : ends.last();
+        if (e.end <= i || e.end > limit)
+            return false;
+        ends.append(e.end);
+    }
+    return true;
+}
+
+/*!
+  Moves to the next start or end element and returns its token type,
+  like QXmlStreamReader::readNext().
+ */
+QXmlStreamReader::TokenType BinaryIndexReader::readNext()
+{
+    switch (m_token) {
+    case QXmlStreamReader::NoToken:
+        m_current = 0;
+        m_openElements.append(m_current);
+        m_token = QXmlStreamReader::StartElement;
+        break;
+    case QXmlStreamReader::StartElement:
+        if (m_current + 1 < m_elements[m_current].end) {
+            ++m_current;
+            m_openElements.append(m_current);
+        } else {
+            m_openElements.removeLast();
+            m_token = QXmlStreamReader::EndElement;
+        }
+        break;
+    case QXmlStreamReader::EndElement:
+        if (m_openElements.isEmpty()) {
+            m_token = QXmlStreamReader::EndDocument;
+        } else {
+            const quint32 parent = m_openElements.last();
+            const quint32 next = m_elements[m_current].end;
+            if (next < m_elements[parent].end) {
+                m_current = next;
+                m_openElements.append(m_current);
+                m_token = QXmlStreamReader::StartElement;
+            } else {
+                m_current = parent;
+                m_openElements.removeLast();
+            }
+        }
+        break;
+    default:
+        m_token = QXmlStreamReader::Invalid;
+        break;
+    }
+    return m_token;
+}
+
+/*!
+  Moves to the next start element inside the current element and
+  returns \c true, or returns \c false at the end of the current
+  element, like QXmlStreamReader::readNextStartElement().
+ */
+bool BinaryIndexReader::readNextStartElement()
+{
+    while (readNext() != QXmlStreamReader::Invalid) {
+        if (m_token == QXmlStreamReader::EndElement)
+            return false;
+        if (m_token == QXmlStreamReader::StartElement)
+            return true;
+    }
+    return false;
+}
+
+/*!
+  Skips the children of the current start element and moves to its
+  end element.
+ */
+void BinaryIndexReader::skipCurrentElement()
+{
+    if (m_token != QXmlStreamReader::StartElement)
+        return;
+    m_openElements.removeLast();
+    m_token = QXmlStreamReader::EndElement;
+}
+
+/*!
+  Returns the attributes of the current element.
+ */
+BinaryIndexAttributes BinaryIndexReader::attributes() const
+{
+    const BinaryIndex::Element &element = m_elements[m_current];
+    BinaryIndexAttributes attributes;
+    attributes.m_reader = this;
+    attributes.m_begin = m_attributes + element.firstAttribute;
+    attributes.m_end = attributes.m_begin + element.attributeCount;
+    return attributes;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,134 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef BINARYINDEX_H
+#define BINARYINDEX_H
+
+#include <QtCore/qfile.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qxmlstream.h>
+
+QT_BEGIN_NAMESPACE
+
+class QFileInfo;
+
+namespace BinaryIndex {
+
+/*
+  The binary index is the element tree of an XML index file, flattened
+  so that it can be memory mapped and read without parsing. All strings
+  are interned and stored as UTF-16, elements are stored in document
+  order and know where their subtree ends.
+ */
+struct Header
+{
+    char magic[8];
+    quint32 version;
+    quint32 byteOrder;
+    quint64 xmlSize;
+    quint32 stringCount;
+    quint32 elementCount;
+    quint32 attributeCount;
+    quint32 charCount;
+};
+
+struct String
+{
+    quint32 offset;
+    quint32 size;
+};
+
+struct Element
+{
+    quint32 name;
+    quint32 firstAttribute;
+    quint32 attributeCount;
+    quint32 end;
+};
+
+struct Attribute
+{
+    quint32 name;
+    quint32 value;
+};
+
+QString fileName(const QString &indexFile);
+bool write(const QString &fileName, const QByteArray &xmlIndex, qint64 xmlSize);
+} // namespace BinaryIndex
+
+class BinaryIndexReader;
+
+class BinaryIndexAttributes
+{
+public:
+    bool hasAttribute(QLatin1String name) const;
+    QStringView value(QLatin1String name) const;
+
+private:
+    friend class BinaryIndexReader;
+    const BinaryIndexReader *m_reader = nullptr;
+    const BinaryIndex::Attribute *m_begin = nullptr;
+    const BinaryIndex::Attribute *m_end = nullptr;
+};
+
+class BinaryIndexReader
+{
+public:
+    bool open(const QString &fileName, const QFileInfo &xmlIndex);
+
+    QXmlStreamReader::TokenType readNext();
+    bool readNextStartElement();
+    void skipCurrentElement();
+    bool isEndElement() const { return m_token == QXmlStreamReader::EndElement; }
+    QStringView name() const { return string(m_elements[m_current].name); }
+    BinaryIndexAttributes attributes() const;
+
+private:
+    friend class BinaryIndexAttributes;
+    QStringView string(quint32 id) const
+    {
+        const BinaryIndex::String &s = m_strings[id];
+        return QStringView(m_chars + s.offset, s.size);
+    }
+    bool validate() const;
+
+    QFile m_file;
+    const BinaryIndex::Header *m_header = nullptr;
+    const BinaryIndex::String *m_strings = nullptr;
+    const BinaryIndex::Element *m_elements = nullptr;
+    const BinaryIndex::Attribute *m_attributes = nullptr;
+    const char16_t *m_chars = nullptr;
+    QXmlStreamReader::TokenType m_token = QXmlStreamReader::NoToken;
+    quint32 m_current = 0;
+    QList<quint32> m_openElements;
+};
+
+QT_END_NAMESPACE
+
+#endif // BINARYINDEX_H
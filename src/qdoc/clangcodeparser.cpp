@@ -56,11 +56,14 @@
 #include "utilities.h"
 #include "variablenode.h"
 
+#include <QtCore/qcryptographichash.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/qfile.h>
+#include <QtCore/qsavefile.h>
 #include <QtCore/qscopedvaluerollback.h>
 #include <QtCore/qtemporarydir.h>
+#include <QtCore/qthread.h>
 
 #include <clang-c/Index.h>
 
@@ -1067,11 +1070,12 @@ Node *ClangVisitor::nodeForCommentAtLocation(CXSourceLocation loc, CXSourceLocat
 }
 
 /*!
-  The destructor is trivial.
+  The destructor waits for the source files that are still
+  being parsed on the parser pool.
  */
 ClangCodeParser::~ClangCodeParser()
 {
-    // nothing.
+    finishParsingSourceFiles();
 }
 
 /*!
@@ -1146,6 +1150,7 @@ void ClangCodeParser::initializeParser()
  */
 void ClangCodeParser::terminateParser()
 {
+    finishParsingSourceFiles();
     CppCodeParser::terminateParser();
 }
 
@@ -1340,11 +1345,9 @@ void ClangCodeParser::buildPCH()
                               "file";
             }
             m_args.push_back("-xc++");
-            CXTranslationUnit tu;
-            QString tmpHeader = m_pchFileDir->path() + "/" + module;
-            QFile tmpHeaderFile(tmpHeader);
-            if (tmpHeaderFile.open(QIODevice::Text | QIODevice::WriteOnly)) {
-                QTextStream out(&tmpHeaderFile);
+            QByteArray headerContents;
+            {
+                QTextStream out(&headerContents);
                 if (header.isEmpty()) {
                     for (auto it = m_allHeaders.constKeyValueBegin();
                          it != m_allHeaders.constKeyValueEnd(); ++it) {
@@ -1359,6 +1362,7 @@ void ClangCodeParser::buildPCH()
                     QFile headerFile(header);
                     if (!headerFile.open(QFile::ReadOnly)) {
                         qWarning() << "Could not read module header file" << header;
+                        m_args.pop_back();
                         return;
                     }
                     QTextStream in(&headerFile);
@@ -1368,6 +1372,32 @@ void ClangCodeParser::buildPCH()
                             out << line << "\n";
                     }
                 }
+            }
+
+            // With a cache directory, the PCH is kept in a directory named after
+            // everything it is built from, together with the list of the headers
+            // it includes, and reused while none of them changed.
+            QString pchDir = m_pchFileDir->path();
+            QString dependenciesFile;
+            const QString cacheDir = Config::instance().cacheDir();
+            if (!cacheDir.isEmpty()) {
+                QString name = QString::fromUtf8(module);
+                name.replace(QLatin1Char('/'), QLatin1Char('_'));
+                pchDir = cacheDir + QLatin1Char('/') + name + QLatin1Char('-')
+                        + QString::fromLatin1(pchCacheKey(headerContents));
+                dependenciesFile = pchDir + QLatin1Char('/') + module + ".deps";
+                if (loadCachedPCH(pchDir + QLatin1Char('/') + module + ".pch", dependenciesFile)) {
+                    m_args.pop_back(); // remove the "-xc++";
+                    return;
+                }
+                QDir().mkpath(pchDir);
+            }
+
+            CXTranslationUnit tu;
+            QString tmpHeader = pchDir + "/" + module;
+            QFile tmpHeaderFile(tmpHeader);
+            if (tmpHeaderFile.open(QIODevice::Text | QIODevice::WriteOnly)) {
+                tmpHeaderFile.write(headerContents);
                 tmpHeaderFile.close();
             }
 
@@ -1381,13 +1411,17 @@ void ClangCodeParser::buildPCH()
             printDiagnostics(tu);
 
             if (!err && tu) {
-                m_pchName = m_pchFileDir->path().toUtf8() + "/" + module + ".pch";
+                m_pchName = pchDir.toUtf8() + "/" + module + ".pch";
                 auto error = clang_saveTranslationUnit(tu, m_pchName.constData(),
                                                        clang_defaultSaveOptions(tu));
                 if (error) {
                     qCCritical(lcQdoc) << "Could not save PCH file for" << moduleHeader();
                     m_pchName.clear();
                 } else {
+                    if (!dependenciesFile.isEmpty()) {
+                        savePCHDependencies(tu, dependenciesFile);
+                        removeOutdatedPCHs(pchDir);
+                    }
                     // Visit the header now, as token from pre-compiled header won't be visited
                     // later
                     CXCursor cur = clang_getTranslationUnitCursor(tu);
@@ -1405,6 +1439,112 @@ void ClangCodeParser::buildPCH()
     }
 }
 
+/*!
+  Returns the key of the PCH built from a module header with the
+  \a headerContents, which covers the clang version and the arguments
+  the PCH is built with, including the include paths and defines.
+ */
+QByteArray ClangCodeParser::pchCacheKey(const QByteArray &headerContents) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(fromCXString(clang_getClangVersion()).toUtf8());
+    for (const char *arg : m_args) {
+        hash.addData(arg);
+        hash.addData(QByteArray(1, '\0'));
+    }
+    hash.addData(headerContents);
+    return hash.result().toHex();
+}
+
+static void collectInclusion(CXFile includedFile, CXSourceLocation *, unsigned, CXClientData data)
+{
+    static_cast<QStringList *>(data)->append(fromCXString(clang_getFileName(includedFile)));
+}
+
+/*!
+  Writes the files included by the PCH \a tu to \a dependenciesFile,
+  with their sizes and modification times.
+ */
+void ClangCodeParser::savePCHDependencies(CXTranslationUnit tu, const QString &dependenciesFile)
+{
+    QStringList files;
+    clang_getInclusions(tu, collectInclusion, &files);
+    files.removeDuplicates();
+
+    QSaveFile file(dependenciesFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return;
+    QTextStream out(&file);
+    for (const QString &path : qAsConst(files)) {
+        const QFileInfo fi(path);
+        out << fi.size() << '\t' << fi.lastModified().toMSecsSinceEpoch() << '\t' << path << '\n';
+    }
+    out.flush();
+    if (!file.commit())
+        qCWarning(lcQdoc) << "Could not write" << dependenciesFile;
+}
+
+/*!
+  Loads the cached PCH \a pchFile and visits its declarations, if none
+  of the files listed in \a dependenciesFile changed. Returns \c true
+  if the PCH was loaded and can be used for parsing the source files.
+ */
+bool ClangCodeParser::loadCachedPCH(const QString &pchFile, const QString &dependenciesFile)
+{
+    QFile file(dependenciesFile);
+    if (!QFile::exists(pchFile) || !file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        const QStringList fields = in.readLine().split(QLatin1Char('\t'));
+        if (fields.size() != 3)
+            return false;
+        const QFileInfo fi(fields.at(2));
+        if (!fi.exists() || fi.size() != fields.at(0).toLongLong()
+            || fi.lastModified().toMSecsSinceEpoch() != fields.at(1).toLongLong()) {
+            qCDebug(lcQdoc) << "Cached PCH for" << moduleHeader() << "is outdated:" << fields.at(2);
+            return false;
+        }
+    }
+
+    CXTranslationUnit tu;
+    CXErrorCode err = clang_createTranslationUnit2(index_, pchFile.toUtf8().constData(), &tu);
+    if (err || !tu) {
+        qCDebug(lcQdoc) << "Could not load cached PCH" << pchFile << "error code:" << err;
+        return false;
+    }
+
+    m_pchName = pchFile.toUtf8();
+    CXCursor cur = clang_getTranslationUnitCursor(tu);
+    ClangVisitor visitor(qdb_, m_allHeaders);
+    visitor.visitChildren(cur);
+    clang_disposeTranslationUnit(tu);
+    qCDebug(lcQdoc) << "Cached PCH loaded and visited for" << moduleHeader();
+    return true;
+}
+
+/*!
+  Removes the PCHs cached for the same module as \a pchDir under
+  other keys, which were built with other arguments or from another
+  module header and are not used anymore.
+ */
+void ClangCodeParser::removeOutdatedPCHs(const QString &pchDir)
+{
+    const QFileInfo current(pchDir);
+    const QString name = current.fileName();
+    // The directories are named <module>-<key>, the key is a hex SHA-1 hash
+    const QString prefix = name.left(name.lastIndexOf(QLatin1Char('-')) + 1);
+    const QDir cacheDir = current.dir();
+    const QStringList entries = cacheDir.entryList({ prefix + QLatin1Char('*') },
+                                                   QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &entry : entries) {
+        if (entry == name || entry.size() != prefix.size() + 40)
+            continue;
+        qCDebug(lcQdoc) << "Removing outdated PCH" << cacheDir.filePath(entry);
+        QDir(cacheDir.filePath(entry)).removeRecursively();
+    }
+}
+
 /*!
   Precompile the header files for the current module.
  */
@@ -1425,6 +1565,119 @@ void ClangCodeParser::precompileHeaders()
     clang_disposeIndex(index_);
 }
 
+/*!
+  Starts parsing the C++ source files in \a filePaths with clang
+  on the threads of the parser pool, in the order parseSourceFile()
+  is going to be called for them. Only the clang parse runs on the
+  pool: visiting the translation units, parsing the comments, and
+  adding the results to the database happen in parseSourceFile()
+  in file order, so the tree and the warnings are the same as when
+  parsing serially. At most two translation units per thread are
+  kept ahead of parseSourceFile(), as they can be large.
+
+  Does nothing if qdoc was asked to parse on a single thread.
+ */
+void ClangCodeParser::prepareSourceFiles(const QStringList &filePaths)
+{
+    finishParsingSourceFiles();
+
+    const int threads = Config::instance().parseThreads();
+    m_parserPool.setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+    if (m_parserPool.maxThreadCount() < 2)
+        return;
+
+    // The same arguments parseSourceFile() passes, see there.
+    getDefaultArgs();
+    const std::vector<const char *> defaultArgs = m_args;
+    getMoreArgs();
+    m_sourceFileArgs.clear();
+    m_sourceFileArgsWithoutPCH.clear();
+    for (const char *arg : defaultArgs) {
+        m_sourceFileArgs.append(arg);
+        m_sourceFileArgsWithoutPCH.append(arg);
+    }
+    if (!m_pchName.isEmpty()) {
+        m_sourceFileArgs.append("-w");
+        m_sourceFileArgs.append("-include-pch");
+        m_sourceFileArgs.append(m_pchName);
+    }
+    for (const auto &p : qAsConst(m_moreArgs)) {
+        m_sourceFileArgs.append(p);
+        m_sourceFileArgsWithoutPCH.append(p);
+    }
+
+    m_sourceFilesToParse = filePaths;
+    const size_t maxParsed = size_t(2 * m_parserPool.maxThreadCount());
+    while (!m_sourceFilesToParse.isEmpty() && m_parsedSourceFiles.size() < maxParsed)
+        startParsingSourceFile();
+}
+
+/*
+  A source file parsed by clang on a thread of the parser pool. Each
+  file gets its own index, as an index must not be used by several
+  threads at once.
+ */
+struct ClangCodeParser::ParsedSourceFile
+{
+    QString filePath;
+    CXIndex index = nullptr;
+    CXTranslationUnit tu = nullptr;
+    CXErrorCode err = CXError_Success;
+    bool done = false;
+};
+
+/*!
+  Starts parsing the next file of the prepared source files
+  on the parser pool.
+ */
+void ClangCodeParser::startParsingSourceFile()
+{
+    auto file = std::make_shared<ParsedSourceFile>();
+    file->filePath = m_sourceFilesToParse.takeFirst();
+    const QList<QByteArray> args = file->filePath.endsWith(".mm") ? m_sourceFileArgsWithoutPCH
+                                                                   : m_sourceFileArgs;
+    const auto flags = static_cast<CXTranslationUnit_Flags>(CXTranslationUnit_Incomplete
+                                                            | CXTranslationUnit_SkipFunctionBodies
+                                                            | CXTranslationUnit_KeepGoing);
+    m_parsedSourceFiles.push_back(file);
+    m_parserPool.start([this, file, args, flags]() {
+        std::vector<const char *> argv;
+        argv.reserve(args.size());
+        for (const auto &arg : args)
+            argv.push_back(arg.constData());
+
+        CXIndex index = clang_createIndex(1, kClangDontDisplayDiagnostics);
+        CXTranslationUnit tu = nullptr;
+        CXErrorCode err = clang_parseTranslationUnit2(index, file->filePath.toLocal8Bit(),
+                                                      argv.data(), static_cast<int>(argv.size()),
+                                                      nullptr, 0, flags, &tu);
+
+        QMutexLocker lock(&m_parserMutex);
+        file->index = index;
+        file->tu = tu;
+        file->err = err;
+        file->done = true;
+        m_sourceFileParsed.wakeAll();
+    });
+}
+
+/*!
+  Waits for the source files parsed on the parser pool and
+  disposes of the ones parseSourceFile() has not been called for.
+ */
+void ClangCodeParser::finishParsingSourceFiles()
+{
+    m_sourceFilesToParse.clear();
+    m_parserPool.waitForDone();
+    for (const auto &file : m_parsedSourceFiles) {
+        if (file->tu)
+            clang_disposeTranslationUnit(file->tu);
+        if (file->index)
+            clang_disposeIndex(file->index);
+    }
+    m_parsedSourceFiles.clear();
+}
+
 static float getUnpatchedVersion(QString t)
 {
     if (t.count(QChar('.')) > 1)
@@ -1451,29 +1704,51 @@ void ClangCodeParser::parseSourceFile(const Location & /*location*/, const QStri
                                                   | CXTranslationUnit_SkipFunctionBodies
                                                   | CXTranslationUnit_KeepGoing);
 
-    index_ = clang_createIndex(1, kClangDontDisplayDiagnostics);
+    CXIndex index = nullptr;
+    CXTranslationUnit tu = nullptr;
+    CXErrorCode err = CXError_Success;
+    if (!m_parsedSourceFiles.empty() && m_parsedSourceFiles.front()->filePath == filePath) {
+        // Parsed on the parser pool, see prepareSourceFiles().
+        const std::shared_ptr<ParsedSourceFile> file = m_parsedSourceFiles.front();
+        m_parsedSourceFiles.pop_front();
+        {
+            QMutexLocker lock(&m_parserMutex);
+            while (!file->done)
+                m_sourceFileParsed.wait(&m_parserMutex);
+        }
+        if (!m_sourceFilesToParse.isEmpty())
+            startParsingSourceFile();
+        index = file->index;
+        tu = file->tu;
+        err = file->err;
+        qCDebug(lcQdoc) << __FUNCTION__ << "clang_parseTranslationUnit2(" << filePath
+                        << (filePath.endsWith(".mm") ? m_sourceFileArgsWithoutPCH
+                                                     : m_sourceFileArgs)
+                        << ") returns" << err;
+    } else {
+        index = clang_createIndex(1, kClangDontDisplayDiagnostics);
 
-    getDefaultArgs();
-    if (!m_pchName.isEmpty() && !filePath.endsWith(".mm")) {
-        m_args.push_back("-w");
-        m_args.push_back("-include-pch");
-        m_args.push_back(m_pchName.constData());
+        getDefaultArgs();
+        if (!m_pchName.isEmpty() && !filePath.endsWith(".mm")) {
+            m_args.push_back("-w");
+            m_args.push_back("-include-pch");
+            m_args.push_back(m_pchName.constData());
+        }
+        getMoreArgs();
+        for (const auto &p : qAsConst(m_moreArgs))
+            m_args.push_back(p.constData());
+
+        err = clang_parseTranslationUnit2(index, filePath.toLocal8Bit(), m_args.data(),
+                                          static_cast<int>(m_args.size()), nullptr, 0, flags_,
+                                          &tu);
+        qCDebug(lcQdoc) << __FUNCTION__ << "clang_parseTranslationUnit2(" << filePath << m_args
+                        << ") returns" << err;
     }
-    getMoreArgs();
-    for (const auto &p : qAsConst(m_moreArgs))
-        m_args.push_back(p.constData());
-
-    CXTranslationUnit tu;
-    CXErrorCode err =
-            clang_parseTranslationUnit2(index_, filePath.toLocal8Bit(), m_args.data(),
-                                        static_cast<int>(m_args.size()), nullptr, 0, flags_, &tu);
-    qCDebug(lcQdoc) << __FUNCTION__ << "clang_parseTranslationUnit2(" << filePath << m_args
-                    << ") returns" << err;
     printDiagnostics(tu);
 
     if (err || !tu) {
         qWarning() << "(qdoc) Could not parse source file" << filePath << " error code:" << err;
-        clang_disposeIndex(index_);
+        clang_disposeIndex(index);
         return;
     }
 
@@ -1561,7 +1836,7 @@ void ClangCodeParser::parseSourceFile(const Location & /*location*/, const QStri
 
     clang_disposeTokens(tu, tokens, numTokens);
     clang_disposeTranslationUnit(tu);
-    clang_disposeIndex(index_);
+    clang_disposeIndex(index);
     m_namespaceScope.clear();
     s_fn.clear();
 }
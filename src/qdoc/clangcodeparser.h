@@ -42,7 +42,13 @@
 
 #include "cppcodeparser.h"
 
+#include <QtCore/qmutex.h>
 #include <QtCore/qtemporarydir.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qwaitcondition.h>
+
+#include <deque>
+#include <memory>
 
 typedef struct CXTranslationUnitImpl *CXTranslationUnit;
 
@@ -61,6 +67,7 @@ public:
     void parseHeaderFile(const Location &location, const QString &filePath) override;
     void parseSourceFile(const Location &location, const QString &filePath) override;
     void precompileHeaders() override;
+    void prepareSourceFiles(const QStringList &filePaths);
     Node *parseFnArg(const Location &location, const QString &fnArg) override;
     static const QByteArray &fn() { return s_fn; }
 
@@ -69,6 +76,12 @@ private:
     void getMoreArgs(); // FIXME: Clean up API
 
     void buildPCH();
+    QByteArray pchCacheKey(const QByteArray &headerContents) const;
+    void savePCHDependencies(CXTranslationUnit tu, const QString &dependenciesFile);
+    bool loadCachedPCH(const QString &pchFile, const QString &dependenciesFile);
+    void removeOutdatedPCHs(const QString &pchDir);
+    void startParsingSourceFile();
+    void finishParsingSourceFiles();
 
     void printDiagnostics(const CXTranslationUnit &translationUnit) const;
 
@@ -82,6 +95,15 @@ private:
     QList<QByteArray> m_moreArgs {};
     QStringList m_namespaceScope {};
     static QByteArray s_fn;
+
+    struct ParsedSourceFile;
+    QThreadPool m_parserPool {};
+    QMutex m_parserMutex {};
+    QWaitCondition m_sourceFileParsed {};
+    std::deque<std::shared_ptr<ParsedSourceFile>> m_parsedSourceFiles {};
+    QStringList m_sourceFilesToParse {};
+    QList<QByteArray> m_sourceFileArgs {};
+    QList<QByteArray> m_sourceFileArgsWithoutPCH {};
 };
 
 QT_END_NAMESPACE
@@ -413,6 +413,10 @@ void Config::processCommandLineOptions(const QStringList &args)
 
     m_debug = m_parser.isSet(m_parser.debugOption);
     m_showInternal = m_parser.isSet(m_parser.showInternalOption);
+    m_parseThreads = m_parser.value(m_parser.parseThreadsOption).toInt();
+    if (m_parser.isSet(m_parser.cacheDirOption))
+        m_cacheDir = QDir::current().absoluteFilePath(m_parser.value(m_parser.cacheDirOption));
+    m_binaryIndexes = !m_parser.isSet(m_parser.noBinaryIndexesOption);
 
     if (m_parser.isSet(m_parser.prepareOption))
         m_qdocPass = Prepare;
@@ -123,6 +123,9 @@ public:
     void init(const QString &programName, const QStringList &args);
     bool getDebug() const { return m_debug; }
     bool showInternal() const { return m_showInternal; }
+    int parseThreads() const { return m_parseThreads; }
+    const QString &cacheDir() const { return m_cacheDir; }
+    bool binaryIndexes() const { return m_binaryIndexes; }
 
     void clear();
     void reset();
@@ -223,6 +226,9 @@ private:
     QString m_previousCurrentDir {};
 
     bool m_showInternal { false };
+    int m_parseThreads { 0 };
+    QString m_cacheDir {};
+    bool m_binaryIndexes { true };
     static bool m_debug;
     static bool isMetaKeyChar(QChar ch);
     void load(Location location, const QString &fileName);
@@ -2425,7 +2425,7 @@ void DocBookGenerator::generateMaintainerList(const Aggregate *node, CodeMarker
  */
 QXmlStreamWriter *DocBookGenerator::startGenericDocument(const Node *node, const QString &fileName)
 {
-    QFile *outFile = openSubPageFile(node, fileName);
+    QIODevice *outFile = openSubPageFile(node, fileName);
     writer = new QXmlStreamWriter(outFile);
     writer->setAutoFormatting(false); // We need a precise handling of line feeds.
 
@@ -2461,9 +2461,11 @@ void DocBookGenerator::endDocument()
 {
     writer->writeEndElement(); // article
     writer->writeEndDocument();
-    writer->device()->close();
+    QIODevice *outFile = writer->device();
+    outFile->close();
     delete writer;
     writer = nullptr;
+    delete outFile;
 }
 
 /*!
@@ -53,9 +53,12 @@
 #include "tokenizer.h"
 #include "typedefnode.h"
 
+#include <QtCore/qbuffer.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qdir.h>
 #include <QtCore/qregularexpression.h>
+#include <QtCore/qsemaphore.h>
+#include <QtCore/qthreadpool.h>
 
 #ifndef QT_BOOTSTRAPPED
 #    include "QtCore/qurl.h"
@@ -63,6 +66,51 @@
 
 QT_BEGIN_NAMESPACE
 
+// Pages waiting to be written to disk, to bound the memory they hold.
+static const int maxPendingPageWrites = 64;
+
+Q_GLOBAL_STATIC(QThreadPool, pageWriterPool)
+Q_GLOBAL_STATIC_WITH_ARGS(QSemaphore, pendingPageWrites, (maxPendingPageWrites))
+
+/*
+  Collects the contents of an output page in memory. When the page is
+  closed, the contents are written to its file on a thread of the page
+  writer pool, so that writing the pages to disk overlaps with
+  generating the following ones. The file itself is opened by
+  openSubPageFile() in page order, which keeps its diagnostics
+  deterministic.
+ */
+class PageFile : public QBuffer
+{
+public:
+    explicit PageFile(QFile *file) : m_file(file) { open(QIODevice::WriteOnly); }
+    ~PageFile() override { close(); }
+
+    QString fileName() const { return m_file->fileName(); }
+    void close() override;
+
+private:
+    QFile *m_file;
+};
+
+void PageFile::close()
+{
+    if (!isOpen())
+        return;
+    const QByteArray contents = buffer();
+    QBuffer::close();
+    setData(QByteArray());
+
+    QFile *file = m_file;
+    pendingPageWrites()->acquire();
+    pageWriterPool()->start([file, contents]() {
+        file->write(contents);
+        file->close();
+        delete file;
+        pendingPageWrites()->release();
+    });
+}
+
 Generator *Generator::currentGenerator_;
 QStringList Generator::exampleDirs;
 QStringList Generator::exampleImgExts;
@@ -220,13 +268,15 @@ int Generator::appendSortedQmlNames(Text &text, const Node *base, const NodeList
 
 /*!
   Creates the file named \a fileName in the output directory
-  and returns a QFile pointing to this file. In particular,
+  and returns a device for writing to this file. In particular,
   this method deals with errors when opening the file:
-  the returned QFile is always valid and can be written to.
+  the returned device is always valid and can be written to.
+  The contents are written to the file after the device is
+  closed, while the next pages are generated.
 
-  \sa beginFilePage()
+  \sa beginFilePage(), waitForPageWrites()
  */
-QFile *Generator::openSubPageFile(const Node *node, const QString &fileName)
+QIODevice *Generator::openSubPageFile(const Node *node, const QString &fileName)
 {
     QString path = outputDir() + QLatin1Char('/');
     if (Generator::useOutputSubdirs() && !node->outputSubdirectory().isEmpty()
@@ -247,7 +297,16 @@ QFile *Generator::openSubPageFile(const Node *node, const QString &fileName)
     }
     qCDebug(lcQdoc, "Writing: %s", qPrintable(path));
     outFileNames_ << fileName;
-    return outFile;
+    return new PageFile(outFile);
+}
+
+/*!
+  Blocks until the contents of all closed output pages
+  have been written to their files.
+ */
+void Generator::waitForPageWrites()
+{
+    pageWriterPool()->waitForDone();
 }
 
 /*!
@@ -260,7 +319,7 @@ QFile *Generator::openSubPageFile(const Node *node, const QString &fileName)
  */
 void Generator::beginFilePage(const Node *node, const QString &fileName)
 {
-    QFile *outFile = openSubPageFile(node, fileName);
+    QIODevice *outFile = openSubPageFile(node, fileName);
     QTextStream *out = new QTextStream(outFile);
     outStreamStack.push(out);
 }
@@ -1071,6 +1130,12 @@ void Generator::generateInherits(const ClassNode *classe, CodeMarker *marker)
 
 /*!
   Recursive writing of HTML files from the root \a node.
+
+  The pages are rendered one after the other, in tree order: rendering
+  a page reads and updates state that the following pages depend on,
+  such as the output file names of the nodes and the merged
+  collections. Only writing the rendered pages to disk is done on
+  other threads, see PageFile.
  */
 void Generator::generateDocumentation(Node *node)
 {
@@ -1654,6 +1719,7 @@ void Generator::generateDocs()
 {
     currentGenerator_ = this;
     generateDocumentation(m_qdb->primaryTreeRoot());
+    waitForPageWrites();
 }
 
 Generator *Generator::generatorForFormat(const QString &format)
@@ -1918,7 +1984,7 @@ QTextStream &Generator::out()
 
 QString Generator::outFileName()
 {
-    return QFileInfo(static_cast<QFile *>(out().device())->fileName()).fileName();
+    return QFileInfo(static_cast<PageFile *>(out().device())->fileName()).fileName();
 }
 
 QString Generator::outputPrefix(const Node *node)
@@ -2133,6 +2199,8 @@ void Generator::supplementAlsoList(const Node *node, QList<Text> &alsoList)
 
 void Generator::terminate()
 {
+    waitForPageWrites();
+
     for (const auto &generator : qAsConst(generators)) {
         if (outputFormats.contains(generator->format()))
             generator->terminateGenerator();
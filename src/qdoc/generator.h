@@ -101,7 +101,8 @@ public:
     static QString fileBase(const Node *node);
 
 protected:
-    static QFile *openSubPageFile(const Node *node, const QString &fileName);
+    static QIODevice *openSubPageFile(const Node *node, const QString &fileName);
+    static void waitForPageWrites();
     void beginFilePage(const Node *node, const QString &fileName);
     void endFilePage() { endSubPage(); } // for symmetry
     void beginSubPage(const Node *node, const QString &fileName);
@@ -48,6 +48,7 @@
 
 #include <QtCore/qdatetime.h>
 #include <QtCore/qdebug.h>
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/qglobal.h>
 #include <QtCore/qhashfunctions.h>
 
@@ -476,7 +477,14 @@ static void processQdocconfFile(const QString &fileName)
         */
         parsed = 0;
         qCInfo(lcQdoc) << "Parse source files for" << project;
-        for (const auto &key : sources.keys()) {
+        const QStringList sourceFiles = sources.keys();
+        QStringList clangSourceFiles;
+        for (const auto &key : sourceFiles) {
+            if (CodeParser::parserForSourceFile(key) == clangParser_)
+                clangSourceFiles.append(key);
+        }
+        clangParser_->prepareSourceFiles(clangSourceFiles);
+        for (const auto &key : sourceFiles) {
             auto *codeParser = CodeParser::parserForSourceFile(key);
             if (codeParser) {
                 ++parsed;
@@ -507,8 +515,12 @@ static void processQdocconfFile(const QString &fileName)
         if (generator == nullptr)
             outputFormatsLocation.fatal(
                     QCoreApplication::translate("QDoc", "Unknown output format '%1'").arg(format));
+        QElapsedTimer timer;
+        timer.start();
         generator->initializeFormat();
         generator->generateDocs();
+        qCInfo(lcQdoc) << "Generated" << format << "documentation for" << project << "in"
+                       << timer.elapsed() << "ms";
     }
     qdb->clearLinkCounts();
 
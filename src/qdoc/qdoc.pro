@@ -33,6 +33,7 @@ win32-icc*|win32-msvc*:{
 HEADERS += access.h \
            aggregate.h \
            atom.h \
+           binaryindex.h \
            clangcodeparser.h \
            classnode.h \
            codechunk.h \
@@ -94,6 +95,7 @@ HEADERS += access.h \
 
 SOURCES += aggregate.cpp \
            atom.cpp \
+           binaryindex.cpp \
            clangcodeparser.cpp \
            classnode.cpp \
            codechunk.cpp \
@@ -59,7 +59,10 @@ QDocCommandLineParser::QDocCommandLineParser()
       frameworkOption("F", "Add macOS framework to the include path for header files.",
                       "framework"),
       timestampsOption(QStringList() << QStringLiteral("timestamps")),
-      useDocBookExtensions(QStringList() << QStringLiteral("docbook-extensions"))
+      useDocBookExtensions(QStringList() << QStringLiteral("docbook-extensions")),
+      parseThreadsOption(QStringList() << QStringLiteral("parse-threads")),
+      cacheDirOption(QStringList() << QStringLiteral("cache-dir")),
+      noBinaryIndexesOption(QStringList() << QStringLiteral("no-binary-indexes"))
 {
     setApplicationDescription(QCoreApplication::translate("qdoc", "Qt documentation generator"));
     addHelpOption();
@@ -159,6 +162,22 @@ QDocCommandLineParser::QDocCommandLineParser()
     useDocBookExtensions.setDescription(QCoreApplication::translate(
             "qdoc", "Use the DocBook Library extensions for metadata."));
     addOption(useDocBookExtensions);
+
+    parseThreadsOption.setDescription(QCoreApplication::translate(
+            "qdoc", "Parse C++ source files with clang on up to <count> threads. "
+                    "The default is the number of processor cores, 1 parses serially."));
+    parseThreadsOption.setValueName(QStringLiteral("count"));
+    addOption(parseThreadsOption);
+
+    cacheDirOption.setDescription(QCoreApplication::translate(
+            "qdoc", "Keep the precompiled module headers in <dir> and reuse them "
+                    "in later runs while the headers they include do not change."));
+    cacheDirOption.setValueName(QStringLiteral("dir"));
+    addOption(cacheDirOption);
+
+    noBinaryIndexesOption.setDescription(QCoreApplication::translate(
+            "qdoc", "Write and read only the XML index files, not the binary index files."));
+    addOption(noBinaryIndexesOption);
 }
 
 /*!
@@ -45,7 +45,8 @@ struct QDocCommandLineParser : public QCommandLineParser
     QCommandLineOption noLinkErrorsOption, autoLinkErrorsOption, debugOption;
     QCommandLineOption prepareOption, generateOption, logProgressOption, singleExecOption;
     QCommandLineOption includePathOption, includePathSystemOption, frameworkOption;
-    QCommandLineOption timestampsOption, useDocBookExtensions;
+    QCommandLineOption timestampsOption, useDocBookExtensions, parseThreadsOption;
+    QCommandLineOption cacheDirOption, noBinaryIndexesOption;
 };
 
 QT_END_NAMESPACE
@@ -30,6 +30,7 @@
 
 #include "access.h"
 #include "atom.h"
+#include "binaryindex.h"
 #include "classnode.h"
 #include "collectionnode.h"
 #include "config.h"
@@ -47,6 +48,7 @@
 #include "typedefnode.h"
 #include "variablenode.h"
 
+#include <QtCore/qfileinfo.h>
 #include <QtCore/qxmlstream.h>
 
 #include <algorithm>
@@ -127,6 +129,9 @@ void QDocIndexFiles::readIndexes(const QStringList &indexFiles)
 
 /*!
   Reads and parses the index file at \a path.
+
+  If there is an up-to-date binary index next to it, and binary
+  indexes are not disabled, the binary index is read instead.
  */
 void QDocIndexFiles::readIndexFile(const QString &path)
 {
@@ -136,16 +141,34 @@ void QDocIndexFiles::readIndexFile(const QString &path)
         return;
     }
 
+    if (Config::instance().binaryIndexes()) {
+        BinaryIndexReader binaryReader;
+        if (binaryReader.open(BinaryIndex::fileName(path), QFileInfo(file))) {
+            qCDebug(lcQdoc) << "Using binary index file:" << BinaryIndex::fileName(path);
+            readIndex(binaryReader, path);
+            return;
+        }
+    }
+
     QXmlStreamReader reader(&file);
     reader.setNamespaceProcessing(false);
+    readIndex(reader, path);
+}
 
+/*!
+  Reads the index at \a path from \a reader, which is either a
+  QXmlStreamReader or a BinaryIndexReader.
+ */
+template<typename Reader>
+void QDocIndexFiles::readIndex(Reader &reader, const QString &path)
+{
     if (!reader.readNextStartElement())
         return;
 
     if (reader.name() != QLatin1String("INDEX"))
         return;
 
-    QXmlStreamAttributes attrs = reader.attributes();
+    const auto attrs = reader.attributes();
 
     // Generate a relative URL between the install dir and the index file
     // when the -installdir command line option is set.
@@ -186,10 +209,10 @@ void QDocIndexFiles::readIndexFile(const QString &path)
   Read a <section> element from the index file and create the
   appropriate node(s).
  */
-void QDocIndexFiles::readIndexSection(QXmlStreamReader &reader, Node *current,
-                                      const QString &indexUrl)
+template<typename Reader>
+void QDocIndexFiles::readIndexSection(Reader &reader, Node *current, const QString &indexUrl)
 {
-    QXmlStreamAttributes attributes = reader.attributes();
+    const auto attributes = reader.attributes();
     QStringView elementName = reader.name();
 
     QString name = attributes.value(QLatin1String("name")).toString();
@@ -207,7 +230,7 @@ void QDocIndexFiles::readIndexSection(QXmlStreamReader &reader, Node *current,
     int lineNo = 0;
     if (attributes.hasAttribute(QLatin1String("filepath"))) {
         filePath = attributes.value(QLatin1String("filepath")).toString();
-        lineNo = attributes.value("lineno").toInt();
+        lineNo = attributes.value(QLatin1String("lineno")).toInt();
     }
     if (elementName == QLatin1String("namespace")) {
         auto *namespaceNode = new NamespaceNode(parent, name);
@@ -265,7 +288,7 @@ void QDocIndexFiles::readIndexSection(QXmlStreamReader &reader, Node *current,
             qmlTypeNode->setQmlBaseName(qmlFullBaseName);
         }
         if (attributes.hasAttribute(QLatin1String("location")))
-            name = attributes.value("location").toString();
+            name = attributes.value(QLatin1String("location")).toString();
         if (!indexUrl.isEmpty())
             location = Location(indexUrl + QLatin1Char('/') + name);
         else if (!indexUrl.isNull())
@@ -287,7 +310,7 @@ void QDocIndexFiles::readIndexSection(QXmlStreamReader &reader, Node *current,
             qmlTypeNode->setQmlBaseName(qmlFullBaseName);
         }
         if (attributes.hasAttribute(QLatin1String("location")))
-            name = attributes.value("location").toString();
+            name = attributes.value(QLatin1String("location")).toString();
         if (!indexUrl.isEmpty())
             location = Location(indexUrl + QLatin1Char('/') + name);
         else if (!indexUrl.isNull())
@@ -297,7 +320,7 @@ void QDocIndexFiles::readIndexSection(QXmlStreamReader &reader, Node *current,
         auto *qbtn = new QmlBasicTypeNode(parent, name);
         qbtn->setTitle(attributes.value(QLatin1String("title")).toString());
         if (attributes.hasAttribute(QLatin1String("location")))
-            name = attributes.value("location").toString();
+            name = attributes.value(QLatin1String("location")).toString();
         if (!indexUrl.isEmpty())
             location = Location(indexUrl + QLatin1Char('/') + name);
         else if (!indexUrl.isNull())
@@ -308,7 +331,7 @@ void QDocIndexFiles::readIndexSection(QXmlStreamReader &reader, Node *current,
         qbtn->setGenus(Node::JS);
         qbtn->setTitle(attributes.value(QLatin1String("title")).toString());
         if (attributes.hasAttribute(QLatin1String("location")))
-            name = attributes.value("location").toString();
+            name = attributes.value(QLatin1String("location")).toString();
         if (!indexUrl.isEmpty())
             location = Location(indexUrl + QLatin1Char('/') + name);
         else if (!indexUrl.isNull())
@@ -430,7 +453,8 @@ void QDocIndexFiles::readIndexSection(QXmlStreamReader &reader, Node *current,
         node = pageNode;
 
     } else if (elementName == QLatin1String("enum")) {
-        auto *enumNode = new EnumNode(parent, name, attributes.hasAttribute("scoped"));
+        auto *enumNode =
+                new EnumNode(parent, name, attributes.hasAttribute(QLatin1String("scoped")));
 
         if (!indexUrl.isEmpty())
             location = Location(indexUrl + QLatin1Char('/') + parent->name().toLower() + ".html");
@@ -438,7 +462,7 @@ void QDocIndexFiles::readIndexSection(QXmlStreamReader &reader, Node *current,
             location = Location(parent->name().toLower() + ".html");
 
         while (reader.readNextStartElement()) {
-            QXmlStreamAttributes childAttributes = reader.attributes();
+            const auto childAttributes = reader.attributes();
             if (reader.name() == QLatin1String("value")) {
 
                 EnumItem item(childAttributes.value(QLatin1String("name")).toString(),
@@ -520,7 +544,7 @@ void QDocIndexFiles::readIndexSection(QXmlStreamReader &reader, Node *current,
               the first place and from which it can be rebuilt.
             */
             while (reader.readNextStartElement()) {
-                QXmlStreamAttributes childAttributes = reader.attributes();
+                const auto childAttributes = reader.attributes();
                 if (reader.name() == QLatin1String("parameter")) {
                     // Do not use the default value for the parameter; it is not
                     // required, and has been known to cause problems.
@@ -669,8 +693,9 @@ done:
     }
 }
 
-void QDocIndexFiles::insertTarget(TargetRec::TargetType type,
-                                  const QXmlStreamAttributes &attributes, Node *node)
+template<typename Attributes>
+void QDocIndexFiles::insertTarget(TargetRec::TargetType type, const Attributes &attributes,
+                                  Node *node)
 {
     int priority;
     switch (type) {
@@ -1538,6 +1563,9 @@ void QDocIndexFiles::generateIndexSections(QXmlStreamWriter &writer, Node *node,
   \a url is the \c url attribute of the <INDEX> element.
   \a title is the \c title attribute of the <INDEX> element.
   \a g is a pointer to the current Generator in use, stored for later use.
+
+  Unless binary indexes are disabled, the same index is also written
+  in binary form next to it, for the modules that depend on this one.
  */
 void QDocIndexFiles::generateIndex(const QString &fileName, const QString &url,
                                    const QString &title, Generator *g)
@@ -1549,7 +1577,8 @@ void QDocIndexFiles::generateIndex(const QString &fileName, const QString &url,
     qCDebug(lcQdoc) << "Writing index file:" << fileName;
 
     gen_ = g;
-    QXmlStreamWriter writer(&file);
+    QByteArray data;
+    QXmlStreamWriter writer(&data);
     writer.setAutoFormatting(true);
     writer.writeStartDocument();
     writer.writeDTD("<!DOCTYPE QDOCINDEX>");
@@ -1569,7 +1598,15 @@ void QDocIndexFiles::generateIndex(const QString &fileName, const QString &url,
     writer.writeEndElement(); // INDEX
     writer.writeEndElement(); // QDOCINDEX
     writer.writeEndDocument();
+    file.write(data);
     file.close();
+
+    if (Config::instance().binaryIndexes()) {
+        const QString binaryFileName = BinaryIndex::fileName(fileName);
+        qCDebug(lcQdoc) << "Writing binary index file:" << binaryFileName;
+        if (!BinaryIndex::write(binaryFileName, data, QFileInfo(fileName).size()))
+            qWarning() << "Could not write binary index file" << binaryFileName;
+    }
 }
 
 QT_END_NAMESPACE
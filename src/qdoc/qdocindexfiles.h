@@ -39,9 +39,7 @@ class FunctionNode;
 class Generator;
 class QDocDatabase;
 class WebXMLGenerator;
-class QXmlStreamReader;
 class QXmlStreamWriter;
-class QXmlStreamAttributes;
 
 // A callback interface for extending index sections
 class IndexSectionWriter
@@ -65,9 +63,12 @@ private:
 
     void readIndexes(const QStringList &indexFiles);
     void readIndexFile(const QString &path);
-    void readIndexSection(QXmlStreamReader &reader, Node *current, const QString &indexUrl);
-    void insertTarget(TargetRec::TargetType type, const QXmlStreamAttributes &attributes,
-                      Node *node);
+    template<typename Reader>
+    void readIndex(Reader &reader, const QString &path);
+    template<typename Reader>
+    void readIndexSection(Reader &reader, Node *current, const QString &indexUrl);
+    template<typename Attributes>
+    void insertTarget(TargetRec::TargetType type, const Attributes &attributes, Node *node);
     void resolveIndex();
 
     void generateIndex(const QString &fileName, const QString &url, const QString &title,
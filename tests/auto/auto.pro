@@ -6,8 +6,10 @@ SUBDIRS=\
     qhelpcontentmodel \
     qhelpenginecore \
     qhelpgenerator \
+    qhelphtmltextextractor \
     qhelpindexmodel \
     qhelpprojectdata \
+    qhelpsearchengine \
     cmake \
     installed_cmake \
     qtdiag \
@@ -19,15 +21,18 @@ installed_cmake.depends = cmake
 cross_compile:SUBDIRS -= linguist qdoc qtattributionsscanner windeployqt qhelpgenerator qtdiag
 
 # Tests that might make sense, but currently use SRCDIR
-cross_compile:SUBDIRS -= qhelpcontentmodel qhelpenginecore qhelpindexmodel qhelpprojectdata
+cross_compile:SUBDIRS -= qhelpcontentmodel qhelpenginecore qhelpindexmodel qhelpprojectdata \
+    qhelpsearchengine
 
 # These tests need the QtHelp module
 !qtHaveModule(help): SUBDIRS -= \
     qhelpcontentmodel \
     qhelpenginecore \
     qhelpgenerator \
+    qhelphtmltextextractor \
     qhelpindexmodel \
     qhelpprojectdata \
+    qhelpsearchengine \
 
 !qtConfig(process): SUBDIRS -= qtattributionsscanner linguist qtdiag windeployqt
 !win32: SUBDIRS -= windeployqt
@@ -0,0 +1,2 @@
+TEMPLATE = app
+TRANSLATIONS = translate.ts compressed.ts
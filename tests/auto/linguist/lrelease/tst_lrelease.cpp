@@ -52,6 +52,9 @@ private slots:
     void markuntranslated();
     void dupes();
     void noTranslations();
+    void parallel();
+    void parallelProject();
+    void incremental();
 
 private:
     void doCompare(const QStringList &actual, const QString &expectedFn);
@@ -219,5 +222,78 @@ void tst_lrelease::noTranslations()
     QVERIFY(stderrOutput.contains("lrelease warning: Met no 'TRANSLATIONS' entry in project file"));
 }
 
+void tst_lrelease::parallel()
+{
+    QFile::remove(dataDir + "translate.qm");
+    QFile::remove(dataDir + "compressed.qm");
+    QProcess proc;
+    proc.start(lrelease, { "-j", "2", dataDir + "translate.ts", dataDir + "compressed.ts" });
+    QVERIFY(proc.waitForFinished());
+    QCOMPARE(proc.exitStatus(), QProcess::NormalExit);
+    QCOMPARE(proc.exitCode(), 0);
+
+    // The output comes in the order of the files.
+    const QByteArray output = proc.readAllStandardOutput();
+    const int first = output.indexOf("translate.qm");
+    const int second = output.indexOf("compressed.qm");
+    QVERIFY(first >= 0);
+    QVERIFY(second > first);
+
+    QTranslator translator;
+    QVERIFY(translator.load(dataDir + "translate.qm"));
+    QVERIFY(translator.load(dataDir + "compressed.qm"));
+}
+
+void tst_lrelease::parallelProject()
+{
+    QFile::remove(dataDir + "translate.qm");
+    QFile::remove(dataDir + "compressed.qm");
+    QProcess proc;
+    // lrelease-pro must pass the parameter of -j on instead of taking it for an input file.
+    proc.start(lrelease, { "-j", "4", dataDir + "parallel.pro" });
+    QVERIFY(proc.waitForFinished());
+    QCOMPARE(proc.exitStatus(), QProcess::NormalExit);
+    QVERIFY2(proc.exitCode() == 0, proc.readAllStandardError().constData());
+
+    QTranslator translator;
+    QVERIFY(translator.load(dataDir + "translate.qm"));
+    QVERIFY(translator.load(dataDir + "compressed.qm"));
+}
+
+void tst_lrelease::incremental()
+{
+    const QString qmFile = dataDir + "idbased.qm";
+    QFile::remove(qmFile);
+    QFile::remove(qmFile + ".stamp");
+    const QStringList args = { "-incremental", "-idbased", dataDir + "idbased.ts" };
+
+    QProcess proc;
+    proc.start(lrelease, args);
+    QVERIFY(proc.waitForFinished());
+    QCOMPARE(proc.exitCode(), 0);
+    QVERIFY(!proc.readAllStandardOutput().contains("is up to date"));
+    QVERIFY(QFile::exists(qmFile + ".stamp"));
+
+    // Make sure the QM file is newer than the TS file.
+    QFile ts(dataDir + "idbased.ts");
+    QVERIFY(ts.open(QIODevice::ReadOnly));
+    QVERIFY(ts.setFileTime(QDateTime::currentDateTime().addSecs(-60),
+                           QFileDevice::FileModificationTime));
+    ts.close();
+
+    proc.start(lrelease, args);
+    QVERIFY(proc.waitForFinished());
+    QCOMPARE(proc.exitCode(), 0);
+    QVERIFY(proc.readAllStandardOutput().contains("is up to date"));
+
+    // Different options make it release again.
+    proc.start(lrelease, QStringList(args) << "-nounfinished");
+    QVERIFY(proc.waitForFinished());
+    QCOMPARE(proc.exitCode(), 0);
+    QVERIFY(!proc.readAllStandardOutput().contains("is up to date"));
+
+    QFile::remove(qmFile + ".stamp");
+}
+
 QTEST_MAIN(tst_lrelease)
 #include "tst_lrelease.moc"
@@ -46,6 +46,8 @@ public:
 private slots:
     void good_data();
     void good();
+    void parseCache();
+    void parseCacheInvalidation();
 #if CHECK_SIMTEXTH
     void simtexth();
     void simtexth_data();
@@ -313,6 +315,141 @@ void tst_lupdate::good()
                   dir + QLatin1Char('/') + ts + QLatin1String(".result"), false);
 }
 
+void tst_lupdate::parseCache()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString cacheDir = tempDir.filePath(QLatin1String("cache"));
+    const QString sourceDir = m_basePath + QLatin1String("recursivescan");
+
+    QString outputs[2];
+    for (int run = 0; run < 2; ++run) {
+        const QString ts = tempDir.filePath(QString::fromLatin1("run%1.ts").arg(run));
+        QProcess proc;
+        proc.setProcessChannelMode(QProcess::MergedChannels);
+        proc.start(m_cmdLupdate, { QLatin1String("-cache-dir"), cacheDir, sourceDir,
+                                   QLatin1String("-ts"), ts });
+        QVERIFY2(proc.waitForFinished(30000), qPrintable(proc.errorString()));
+        QCOMPARE(proc.exitCode(), 0);
+        const QString output = QString::fromLocal8Bit(proc.readAll());
+        if (run == 1)
+            QVERIFY2(output.contains(QLatin1String(", 0 file(s) parsed.")), qPrintable(output));
+
+        QFile file(ts);
+        QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+        outputs[run] = QString::fromUtf8(file.readAll());
+    }
+    QVERIFY(!QDir(cacheDir).isEmpty());
+    QCOMPARE(outputs[1], outputs[0]);
+}
+
+static bool writeSource(const QString &fileName, const QByteArray &contents)
+{
+    QFile file(fileName);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(contents) >= 0;
+}
+
+void tst_lupdate::parseCacheInvalidation()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString cacheDir = tempDir.filePath(QLatin1String("cache"));
+    const QString sourceDir = tempDir.filePath(QLatin1String("sources"));
+    QVERIFY(QDir().mkpath(sourceDir));
+
+    // The context of the message in main.cpp comes from the header it includes.
+    QVERIFY(writeSource(sourceDir + QLatin1String("/widget.h"),
+                        "namespace Before {\n"
+                        "class Widget : public QObject\n"
+                        "{\n"
+                        "    Q_OBJECT\n"
+                        "    QString text();\n"
+                        "};\n"
+                        "}\n"));
+    QVERIFY(writeSource(sourceDir + QLatin1String("/main.cpp"),
+                        "#include \"widget.h\"\n"
+                        "using namespace Before;\n"
+                        "QString Widget::text() { return tr(\"Widget text\"); }\n"));
+    QVERIFY(writeSource(sourceDir + QLatin1String("/other.cpp"),
+                        "class Other : public QObject\n"
+                        "{\n"
+                        "    Q_OBJECT\n"
+                        "    QString text() { return tr(\"Other text\"); }\n"
+                        "};\n"));
+
+    const QString ts = tempDir.filePath(QLatin1String("out.ts"));
+    const auto runLupdate = [&](QString *output, QString *tsContents) {
+        QFile::remove(ts);
+        QProcess proc;
+        proc.setProcessChannelMode(QProcess::MergedChannels);
+        proc.start(m_cmdLupdate, { QLatin1String("-cache-dir"), cacheDir, sourceDir,
+                                   QLatin1String("-ts"), ts });
+        QVERIFY2(proc.waitForFinished(30000), qPrintable(proc.errorString()));
+        *output = QString::fromLocal8Bit(proc.readAll());
+        QVERIFY2(proc.exitCode() == 0, qPrintable(*output));
+        QFile file(ts);
+        QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+        *tsContents = QString::fromUtf8(file.readAll());
+    };
+
+    QString output;
+    QString tsContents;
+    runLupdate(&output, &tsContents);
+    if (QTest::currentTestFailed())
+        return;
+    QVERIFY2(tsContents.contains(QLatin1String("<name>Before::Widget</name>")),
+             qPrintable(tsContents));
+    const int entryCount = QDir(cacheDir).entryList(QDir::Files).count();
+    QCOMPARE(entryCount, 3);
+
+    // Editing the header parses it and the file including it again,
+    // the other file is taken from the cache.
+    QVERIFY(writeSource(sourceDir + QLatin1String("/widget.h"),
+                        "namespace After {\n"
+                        "class Widget : public QObject\n"
+                        "{\n"
+                        "    Q_OBJECT\n"
+                        "    QString text();\n"
+                        "};\n"
+                        "}\n"));
+    QVERIFY(writeSource(sourceDir + QLatin1String("/main.cpp"),
+                        "#include \"widget.h\"\n"
+                        "using namespace After;\n"
+                        "QString Widget::text() { return tr(\"Widget text\"); }\n"));
+    runLupdate(&output, &tsContents);
+    if (QTest::currentTestFailed())
+        return;
+    QVERIFY2(output.contains(QLatin1String("1 file(s) reused, 2 file(s) parsed.")),
+             qPrintable(output));
+    QVERIFY2(tsContents.contains(QLatin1String("<name>After::Widget</name>")),
+             qPrintable(tsContents));
+    QVERIFY(!tsContents.contains(QLatin1String("<name>Before::Widget</name>")));
+
+    // Only editing the header parses main.cpp again as well.
+    QVERIFY(writeSource(sourceDir + QLatin1String("/widget.h"),
+                        "namespace After {\n"
+                        "class Widget : public QObject\n"
+                        "{\n"
+                        "    Q_OBJECT\n"
+                        "public:\n"
+                        "    QString text();\n"
+                        "};\n"
+                        "}\n"));
+    runLupdate(&output, &tsContents);
+    if (QTest::currentTestFailed())
+        return;
+    QVERIFY2(output.contains(QLatin1String("1 file(s) reused, 2 file(s) parsed.")),
+             qPrintable(output));
+
+    // The entry of a removed file is pruned.
+    QVERIFY(QFile::remove(sourceDir + QLatin1String("/other.cpp")));
+    runLupdate(&output, &tsContents);
+    if (QTest::currentTestFailed())
+        return;
+    QVERIFY(!tsContents.contains(QLatin1String("Other text")));
+    QCOMPARE(QDir(cacheDir).entryList(QDir::Files).count(), entryCount - 1);
+}
+
 #if CHECK_SIMTEXTH
 void tst_lupdate::simtexth()
 {
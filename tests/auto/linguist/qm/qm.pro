@@ -0,0 +1,8 @@
+CONFIG += testcase
+QT = core-private testlib
+TARGET = tst_qm
+DEFINES += QT_NO_CAST_FROM_ASCII QT_NO_CAST_TO_ASCII
+
+include(../../../../src/linguist/shared/formats.pri)
+
+SOURCES += tst_qm.cpp
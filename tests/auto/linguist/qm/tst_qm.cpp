@@ -0,0 +1,266 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "translator.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QFile>
+#include <QtTest/QtTest>
+
+QT_BEGIN_NAMESPACE
+
+bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd);
+
+QT_END_NAMESPACE
+
+class tst_qm : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void sameOutput_data();
+    void sameOutput();
+    void reader();
+    void truncated();
+    void unterminatedMessage_data();
+    void unterminatedMessage();
+};
+
+static TranslatorMessage message(const QString &context, const QString &sourceText,
+                                 const QString &comment, const QString &translation,
+                                 TranslatorMessage::Type type = TranslatorMessage::Finished)
+{
+    TranslatorMessage msg(context, sourceText, comment, QString(), QString(), 0,
+                          QStringList(translation));
+    msg.setType(type);
+    return msg;
+}
+
+// Messages which exercise all the prefixes the writer can leave out,
+// dropped comments, duplicates and many contexts per hash bucket.
+static Translator testTranslator(int contexts)
+{
+    Translator tor;
+    tor.setLanguageCode(QLatin1String("de_DE"));
+    tor.setDependencies(QStringList() << QLatin1String("qtbase_de.qm"));
+    for (int c = 0; c < contexts; ++c) {
+        const QString context = QString::fromLatin1("Context%1").arg(c);
+        tor.append(message(context, QLatin1String("Open"), QString(),
+                           QString::fromUtf8("\xc3\x96" "ffnen")));
+        tor.append(message(context, QLatin1String("Open"), QLatin1String("menu"),
+                           QString::fromUtf8("\xc3\x96" "ffnen...")));
+        tor.append(message(context, QLatin1String("Close"), QLatin1String("menu"),
+                           QString::fromUtf8("Schlie\xc3\x9f" "en")));
+        tor.append(message(context, QLatin1String("Close"), QLatin1String("button"),
+                           QLatin1String("Zumachen")));
+        // Same hash as "Open" + "menu", but different source text and comment.
+        tor.append(message(context, QLatin1String("Openm"), QLatin1String("enu"),
+                           QLatin1String("Offenm")));
+        tor.append(message(context, QLatin1String("Ope"), QLatin1String("nmenu"),
+                           QLatin1String("Offe")));
+        tor.append(message(context, QString::fromLatin1("Unfinished %1").arg(c), QString(),
+                           QString(), TranslatorMessage::Unfinished));
+        tor.append(message(context, QLatin1String("Obsolete"), QString(),
+                           QLatin1String("Veraltet"), TranslatorMessage::Obsolete));
+        TranslatorMessage plural = message(context, QLatin1String("%n file(s)"), QString(),
+                                           QString());
+        plural.setPlural(true);
+        plural.setTranslations(QStringList() << QLatin1String("%n Datei")
+                                             << QLatin1String("%n Dateien"));
+        tor.append(plural);
+        TranslatorMessage idBased = message(QString(), QLatin1String("Save"), QString(),
+                                            QLatin1String("Speichern"));
+        idBased.setId(QString::fromLatin1("id_save_%1").arg(c % 7));
+        tor.append(idBased);
+    }
+    tor.append(message(QString(), QLatin1String("No context"), QLatin1String("comment"),
+                       QLatin1String("Kein Kontext")));
+    tor.append(message(QLatin1String("Empty"), QString(), QString(), QLatin1String("Leer")));
+    return tor;
+}
+
+// The files in testdata/ were written by the QM writer as it was before
+// it stopped going through QMap and QDataStream. The output of saveQM()
+// must stay identical to them.
+void tst_qm::sameOutput_data()
+{
+    QTest::addColumn<int>("contexts");
+    QTest::addColumn<int>("saveMode");
+    QTest::addColumn<bool>("idBased");
+    QTest::addColumn<QString>("unTrPrefix");
+    QTest::addColumn<QString>("expectedFile");
+
+    for (int contexts : { 0, 1, 59, 250 }) {
+        const QByteArray name = QByteArray::number(contexts) + " contexts, ";
+        const QString file = QString::fromLatin1("testdata/%1-%2.qm").arg(contexts);
+        QTest::newRow((name + "everything").constData())
+                << contexts << int(SaveEverything) << false << QString()
+                << file.arg(QLatin1String("everything"));
+        QTest::newRow((name + "stripped").constData())
+                << contexts << int(SaveStripped) << false << QString()
+                << file.arg(QLatin1String("stripped"));
+        QTest::newRow((name + "markuntranslated").constData())
+                << contexts << int(SaveStripped) << false << QString::fromLatin1("#")
+                << file.arg(QLatin1String("markuntranslated"));
+        QTest::newRow((name + "idbased").constData())
+                << contexts << int(SaveEverything) << true << QString()
+                << file.arg(QLatin1String("idbased"));
+    }
+}
+
+void tst_qm::sameOutput()
+{
+    QFETCH(int, contexts);
+    QFETCH(int, saveMode);
+    QFETCH(bool, idBased);
+    QFETCH(QString, unTrPrefix);
+    QFETCH(QString, expectedFile);
+
+    const Translator tor = testTranslator(contexts);
+
+    const QString expectedPath = QFINDTESTDATA(expectedFile);
+    QVERIFY2(!expectedPath.isEmpty(), qPrintable(expectedFile));
+    QFile file(expectedPath);
+    QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(file.errorString()));
+    const QByteArray expected = file.readAll();
+
+    QByteArray actual;
+    {
+        ConversionData cd;
+        cd.m_saveMode = TranslatorSaveMode(saveMode);
+        cd.m_idBased = idBased;
+        cd.m_unTrPrefix = unTrPrefix;
+        QBuffer buffer(&actual);
+        QVERIFY(buffer.open(QIODevice::WriteOnly));
+        QVERIFY(saveQM(tor, buffer, cd));
+    }
+
+    QCOMPARE(actual.size(), expected.size());
+    QVERIFY(actual == expected);
+}
+
+static QByteArray qmData(const Translator &tor)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    ConversionData cd;
+    saveQM(tor, buffer, cd);
+    return data;
+}
+
+void tst_qm::reader()
+{
+    const Translator tor = testTranslator(59);
+    QByteArray data = qmData(tor);
+
+    Translator loaded;
+    {
+        QBuffer buffer(&data);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+        ConversionData cd;
+        QVERIFY2(loadQM(loaded, buffer, cd), qPrintable(cd.error()));
+    }
+    QCOMPARE(loaded.languageCode(), tor.languageCode());
+    QCOMPARE(loaded.dependencies(), tor.dependencies());
+
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    ConversionData cd;
+    QMReader reader;
+    QVERIFY(reader.open(buffer, cd));
+    QCOMPARE(reader.languageCode(), tor.languageCode());
+    QCOMPARE(reader.dependencies(), tor.dependencies());
+    QCOMPARE(reader.messageCount(), loaded.messageCount());
+
+    int i = 0;
+    bool found = false;
+    TranslatorMessage msg;
+    while (reader.readMessage(&msg)) {
+        QVERIFY(i < loaded.messageCount());
+        const TranslatorMessage &expected = loaded.message(i++);
+        QCOMPARE(msg.context(), expected.context());
+        QCOMPARE(msg.sourceText(), expected.sourceText());
+        QCOMPARE(msg.comment(), expected.comment());
+        QCOMPARE(msg.translations(), expected.translations());
+        QCOMPARE(msg.isPlural(), expected.isPlural());
+        if (msg.context() == QLatin1String("Context3") && msg.sourceText() == QLatin1String("Open")
+            && msg.comment() == QLatin1String("menu")) {
+            QCOMPARE(msg.translation(), QString::fromUtf8("\xc3\x96" "ffnen..."));
+            found = true;
+        }
+    }
+    QVERIFY(reader.atEnd());
+    QCOMPARE(i, loaded.messageCount());
+    QVERIFY(found);
+    QVERIFY2(reader.finish(cd), qPrintable(cd.error()));
+}
+
+void tst_qm::truncated()
+{
+    QByteArray data = qmData(testTranslator(59));
+    data.chop(data.size() / 2);
+
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    ConversionData cd;
+    Translator loaded;
+    QVERIFY(!loadQM(loaded, buffer, cd));
+    QVERIFY(!cd.error().isEmpty());
+}
+
+void tst_qm::unterminatedMessage_data()
+{
+    QTest::addColumn<char>("tag");
+
+    QTest::newRow("unknown tag") << char(0);
+    QTest::newRow("obsolete tag") << char(5);
+}
+
+void tst_qm::unterminatedMessage()
+{
+    QFETCH(char, tag);
+
+    QByteArray data = qmData(testTranslator(1));
+    // The numerus rules (tag, length and two rules) follow the messages,
+    // so the Tag_End of the last message comes right before them.
+    const int endTag = data.size() - 8;
+    QCOMPARE(data.at(endTag), char(1));
+    QCOMPARE(uchar(data.at(endTag + 1)), uchar(0x88));
+    data[endTag] = tag;
+
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    ConversionData cd;
+    Translator loaded;
+    QVERIFY(!loadQM(loaded, buffer, cd));
+    QVERIFY(!cd.error().isEmpty());
+}
+
+QTEST_APPLESS_MAIN(tst_qm)
+#include "tst_qm.moc"
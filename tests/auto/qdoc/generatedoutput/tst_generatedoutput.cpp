@@ -67,6 +67,7 @@ private slots:
     void dontDocument();
     void inheritedQmlPropertyGroups();
     void crossModuleLinking();
+    void crossModuleLinkingBinaryIndex();
     void includeFromExampleDirs();
     void singleExec();
     void preparePhase();
@@ -76,6 +77,7 @@ private slots:
     void headerFile();
     void usingDirective();
     void properties();
+    void pchCache();
 
 private:
     QScopedPointer<QTemporaryDir> m_outputDir;
@@ -88,7 +90,7 @@ private:
     void compareLineByLine(const QStringList &expectedFiles);
     void testAndCompare(const char *input, const char *outNames, const char *extraParams = nullptr,
                         const char *outputPathPrefix = nullptr);
-    void copyIndexFiles();
+    void copyIndexFiles(const QStringList &nameFilters = QStringList("*.index"));
 };
 
 void tst_generatedOutput::initTestCase()
@@ -206,9 +208,9 @@ void tst_generatedOutput::testAndCompare(const char *input, const char *outNames
 }
 
 // Copy <project>.index to <project>/<project>.index in the outputdir
-void tst_generatedOutput::copyIndexFiles()
+void tst_generatedOutput::copyIndexFiles(const QStringList &nameFilters)
 {
-    QDirIterator it(m_outputDir->path(), QStringList("*.index"), QDir::Files, QDirIterator::Subdirectories);
+    QDirIterator it(m_outputDir->path(), nameFilters, QDir::Files, QDirIterator::Subdirectories);
     while (it.hasNext()) {
         QFileInfo fileInfo(it.next());
         QDir indexDir(m_outputDir->path());
@@ -402,6 +404,36 @@ void tst_generatedOutput::crossModuleLinking()
                    indexDir.toLatin1().data());
 }
 
+void tst_generatedOutput::crossModuleLinkingBinaryIndex()
+{
+    htmlFromCpp();
+    copyIndexFiles();
+    // Copy the binary index last; it is ignored if it is older than the XML index
+    copyIndexFiles(QStringList("*.index.bin"));
+
+    // Blank out the XML indexes, keeping their size and modification time,
+    // so that the links below can only come from the binary indexes.
+    QDirIterator it(m_outputDir->path(), QStringList("*.index.bin"), QDir::Files,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QFileInfo binaryIndex(it.next());
+        QFile xmlIndex(binaryIndex.filePath().chopped(4));
+        const qint64 size = xmlIndex.size();
+        QVERIFY(size > 0);
+        QVERIFY(xmlIndex.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QCOMPARE(xmlIndex.write(QByteArray(size, ' ')), size);
+        QVERIFY(xmlIndex.flush());
+        QVERIFY(xmlIndex.setFileTime(binaryIndex.lastModified(),
+                                     QFileDevice::FileModificationTime));
+    }
+
+    QString indexDir = QLatin1String("-indexdir ") +  m_outputDir->path();
+    testAndCompare("testdata/crossmodule/crossmodule.qdocconf",
+                   "crossmodule/testtype.html "
+                   "crossmodule/testtype-members.html",
+                   indexDir.toLatin1().data());
+}
+
 void tst_generatedOutput::includeFromExampleDirs()
 {
     testAndCompare("testdata/includefromexampledirs/includefromexampledirs.qdocconf",
@@ -486,6 +518,88 @@ void tst_generatedOutput::properties()
                    m_extraParams.toLatin1().data());
 }
 
+static bool writeFile(const QString &fileName, const QByteArray &contents)
+{
+    QFile file(fileName);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(contents) >= 0;
+}
+
+void tst_generatedOutput::pchCache()
+{
+    // The sources are written to the output directory, so that they can be changed.
+    const QString sourceDir = m_outputDir->filePath("sources");
+    const QString cacheDir = m_outputDir->filePath("cache");
+    QVERIFY(QDir().mkpath(sourceDir));
+    const QByteArray header = "namespace PchCache {\n"
+                              "class Widget\n"
+                              "{\n"
+                              "public:\n"
+                              "    void show();\n"
+                              "};\n"
+                              "}\n";
+    QVERIFY(writeFile(sourceDir + "/pchcache.h", header));
+    QVERIFY(writeFile(sourceDir + "/pchcache.cpp",
+                      "#include \"pchcache.h\"\n"
+                      "namespace PchCache {\n"
+                      "void Widget::show() {}\n"
+                      "}\n"));
+    QVERIFY(writeFile(sourceDir + "/pchcache.qdocconf",
+                      "project = PchCache\n"
+                      "includepaths = -I.\n"
+                      "headers = pchcache.h\n"
+                      "sources = pchcache.cpp\n"
+                      "headers.fileextensions = \"*.h\"\n"
+                      "sources.fileextensions = \"*.cpp\"\n"
+                      "outputformats = HTML\n"));
+    const QStringList args { "-outputdir", m_outputDir->filePath("html"),
+                             "-cache-dir", cacheDir, sourceDir + "/pchcache.qdocconf" };
+
+    runQDocProcess(args);
+    if (QTest::currentTestFailed())
+        return;
+    const QStringList pchDirs = QDir(cacheDir).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    QCOMPARE(pchDirs.size(), 1);
+    QVERIFY(pchDirs.first().startsWith("PchCache-"));
+    const QString pchDir = cacheDir + QLatin1Char('/') + pchDirs.first();
+    const QString pchFile = pchDir + "/PchCache.pch";
+    const QString depsFile = pchDir + "/PchCache.deps";
+    QVERIFY(QFile::exists(pchFile));
+    QVERIFY(QFile::exists(depsFile));
+
+    // Backdate the PCH, so that rebuilding it is noticed.
+    const QDateTime backdated(QDate(2000, 1, 1), QTime(0, 0));
+    const auto setPchTime = [&]() {
+        QFile file(pchFile);
+        return file.open(QIODevice::ReadWrite)
+                && file.setFileTime(backdated, QFileDevice::FileModificationTime);
+    };
+    QVERIFY(setPchTime());
+
+    // Nothing changed, the PCH is reused.
+    runQDocProcess(args);
+    if (QTest::currentTestFailed())
+        return;
+    QCOMPARE(QFileInfo(pchFile).lastModified(), backdated);
+
+    // Changing a header the PCH includes rebuilds it, and removes
+    // the PCHs cached for the module under other keys.
+    const QString outdatedDir = cacheDir + "/PchCache-" + QString(40, QLatin1Char('0'));
+    QVERIFY(QDir().mkpath(outdatedDir));
+    QVERIFY(writeFile(sourceDir + "/pchcache.h", header + "// changed\n"));
+    runQDocProcess(args);
+    if (QTest::currentTestFailed())
+        return;
+    QVERIFY(QFileInfo(pchFile).lastModified() != backdated);
+    QVERIFY(!QFileInfo::exists(outdatedDir));
+    QCOMPARE(QDir(cacheDir).entryList(QDir::Dirs | QDir::NoDotAndDotDot), pchDirs);
+
+    QFile deps(depsFile);
+    QVERIFY(deps.open(QIODevice::ReadOnly | QIODevice::Text));
+    const QByteArray depsContents = deps.readAll();
+    QVERIFY2(depsContents.contains(QByteArray::number(header.size() + 11) + '\t'),
+             depsContents.constData());
+}
+
 int main(int argc, char *argv[])
 {
     tst_generatedOutput tc;
@@ -31,6 +31,8 @@
 #include <QtCore/QUrl>
 #include <QtCore/QFileInfo>
 
+#include <QtTest/QAbstractItemModelTester>
+
 #include <QtHelp/QHelpEngine>
 #include <QtHelp/QHelpContentWidget>
 
@@ -76,6 +78,8 @@ private slots:
 
     void setupContents();
     void contentItemAt();
+    void fetchMore();
+    void modelTester();
 
 private:
     QString m_colFile;
@@ -161,5 +165,81 @@ void tst_QHelpContentModel::contentItemAt()
     QCOMPARE(item->title(), QString("Test Manual"));
 }
 
+void tst_QHelpContentModel::fetchMore()
+{
+    QHelpEngine h(m_colFile, 0);
+    h.setReadOnly(false);
+    QHelpContentModel *m = h.contentModel();
+    SignalWaiter w;
+    connect(m, SIGNAL(contentsCreated()),
+        &w, SLOT(stopWaiting()));
+    w.start();
+    h.setupData();
+    int i = 0;
+    while (w.isRunning() && i++ < 10)
+        QTest::qWait(500);
+
+    QModelIndex root = m->index(2, 0);
+    if (!root.isValid())
+        QFAIL("Cannot retrieve root item!");
+
+    // the rows are announced only when fetched, the items know their children anyway
+    QVERIFY(m->hasChildren(root));
+    QVERIFY(m->canFetchMore(root));
+    QCOMPARE(m->rowCount(root), 0);
+    QVERIFY(m->contentItemAt(root)->childCount() > 4);
+
+    m->fetchMore(root);
+    QVERIFY(!m->canFetchMore(root));
+    QVERIFY(m->rowCount(root) > 4);
+
+    const QModelIndex child = m->index(4, 0, root);
+    QCOMPARE(m->contentItemAt(child)->title(), QString("qmake Concepts"));
+    QCOMPARE(m->parent(child), root);
+}
+
+// Expands every item, and returns the number of items below parent.
+static int fetchAll(QHelpContentModel *model, const QModelIndex &parent)
+{
+    if (model->canFetchMore(parent))
+        model->fetchMore(parent);
+    int count = model->rowCount(parent);
+    for (int row = 0; row < model->rowCount(parent); ++row)
+        count += fetchAll(model, model->index(row, 0, parent));
+    return count;
+}
+
+void tst_QHelpContentModel::modelTester()
+{
+    QHelpEngine h(m_colFile, 0);
+    h.setReadOnly(false);
+    QHelpContentModel *m = h.contentModel();
+    SignalWaiter w;
+    connect(m, SIGNAL(contentsCreated()),
+        &w, SLOT(stopWaiting()));
+    w.start();
+    h.setupData();
+    int i = 0;
+    while (w.isRunning() && i++ < 10)
+        QTest::qWait(500);
+
+    QAbstractItemModelTester tester(m, QAbstractItemModelTester::FailureReportingMode::QtTest);
+
+    QVERIFY(fetchAll(m, QModelIndex()) > m->rowCount());
+    QVERIFY(!QTest::currentTestFailed());
+
+    // The items expanded by the view are fetched as well
+    w.start();
+    h.setCurrentFilter("Custom Filter 1");
+    i = 0;
+    while (w.isRunning() && i++ < 10)
+        QTest::qWait(500);
+
+    QHelpContentWidget *view = h.contentWidget();
+    view->expandAll();
+    QVERIFY(fetchAll(m, QModelIndex()) > m->rowCount());
+    QVERIFY(!QTest::currentTestFailed());
+}
+
 QTEST_MAIN(tst_QHelpContentModel)
 #include "tst_qhelpcontentmodel.moc"
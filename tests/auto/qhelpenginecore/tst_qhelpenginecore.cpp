@@ -63,6 +63,7 @@ private slots:
     void filterAttributeSets();
     void files();
     void fileData();
+    void fileDataCache();
 
     void customValue();
     void setCustomValue();
@@ -380,6 +381,29 @@ void tst_QHelpEngineCore::fileData()
     QCOMPARE(s.readAll(), ts.readAll());
 }
 
+void tst_QHelpEngineCore::fileDataCache()
+{
+    const QUrl url("qthelp://trolltech.com.1.0.0.test/testFolder/test.html");
+    QHelpEngineCore help(m_colFile, 0);
+    help.setReadOnly(false);
+    QCOMPARE(help.fileDataCacheSize(), qint64(16 * 1024 * 1024));
+    QCOMPARE(help.setupData(), true);
+
+    const QByteArray first = help.fileData(url);
+    QVERIFY(!first.isEmpty());
+    QCOMPARE(help.fileData(url), first);
+
+    help.setFileDataCacheSize(0);
+    QCOMPARE(help.fileDataCacheSize(), qint64(0));
+    QCOMPARE(help.fileData(url), first);
+
+    // Cached data must not outlive the documentation.
+    help.setFileDataCacheSize(1024 * 1024);
+    QCOMPARE(help.fileData(url), first);
+    QVERIFY(help.unregisterDocumentation("trolltech.com.1.0.0.test"));
+    QCOMPARE(help.fileData(url).size(), 0);
+}
+
 void tst_QHelpEngineCore::customValue()
 {
     QHelpEngineCore help(m_colFile, 0);
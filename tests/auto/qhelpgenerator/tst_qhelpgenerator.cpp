@@ -30,6 +30,7 @@
 #include <QtCore/QFileInfo>
 #include <QtSql/QSqlDatabase>
 #include <QtSql/QSqlQuery>
+#include <QtHelp/private/qhelpfiledatacodec_p.h>
 
 #include "../../../src/assistant/qhelpgenerator/qhelpprojectdata_p.h"
 #include "../../../src/assistant/qhelpgenerator/helpgenerator.h"
@@ -43,6 +44,8 @@ private slots:
     void generateHelp();
     // Check that two runs of the generator creates the same file twice
     void generateTwice();
+    void generateSearchText();
+    void generateZstd();
 
 private:
     void checkNamespace();
@@ -50,6 +53,7 @@ private:
     void checkIndices();
     void checkFiles();
     void checkMetaData();
+    QString generateTestProject(HelpGenerator *generator, const QString &outputName);
 
     QString m_outputFile;
     QSqlQuery *m_query;
@@ -221,5 +225,86 @@ void tst_QHelpGenerator::generateTwice()
     QCOMPARE(arr1, arr2);
 }
 
+// Generates the file outputName in the data directory from test.qhp,
+// returns its path or an empty string if that failed.
+QString tst_QHelpGenerator::generateTestProject(HelpGenerator *generator,
+                                                const QString &outputName)
+{
+    // defined in profile
+    const QString path = QLatin1String(SRCDIR) + QLatin1String("/data/");
+
+    QHelpProjectData data;
+    if (!data.readData(path + QLatin1String("test.qhp")))
+        return QString();
+
+    const QString outputFile = path + outputName;
+    return generator->generate(&data, outputFile) ? outputFile : QString();
+}
+
+void tst_QHelpGenerator::generateSearchText()
+{
+    HelpGenerator generator;
+    generator.setStoreSearchText(true);
+    const QString outputFile = generateTestProject(&generator, QLatin1String("searchtext.qch"));
+    QVERIFY(!outputFile.isEmpty());
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "searchtextdb");
+        db.setDatabaseName(outputFile);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+
+        query.exec("SELECT Value FROM MetaDataTable WHERE Name=\'searchTextVersion\'");
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0).toInt(), 2);
+
+        QMap<QString, QString> titles;
+        query.exec("SELECT a.Name, b.Title FROM FileNameTable a, SearchTextTable b "
+            "WHERE a.FileId=b.FileId");
+        while (query.next())
+            titles.insert(query.value(0).toString(), query.value(1).toString());
+        QCOMPARE(titles.value("test.html"), QString("Test Manual"));
+        QCOMPARE(titles.value("people.html"), QString("People"));
+        QVERIFY(!titles.contains("classic.css"));
+    }
+    QSqlDatabase::removeDatabase("searchtextdb");
+    QFile::remove(outputFile);
+}
+
+void tst_QHelpGenerator::generateZstd()
+{
+    if (!QHelpFileDataCodec::isSupported(QHelpFileDataCodec::Zstd))
+        QSKIP("Qt Help was built without zstd support.");
+
+    HelpGenerator generator;
+    generator.setFileDataCodec(QHelpFileDataCodec::Zstd);
+    const QString outputFile = generateTestProject(&generator, QLatin1String("zstd.qch"));
+    QVERIFY(!outputFile.isEmpty());
+
+    QFile htmlFile(QLatin1String(SRCDIR) + QLatin1String("/data/test.html"));
+    QVERIFY(htmlFile.open(QIODevice::ReadOnly));
+    const QByteArray html = htmlFile.readAll();
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "zstddb");
+        db.setDatabaseName(outputFile);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+
+        query.exec("SELECT Value FROM MetaDataTable WHERE Name=\'fileDataCodec\'");
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0).toInt(), int(QHelpFileDataCodec::Zstd));
+
+        query.exec("SELECT b.Data FROM FileNameTable a, FileDataTable b "
+            "WHERE a.FileId=b.Id AND a.Name=\'test.html\'");
+        QVERIFY(query.next());
+        const QByteArray compressed = query.value(0).toByteArray();
+        QVERIFY(compressed != qCompress(html));
+        QCOMPARE(QHelpFileDataCodec::uncompress(compressed, QHelpFileDataCodec::Zstd), html);
+    }
+    QSqlDatabase::removeDatabase("zstddb");
+    QFile::remove(outputFile);
+}
+
 QTEST_MAIN(tst_QHelpGenerator)
 #include "tst_qhelpgenerator.moc"
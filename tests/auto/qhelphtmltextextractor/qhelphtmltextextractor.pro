@@ -0,0 +1,8 @@
+TARGET = tst_qhelphtmltextextractor
+CONFIG += testcase
+
+SOURCES += tst_qhelphtmltextextractor.cpp
+
+QT      += help-private testlib
+
+DEFINES += QT_USE_USING_NAMESPACE
@@ -0,0 +1,154 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include <QtTest/QtTest>
+
+#include <QtHelp/private/qhelphtmltextextractor_p.h>
+
+class tst_QHelpHtmlTextExtractor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void extract_data();
+    void extract();
+    void title_data();
+    void title();
+};
+
+void tst_QHelpHtmlTextExtractor::extract_data()
+{
+    QTest::addColumn<QByteArray>("html");
+    QTest::addColumn<QString>("title");
+    QTest::addColumn<QString>("text");
+
+    QTest::newRow("empty") << QByteArray() << QString() << QString();
+    QTest::newRow("plain") << QByteArray("just text") << QString()
+                           << QString::fromLatin1("just text");
+    QTest::newRow("title")
+            << QByteArray("<html><head><title>  Qt &amp; Widgets\n Guide </title></head>"
+                          "<body>Hello</body></html>")
+            << QString::fromLatin1("Qt & Widgets Guide") << QString::fromLatin1("Hello");
+    QTest::newRow("head content")
+            << QByteArray("<head><meta charset=\"utf-8\"><title>T</title>"
+                          "<style>p { color: red; }</style>"
+                          "<script>if (a < b) x = '</p>';</script>ignored</head><body>Body</body>")
+            << QString::fromLatin1("T") << QString::fromLatin1("Body");
+    QTest::newRow("script in body")
+            << QByteArray("<p>a<SCRIPT type=\"x\">hidden</script >b</p><style/>c")
+            << QString() << QString::fromLatin1("ab\nc");
+    QTest::newRow("comment")
+            << QByteArray("a<!-- <p>not</p> -->b<!---->c<!DOCTYPE html>d<?xml?>e")
+            << QString() << QString::fromLatin1("abcde");
+    QTest::newRow("whitespace")
+            << QByteArray("  <p> First   line\n with <b>bold</b>\ttext. </p> ")
+            << QString() << QString::fromLatin1("First line with bold text.");
+    QTest::newRow("blocks")
+            << QByteArray("<h1>Head</h1><p>one</p><ul><li>two</li><li>three</li></ul>four<br/>five")
+            << QString() << QString::fromLatin1("Head\none\ntwo\nthree\nfour\nfive");
+    QTest::newRow("pre")
+            << QByteArray("<p>code:</p><pre>int main()\r\n{\n    return 0;\n}</pre>after")
+            << QString()
+            << QString::fromLatin1("code:\nint main()\n{\n    return 0;\n}\nafter");
+    QTest::newRow("references")
+            << QByteArray("&lt;&gt;&quot;&apos;&nbsp;&#65;&#x42;&#X43;&copy;&shy;&mdash;")
+            << QString()
+            << (QString::fromLatin1("<>\"' ABC\xa9") + QChar(0x2014));
+    QTest::newRow("bad references")
+            << QByteArray("a & b &bogus; &amp &#; &#0; &#xd800;")
+            << QString()
+            << (QString::fromLatin1("a & b &bogus; &amp &#; ") + QChar(QChar::ReplacementCharacter)
+                + QLatin1Char(' ') + QChar(QChar::ReplacementCharacter));
+    QTest::newRow("uncommon references")
+            << QByteArray("&alpha;&hearts;&thetasym;") << QString()
+            << (QString(QChar(0x03b1)) + QChar(0x2665) + QChar(0x03d1));
+    QTest::newRow("non-bmp reference")
+            << QByteArray("&#x1F600;") << QString() << QString::fromUcs4(U"\U0001F600");
+    QTest::newRow("stray brackets")
+            << QByteArray("a < b <3 </ c") << QString() << QString::fromLatin1("a < b <3 </ c");
+    QTest::newRow("attributes")
+            << QByteArray("<a title='x > y' href=\"a>b\" data=it's>link</a>")
+            << QString() << QString::fromLatin1("link");
+    QTest::newRow("late title")
+            << QByteArray("<body><p>text</p><title>late</title></body>")
+            << QString::fromLatin1("late") << QString::fromLatin1("text");
+    QTest::newRow("utf-8")
+            << QByteArray("<meta charset=\"utf-8\"><title>Caf\xc3\xa9</title><p>\xc3\xbc</p>")
+            << QString::fromUtf8("Caf\xc3\xa9") << QString::fromUtf8("\xc3\xbc");
+    QTest::newRow("latin-1")
+            << QByteArray("<head><meta charset=\"iso-8859-1\"><title>Caf\xe9</title></head>"
+                          "<p>\xfc</p>")
+            << QString::fromLatin1("Caf\xe9") << QString::fromLatin1("\xfc");
+
+    const QString utf16 = QString::fromLatin1("<title>T\xe9</title><p>x</p>");
+    QByteArray utf16Data("\xff\xfe", 2);
+    for (const QChar c : utf16) {
+        utf16Data.append(char(c.unicode() & 0xff));
+        utf16Data.append(char(c.unicode() >> 8));
+    }
+    QTest::newRow("utf-16") << utf16Data << QString::fromLatin1("T\xe9")
+                            << QString::fromLatin1("x");
+}
+
+void tst_QHelpHtmlTextExtractor::extract()
+{
+    QFETCH(QByteArray, html);
+    QFETCH(QString, title);
+    QFETCH(QString, text);
+
+    QString extractedTitle;
+    QString extractedText = QLatin1String("stale");
+    QHelpHtmlTextExtractor::extract(html, &extractedTitle, &extractedText);
+    QCOMPARE(extractedTitle, title);
+    QCOMPARE(extractedText, text);
+}
+
+void tst_QHelpHtmlTextExtractor::title_data()
+{
+    QTest::addColumn<QString>("html");
+    QTest::addColumn<QString>("title");
+
+    QTest::newRow("none") << QString::fromLatin1("<p>text</p>") << QString();
+    QTest::newRow("simple") << QString::fromLatin1("<TITLE>A &lt; B</TITLE>")
+                            << QString::fromLatin1("A < B");
+    QTest::newRow("after body") << QString::fromLatin1("<body><title>late</title>")
+                                << QString::fromLatin1("late");
+    QTest::newRow("first only") << QString::fromLatin1("<title>one</title><title>two</title>")
+                                << QString::fromLatin1("one");
+}
+
+void tst_QHelpHtmlTextExtractor::title()
+{
+    QFETCH(QString, html);
+    QFETCH(QString, title);
+
+    QCOMPARE(QHelpHtmlTextExtractor::title(html), title);
+    QCOMPARE(QHelpHtmlTextExtractor::title(html.toUtf8()), title);
+}
+
+QTEST_MAIN(tst_QHelpHtmlTextExtractor)
+#include "tst_qhelphtmltextextractor.moc"
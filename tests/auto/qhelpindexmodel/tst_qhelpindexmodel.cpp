@@ -151,6 +151,26 @@ void tst_QHelpIndexModel::filter()
 
     m->filter("qmake");
     QCOMPARE(m->stringList().count(), 11);
+
+    m->filter("QMake");
+    QCOMPARE(m->stringList().count(), 11);
+
+    // typing narrows the previous result
+    m->filter("fo");
+    QCOMPARE(m->stringList().count(), 3);
+    m->filter("foO");
+    QCOMPARE(m->stringList().count(), 2);
+    m->filter("foob");
+    QCOMPARE(m->stringList(), QStringList() << "foobar");
+
+    m->filter("oob");
+    QCOMPARE(m->stringList(), QStringList() << "foobar");
+
+    m->filter("nothing");
+    QCOMPARE(m->stringList().count(), 0);
+
+    const QModelIndex best = m->filter("FOO");
+    QCOMPARE(best.data().toString(), QString("foo"));
 }
 
 QTEST_MAIN(tst_QHelpIndexModel)
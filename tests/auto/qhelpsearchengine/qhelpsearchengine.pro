@@ -0,0 +1,6 @@
+TARGET = tst_qhelpsearchengine
+CONFIG += testcase
+SOURCES += tst_qhelpsearchengine.cpp
+QT      += help sql testlib
+
+DEFINES += QT_USE_USING_NAMESPACE SRCDIR=\\\"$$PWD\\\"
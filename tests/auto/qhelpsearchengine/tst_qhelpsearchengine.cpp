@@ -0,0 +1,398 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QTemporaryDir>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+
+#include <QtHelp/QHelpEngineCore>
+#include <QtHelp/QHelpSearchEngine>
+
+class tst_QHelpSearchEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void updateChangedPages();
+    void resumeCancelledUpdate();
+    void storedSearchText();
+
+private:
+    struct Row
+    {
+        qint64 id;
+        QString data;
+    };
+
+    bool createDocumentation();
+    bool changePages(const QList<int> &numbers, int revision);
+    bool removePage(int number);
+    bool storeSearchText(const QList<int> &numbers);
+    bool touchDocumentation();
+    bool waitForIndexing(void (QHelpSearchEngine::*start)());
+    QMultiHash<QString, Row> indexedRows();
+
+    QScopedPointer<QTemporaryDir> m_dir;
+    QString m_fileName;
+    QDateTime m_lastModified;
+    QHelpEngineCore *m_helpEngine = nullptr;
+    QHelpSearchEngine *m_searchEngine = nullptr;
+};
+
+static const int pageCount = 200;
+
+static QString pageName(int number)
+{
+    return QString::fromLatin1("pages/page%1.html").arg(number);
+}
+
+static QByteArray page(int number, int revision)
+{
+    QByteArray html = "<html><head><title>Page " + QByteArray::number(number)
+            + "</title></head><body><h1>Page " + QByteArray::number(number) + "</h1>";
+    for (int i = 0; i < 20; ++i) {
+        html += "<p>Paragraph " + QByteArray::number(i) + " of page " + QByteArray::number(number)
+                + ", revision" + QByteArray::number(revision) + ".</p>";
+    }
+    return html + "</body></html>";
+}
+
+// Clones the test documentation and adds pageCount pages to it,
+// which are visible with every filter attribute.
+bool tst_QHelpSearchEngine::createDocumentation()
+{
+    const QString source = QLatin1String(SRCDIR) + QLatin1String("/../qhelpenginecore/data/test.qch");
+    if (!QFile::copy(source, m_fileName))
+        return false;
+    QFile::setPermissions(m_fileName, QFile::WriteUser | QFile::ReadUser);
+
+    const QString connectionName = QLatin1String("testCreate");
+    bool ok = true;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QLatin1String("QSQLITE"), connectionName);
+        db.setDatabaseName(m_fileName);
+        ok = db.open() && db.transaction();
+        QSqlQuery dataQuery(db);
+        QSqlQuery nameQuery(db);
+        QSqlQuery filterQuery(db);
+        ok = ok && dataQuery.prepare(QLatin1String("INSERT INTO FileDataTable VALUES(NULL, ?)"))
+                && nameQuery.prepare(QLatin1String("INSERT INTO FileNameTable VALUES(1, ?, ?, ?)"))
+                && filterQuery.prepare(QLatin1String("INSERT INTO FileFilterTable "
+                                                     "SELECT Id, ? FROM FilterAttributeTable"));
+        for (int i = 0; ok && i < pageCount; ++i) {
+            dataQuery.bindValue(0, qCompress(page(i, 0)));
+            ok = dataQuery.exec();
+            const QVariant fileId = dataQuery.lastInsertId();
+            nameQuery.bindValue(0, pageName(i));
+            nameQuery.bindValue(1, fileId);
+            nameQuery.bindValue(2, QString::fromLatin1("Page %1").arg(i));
+            filterQuery.bindValue(0, fileId);
+            ok = ok && nameQuery.exec() && filterQuery.exec();
+        }
+        ok = ok && db.commit();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return ok;
+}
+
+bool tst_QHelpSearchEngine::changePages(const QList<int> &numbers, int revision)
+{
+    const QString connectionName = QLatin1String("testChange");
+    bool ok = true;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QLatin1String("QSQLITE"), connectionName);
+        db.setDatabaseName(m_fileName);
+        ok = db.open() && db.transaction();
+        QSqlQuery query(db);
+        ok = ok && query.prepare(QLatin1String("UPDATE FileDataTable SET Data = ? WHERE Id = "
+                                               "(SELECT FileId FROM FileNameTable WHERE Name = ?)"));
+        for (int number : numbers) {
+            query.bindValue(0, qCompress(page(number, revision)));
+            query.bindValue(1, pageName(number));
+            ok = ok && query.exec() && query.numRowsAffected() == 1;
+        }
+        ok = ok && db.commit();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return ok && touchDocumentation();
+}
+
+bool tst_QHelpSearchEngine::removePage(int number)
+{
+    const QString connectionName = QLatin1String("testRemove");
+    bool ok = true;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QLatin1String("QSQLITE"), connectionName);
+        db.setDatabaseName(m_fileName);
+        ok = db.open();
+        QSqlQuery query(db);
+        ok = ok && query.prepare(QLatin1String("DELETE FROM FileNameTable WHERE Name = ?"));
+        query.bindValue(0, pageName(number));
+        ok = ok && query.exec() && query.numRowsAffected() == 1;
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return ok && touchDocumentation();
+}
+
+// Stores the search text of the given pages in the documentation,
+// the way qhelpgenerator does.
+bool tst_QHelpSearchEngine::storeSearchText(const QList<int> &numbers)
+{
+    const QString connectionName = QLatin1String("testStore");
+    bool ok = true;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QLatin1String("QSQLITE"), connectionName);
+        db.setDatabaseName(m_fileName);
+        ok = db.open() && db.transaction();
+        QSqlQuery query(db);
+        ok = ok && query.exec(QLatin1String("CREATE TABLE SearchTextTable("
+                                            "FileId INTEGER PRIMARY KEY, "
+                                            "Title TEXT, "
+                                            "Contents TEXT )"))
+                && query.exec(QLatin1String("INSERT INTO MetaDataTable "
+                                            "VALUES('searchTextVersion', 2)"))
+                && query.prepare(QLatin1String("INSERT INTO SearchTextTable "
+                                               "SELECT FileId, ?, ? FROM FileNameTable "
+                                               "WHERE Name = ?"));
+        for (int number : numbers) {
+            query.bindValue(0, QString::fromLatin1("Page %1").arg(number));
+            query.bindValue(1, QString::fromLatin1("Stored text of page %1").arg(number));
+            query.bindValue(2, pageName(number));
+            ok = ok && query.exec() && query.numRowsAffected() == 1;
+        }
+        ok = ok && db.commit();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return ok && touchDocumentation();
+}
+
+// Bumps the modification time of the documentation,
+// so that the indexer notices the update.
+bool tst_QHelpSearchEngine::touchDocumentation()
+{
+    m_lastModified = m_lastModified.addSecs(1);
+    QFile file(m_fileName);
+    return file.open(QIODevice::ReadWrite)
+            && file.setFileTime(m_lastModified, QFileDevice::FileModificationTime);
+}
+
+bool tst_QHelpSearchEngine::waitForIndexing(void (QHelpSearchEngine::*start)())
+{
+    QSignalSpy spy(m_searchEngine, &QHelpSearchEngine::indexingFinished);
+    (m_searchEngine->*start)();
+    return spy.wait(60000);
+}
+
+// Returns the rows of the search index, keyed by their attributes and url
+QMultiHash<QString, tst_QHelpSearchEngine::Row> tst_QHelpSearchEngine::indexedRows()
+{
+    QMultiHash<QString, Row> rows;
+    const QString connectionName = QLatin1String("testIndex");
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QLatin1String("QSQLITE"), connectionName);
+        db.setDatabaseName(m_dir->filePath(QLatin1String(".collection/fts")));
+        if (db.open()) {
+            QSqlQuery query(QLatin1String("SELECT id, attributes, url, data FROM info"), db);
+            while (query.next()) {
+                const QString key = query.value(1).toString() + QLatin1Char('\t')
+                        + query.value(2).toString();
+                rows.insert(key, { query.value(0).toLongLong(), query.value(3).toString() });
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return rows;
+}
+
+static QString pageUrl(int number)
+{
+    return QLatin1String("qthelp://trolltech.com.1.0.0.test/testFolder/") + pageName(number);
+}
+
+// Every test starts from freshly indexed documentation in a directory of its own.
+void tst_QHelpSearchEngine::init()
+{
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+
+    m_fileName = m_dir->filePath(QLatin1String("test.qch"));
+    QVERIFY(createDocumentation());
+    m_lastModified = QFileInfo(m_fileName).lastModified();
+
+    m_helpEngine = new QHelpEngineCore(m_dir->filePath(QLatin1String("collection.qhc")));
+    QVERIFY(m_helpEngine->setupData());
+    QVERIFY(m_helpEngine->registerDocumentation(m_fileName));
+
+    m_searchEngine = new QHelpSearchEngine(m_helpEngine);
+    QVERIFY(waitForIndexing(&QHelpSearchEngine::reindexDocumentation));
+}
+
+void tst_QHelpSearchEngine::cleanup()
+{
+    delete m_searchEngine;
+    m_searchEngine = nullptr;
+    delete m_helpEngine;
+    m_helpEngine = nullptr;
+    m_dir.reset();
+}
+
+void tst_QHelpSearchEngine::updateChangedPages()
+{
+    const QMultiHash<QString, Row> before = indexedRows();
+    QVERIFY(!before.isEmpty());
+    for (const QString &key : before.uniqueKeys())
+        QCOMPARE(before.count(key), 1);
+
+    const int changed = 10;
+    const int removed = 20;
+    QVERIFY(changePages({ changed }, 1));
+    QVERIFY(removePage(removed));
+    QVERIFY(waitForIndexing(&QHelpSearchEngine::scheduleIndexDocumentation));
+
+    const QMultiHash<QString, Row> after = indexedRows();
+    int changedRows = 0;
+    int removedRows = 0;
+    for (auto it = before.cbegin(), end = before.cend(); it != end; ++it) {
+        const QString &key = it.key();
+        if (key.endsWith(pageUrl(removed))) {
+            QVERIFY2(!after.contains(key), qPrintable(key));
+            ++removedRows;
+            continue;
+        }
+        QCOMPARE(after.count(key), 1);
+        const Row row = after.value(key);
+        if (key.endsWith(pageUrl(changed))) {
+            // The changed page is replaced by a new row
+            QVERIFY(row.id != it->id);
+            QVERIFY(row.data.contains(QLatin1String("revision1")));
+            QVERIFY(!row.data.contains(QLatin1String("revision0")));
+            ++changedRows;
+        } else {
+            // The other pages keep their rows
+            QCOMPARE(row.id, it->id);
+        }
+    }
+    QVERIFY(changedRows > 0);
+    QVERIFY(removedRows > 0);
+    QCOMPARE(after.size(), before.size() - removedRows);
+}
+
+void tst_QHelpSearchEngine::resumeCancelledUpdate()
+{
+    const QMultiHash<QString, Row> before = indexedRows();
+
+    // Change every other page, so that there is enough
+    // work left to cancel.
+    QList<int> changed;
+    for (int i = 0; i < pageCount; i += 2)
+        changed.append(i);
+    QVERIFY(changePages(changed, 2));
+
+    {
+        QSignalSpy finished(m_searchEngine, &QHelpSearchEngine::indexingFinished);
+        const QMetaObject::Connection cancel =
+                connect(m_searchEngine, &QHelpSearchEngine::indexingStarted,
+                        m_searchEngine, &QHelpSearchEngine::cancelIndexing);
+        m_searchEngine->scheduleIndexDocumentation();
+        const bool ok = finished.wait(60000);
+        disconnect(cancel);
+        QVERIFY(ok);
+    }
+
+    // The next update picks up where the cancelled one stopped,
+    // whatever it managed to do.
+    QVERIFY(waitForIndexing(&QHelpSearchEngine::scheduleIndexDocumentation));
+
+    const QMultiHash<QString, Row> after = indexedRows();
+    QCOMPARE(after.size(), before.size());
+    for (auto it = before.cbegin(), end = before.cend(); it != end; ++it) {
+        const QString &key = it.key();
+        QCOMPARE(after.count(key), 1);
+        const Row row = after.value(key);
+        bool isChanged = false;
+        for (int number : qAsConst(changed)) {
+            if (key.endsWith(pageUrl(number))) {
+                isChanged = true;
+                break;
+            }
+        }
+        if (isChanged) {
+            QVERIFY(row.data.contains(QLatin1String("revision2")));
+            QVERIFY(!row.data.contains(QLatin1String("revision0")));
+        } else {
+            QCOMPARE(row.id, it->id);
+        }
+    }
+}
+
+void tst_QHelpSearchEngine::storedSearchText()
+{
+    const QMultiHash<QString, Row> before = indexedRows();
+
+    // Only the even pages get their text stored, the
+    // others have to be extracted by the indexer.
+    QList<int> stored;
+    for (int i = 0; i < pageCount; i += 2)
+        stored.append(i);
+    QVERIFY(storeSearchText(stored));
+    QVERIFY(waitForIndexing(&QHelpSearchEngine::scheduleIndexDocumentation));
+
+    const QMultiHash<QString, Row> after = indexedRows();
+    QCOMPARE(after.size(), before.size());
+    int storedRows = 0;
+    int extractedRows = 0;
+    for (auto it = after.cbegin(), end = after.cend(); it != end; ++it) {
+        const QString &key = it.key();
+        QVERIFY2(before.contains(key), qPrintable(key));
+        for (int number = 0; number < pageCount; ++number) {
+            if (!key.endsWith(pageUrl(number)))
+                continue;
+            if (number % 2 == 0) {
+                QCOMPARE(it->data, QString::fromLatin1("Stored text of page %1").arg(number));
+                ++storedRows;
+            } else {
+                QVERIFY(it->data.contains(QLatin1String("revision0")));
+                ++extractedRows;
+            }
+            break;
+        }
+    }
+    QVERIFY(storedRows > 0);
+    QVERIFY(extractedRows > 0);
+}
+
+QTEST_MAIN(tst_QHelpSearchEngine)
+#include "tst_qhelpsearchengine.moc"
@@ -0,0 +1,5 @@
+TEMPLATE = subdirs
+SUBDIRS = linguist help qdoc
+
+!qtHaveModule(help)|cross_compile: SUBDIRS -= help
+cross_compile: SUBDIRS -= qdoc
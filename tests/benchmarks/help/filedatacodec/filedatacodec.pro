@@ -0,0 +1,5 @@
+CONFIG += benchmark
+QT = core help-private testlib
+TARGET = tst_bench_filedatacodec
+
+SOURCES += tst_bench_filedatacodec.cpp
@@ -0,0 +1,148 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QDirIterator>
+
+#include <QtHelp/private/qhelpfiledatacodec_p.h>
+
+// Set QTHELP_BENCHMARK_CORPUS to a directory of generated HTML documentation,
+// like qtbase/doc/qtcore, to measure a real corpus. Otherwise synthetic
+// reference pages are used.
+static const char corpusVariable[] = "QTHELP_BENCHMARK_CORPUS";
+
+class tst_bench_FileDataCodec : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void compress_data();
+    void compress();
+    void uncompress_data();
+    void uncompress();
+
+private:
+    QList<QByteArray> m_pages;
+};
+
+static QByteArray syntheticPage(int members)
+{
+    QByteArray page = "<!DOCTYPE html>\n<html lang=\"en\">\n<head>\n"
+                      "<meta charset=\"utf-8\">\n<title>QWidget Class | Qt Widgets 6.0</title>\n"
+                      "<link rel=\"stylesheet\" type=\"text/css\" href=\"style/offline.css\" />\n"
+                      "</head>\n<body>\n<div class=\"header\" id=\"qtdocheader\">\n"
+                      "<h1 class=\"title\">QWidget Class</h1>\n";
+    for (int i = 0; i < members; ++i) {
+        page += "<h3 class=\"fn\" id=\"member" + QByteArray::number(i) + "\">"
+                "<a name=\"member" + QByteArray::number(i) + "\"></a>"
+                "<span class=\"type\">void</span> QWidget::<span class=\"name\">member"
+                + QByteArray::number(i) + "</span>(<span class=\"type\">int</span> "
+                "<i>value</i>)</h3>\n<p>Sets the property to <i>value</i> &mdash; "
+                "see also <a href=\"qwidget.html#other\">other</a>() &amp; friends.</p>\n";
+    }
+    page += "</div>\n</body>\n</html>\n";
+    return page;
+}
+
+static void addCodecs()
+{
+    QTest::addColumn<int>("codec");
+
+    QTest::newRow("zlib") << int(QHelpFileDataCodec::Zlib);
+    if (QHelpFileDataCodec::isSupported(QHelpFileDataCodec::Zstd))
+        QTest::newRow("zstd") << int(QHelpFileDataCodec::Zstd);
+}
+
+void tst_bench_FileDataCodec::initTestCase()
+{
+    const QString corpus = qEnvironmentVariable(corpusVariable);
+    if (!corpus.isEmpty()) {
+        QDirIterator it(corpus, QStringList() << QLatin1String("*.html"),
+                        QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            QFile file(it.next());
+            if (file.open(QIODevice::ReadOnly))
+                m_pages.append(file.readAll());
+        }
+        QVERIFY2(!m_pages.isEmpty(), qPrintable(corpus + QLatin1String(" contains no HTML files")));
+    } else {
+        // Reference pages are large, most other pages are small.
+        for (int i = 0; i < 200; ++i)
+            m_pages.append(syntheticPage(i % 20 ? 5 + i % 7 : 300));
+    }
+}
+
+void tst_bench_FileDataCodec::compress_data()
+{
+    addCodecs();
+}
+
+void tst_bench_FileDataCodec::compress()
+{
+    QFETCH(int, codec);
+
+    qint64 size = 0;
+    qint64 compressedSize = 0;
+    for (const QByteArray &page : qAsConst(m_pages)) {
+        size += page.size();
+        compressedSize += QHelpFileDataCodec::compress(page, codec).size();
+    }
+    qDebug("%lld pages, %lld bytes, %lld bytes compressed (%.1f%%)",
+           qint64(m_pages.size()), size, compressedSize, 100.0 * compressedSize / size);
+
+    QBENCHMARK {
+        for (const QByteArray &page : qAsConst(m_pages))
+            QHelpFileDataCodec::compress(page, codec);
+    }
+}
+
+void tst_bench_FileDataCodec::uncompress_data()
+{
+    addCodecs();
+}
+
+void tst_bench_FileDataCodec::uncompress()
+{
+    QFETCH(int, codec);
+
+    QList<QByteArray> compressed;
+    compressed.reserve(m_pages.size());
+    for (const QByteArray &page : qAsConst(m_pages))
+        compressed.append(QHelpFileDataCodec::compress(page, codec));
+    QCOMPARE(QHelpFileDataCodec::uncompress(compressed.first(), codec), m_pages.first());
+
+    QBENCHMARK {
+        for (const QByteArray &data : qAsConst(compressed))
+            QHelpFileDataCodec::uncompress(data, codec);
+    }
+}
+
+QTEST_MAIN(tst_bench_FileDataCodec)
+#include "tst_bench_filedatacodec.moc"
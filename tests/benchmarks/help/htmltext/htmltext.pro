@@ -0,0 +1,5 @@
+CONFIG += benchmark
+QT = core gui help-private testlib
+TARGET = tst_bench_htmltext
+
+SOURCES += tst_bench_htmltext.cpp
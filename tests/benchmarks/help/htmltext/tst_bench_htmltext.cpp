@@ -0,0 +1,128 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QDirIterator>
+#include <QtCore/QStringDecoder>
+#include <QtGui/QTextDocument>
+
+#include <QtHelp/private/qhelphtmltextextractor_p.h>
+
+// Set QTHELP_BENCHMARK_CORPUS to a directory of generated HTML documentation,
+// like qtbase/doc/qtcore, to measure a real corpus. Otherwise a synthetic
+// reference page is used.
+static const char corpusVariable[] = "QTHELP_BENCHMARK_CORPUS";
+
+class tst_bench_HtmlText : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void textDocument();
+    void extractor();
+
+private:
+    QList<QByteArray> m_pages;
+};
+
+static QByteArray syntheticPage()
+{
+    QByteArray page = "<!DOCTYPE html>\n<html lang=\"en\">\n<head>\n"
+                      "<meta charset=\"utf-8\">\n<title>QWidget Class | Qt Widgets 6.0</title>\n"
+                      "<link rel=\"stylesheet\" type=\"text/css\" href=\"style/offline.css\" />\n"
+                      "<script type=\"text/javascript\">document.getElementById('x');</script>\n"
+                      "</head>\n<body>\n<div class=\"header\" id=\"qtdocheader\">\n"
+                      "<h1 class=\"title\">QWidget Class</h1>\n";
+    for (int i = 0; i < 400; ++i) {
+        page += "<h3 class=\"fn\" id=\"member" + QByteArray::number(i) + "\">"
+                "<a name=\"member" + QByteArray::number(i) + "\"></a>"
+                "<span class=\"type\">void</span> QWidget::<span class=\"name\">member"
+                + QByteArray::number(i) + "</span>(<span class=\"type\">int</span> "
+                "<i>value</i>)</h3>\n<p>Sets the property to <i>value</i> &mdash; "
+                "see also <a href=\"qwidget.html#other\">other</a>() &amp; friends.</p>\n"
+                "<pre class=\"cpp\">  <span class=\"type\">QWidget</span> w;\n"
+                "  w<span class=\"operator\">.</span>member(<span class=\"number\">"
+                + QByteArray::number(i) + "</span>);\n</pre>\n";
+    }
+    page += "</div>\n</body>\n</html>\n";
+    return page;
+}
+
+void tst_bench_HtmlText::initTestCase()
+{
+    const QString corpus = qEnvironmentVariable(corpusVariable);
+    if (!corpus.isEmpty()) {
+        QDirIterator it(corpus, QStringList() << QLatin1String("*.html"),
+                        QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            QFile file(it.next());
+            if (file.open(QIODevice::ReadOnly))
+                m_pages.append(file.readAll());
+        }
+        QVERIFY2(!m_pages.isEmpty(), qPrintable(corpus + QLatin1String(" contains no HTML files")));
+    } else {
+        m_pages.append(syntheticPage());
+    }
+    qint64 size = 0;
+    for (const QByteArray &page : qAsConst(m_pages))
+        size += page.size();
+    qDebug("%lld pages, %lld bytes", qint64(m_pages.size()), size);
+}
+
+void tst_bench_HtmlText::textDocument()
+{
+    // What the search indexer did before: decode, lay out, and query.
+    QBENCHMARK {
+        for (const QByteArray &page : qAsConst(m_pages)) {
+            const auto encoding = QStringDecoder::encodingForHtml(page.constData(), page.size());
+            QStringDecoder decoder(encoding ? *encoding : QStringDecoder::Utf8);
+            QTextDocument doc;
+            doc.setHtml(decoder(page));
+            const QString title = doc.metaInformation(QTextDocument::DocumentTitle);
+            const QString text = doc.toPlainText();
+            Q_UNUSED(title);
+            Q_UNUSED(text);
+        }
+    }
+}
+
+void tst_bench_HtmlText::extractor()
+{
+    QBENCHMARK {
+        for (const QByteArray &page : qAsConst(m_pages)) {
+            QString title;
+            QString text;
+            QHelpHtmlTextExtractor::extract(page, &title, &text);
+        }
+    }
+}
+
+QTEST_MAIN(tst_bench_HtmlText)
+#include "tst_bench_htmltext.moc"
@@ -0,0 +1,175 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QFileInfo>
+#include <QtCore/QTemporaryDir>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+
+#include <QtHelp/QHelpEngineCore>
+#include <QtHelp/QHelpLink>
+
+class tst_bench_KeywordLookup : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void documentsForKeyword_data();
+    void documentsForKeyword();
+    void documentsForIdentifier_data();
+    void documentsForIdentifier();
+
+private:
+    bool createDocumentation(const QString &fileName, int number);
+
+    QTemporaryDir m_dir;
+    QHelpEngineCore *m_helpEngine = nullptr;
+};
+
+static const int namespaceCount = 20;
+static const int keywordsPerNamespace = 10000;
+
+static QString keyword(int number)
+{
+    return QString::fromLatin1("keyword%1").arg(number);
+}
+
+static QString identifier(int namespaceNumber, int number)
+{
+    return QString::fromLatin1("Bench%1::keyword%2").arg(namespaceNumber).arg(number);
+}
+
+// Clones the test documentation, renames its namespace and
+// adds keywordsPerNamespace keywords pointing to test.html.
+bool tst_bench_KeywordLookup::createDocumentation(const QString &fileName, int number)
+{
+    const QString source = QLatin1String(SRCDIR)
+            + QLatin1String("/../../../auto/qhelpenginecore/data/test.qch");
+    if (!QFile::copy(source, fileName))
+        return false;
+    QFile::setPermissions(fileName, QFile::WriteUser | QFile::ReadUser);
+
+    const QString connectionName = QLatin1String("bench") + QString::number(number);
+    bool ok = true;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QLatin1String("QSQLITE"), connectionName);
+        db.setDatabaseName(fileName);
+        ok = db.open();
+        if (ok) {
+            QSqlQuery query(db);
+            ok = db.transaction();
+            query.prepare(QLatin1String("UPDATE NamespaceTable SET Name = ?"));
+            query.bindValue(0, QString::fromLatin1("org.qt-project.bench.%1").arg(number));
+            ok = ok && query.exec();
+            query.prepare(QLatin1String("INSERT INTO IndexTable "
+                                        "VALUES(NULL, ?, ?, 1, 4, ?)"));
+            for (int i = 0; ok && i < keywordsPerNamespace; ++i) {
+                query.bindValue(0, keyword(i));
+                query.bindValue(1, identifier(number, i));
+                query.bindValue(2, keyword(i));
+                ok = query.exec();
+            }
+            ok = ok && db.commit();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return ok;
+}
+
+void tst_bench_KeywordLookup::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    m_helpEngine = new QHelpEngineCore(m_dir.filePath(QLatin1String("bench.qhc")));
+    m_helpEngine->setUsesFilterEngine(true);
+    QVERIFY(m_helpEngine->setupData());
+
+    for (int i = 0; i < namespaceCount; ++i) {
+        const QString fileName = m_dir.filePath(QString::fromLatin1("bench%1.qch").arg(i));
+        QVERIFY(createDocumentation(fileName, i));
+        QVERIFY(m_helpEngine->registerDocumentation(fileName));
+    }
+}
+
+void tst_bench_KeywordLookup::cleanupTestCase()
+{
+    delete m_helpEngine;
+    m_helpEngine = nullptr;
+}
+
+void tst_bench_KeywordLookup::documentsForKeyword_data()
+{
+    QTest::addColumn<QString>("keyword");
+    QTest::addColumn<int>("expectedCount");
+
+    QTest::newRow("first") << keyword(0) << namespaceCount;
+    QTest::newRow("last") << keyword(keywordsPerNamespace - 1) << namespaceCount;
+    QTest::newRow("missing") << QString::fromLatin1("nokeyword") << 0;
+}
+
+void tst_bench_KeywordLookup::documentsForKeyword()
+{
+    QFETCH(QString, keyword);
+    QFETCH(int, expectedCount);
+
+    QList<QHelpLink> links;
+    QBENCHMARK {
+        links = m_helpEngine->documentsForKeyword(keyword, QString());
+    }
+    QCOMPARE(links.count(), expectedCount);
+}
+
+void tst_bench_KeywordLookup::documentsForIdentifier_data()
+{
+    QTest::addColumn<QString>("id");
+    QTest::addColumn<int>("expectedCount");
+
+    QTest::newRow("first") << identifier(0, 0) << 1;
+    QTest::newRow("last")
+            << identifier(namespaceCount - 1, keywordsPerNamespace - 1) << 1;
+    QTest::newRow("missing") << QString::fromLatin1("Bench::nokeyword") << 0;
+}
+
+void tst_bench_KeywordLookup::documentsForIdentifier()
+{
+    QFETCH(QString, id);
+    QFETCH(int, expectedCount);
+
+    QList<QHelpLink> links;
+    QBENCHMARK {
+        links = m_helpEngine->documentsForIdentifier(id, QString());
+    }
+    QCOMPARE(links.count(), expectedCount);
+}
+
+QTEST_MAIN(tst_bench_KeywordLookup)
+#include "tst_bench_keywordlookup.moc"
@@ -0,0 +1,6 @@
+CONFIG += benchmark
+QT = core help sql testlib
+TARGET = tst_bench_reindex
+DEFINES += QT_USE_USING_NAMESPACE SRCDIR=\\\"$$PWD\\\"
+
+SOURCES += tst_bench_reindex.cpp
@@ -0,0 +1,188 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+#include <QtCore/QTemporaryDir>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+
+#include <QtHelp/QHelpEngineCore>
+#include <QtHelp/QHelpSearchEngine>
+
+class tst_bench_Reindex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void changeOnePage();
+    void reindexAll();
+
+private:
+    bool createDocumentation();
+    bool updatePage(int number, int revision);
+    bool waitForIndexing(void (QHelpSearchEngine::*start)());
+
+    QTemporaryDir m_dir;
+    QString m_fileName;
+    QDateTime m_lastModified;
+    QHelpEngineCore *m_helpEngine = nullptr;
+    QHelpSearchEngine *m_searchEngine = nullptr;
+};
+
+static const int pageCount = 2000;
+
+static QByteArray page(int number, int revision)
+{
+    QByteArray html = "<html><head><title>Page " + QByteArray::number(number)
+            + "</title></head><body><h1>Page " + QByteArray::number(number) + "</h1>";
+    for (int i = 0; i < 50; ++i) {
+        html += "<p>Paragraph " + QByteArray::number(i) + " of page " + QByteArray::number(number)
+                + ", revision " + QByteArray::number(revision)
+                + ". The quick brown fox jumps over the lazy dog.</p>";
+    }
+    return html + "</body></html>";
+}
+
+// Clones the test documentation and adds pageCount pages to it,
+// which are visible with every filter attribute.
+bool tst_bench_Reindex::createDocumentation()
+{
+    const QString source = QLatin1String(SRCDIR)
+            + QLatin1String("/../../../auto/qhelpenginecore/data/test.qch");
+    if (!QFile::copy(source, m_fileName))
+        return false;
+    QFile::setPermissions(m_fileName, QFile::WriteUser | QFile::ReadUser);
+
+    const QString connectionName = QLatin1String("benchCreate");
+    bool ok = true;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QLatin1String("QSQLITE"), connectionName);
+        db.setDatabaseName(m_fileName);
+        ok = db.open() && db.transaction();
+        QSqlQuery dataQuery(db);
+        QSqlQuery nameQuery(db);
+        QSqlQuery filterQuery(db);
+        ok = ok && dataQuery.prepare(QLatin1String("INSERT INTO FileDataTable VALUES(NULL, ?)"))
+                && nameQuery.prepare(QLatin1String("INSERT INTO FileNameTable VALUES(1, ?, ?, ?)"))
+                && filterQuery.prepare(QLatin1String("INSERT INTO FileFilterTable "
+                                                     "SELECT Id, ? FROM FilterAttributeTable"));
+        for (int i = 0; ok && i < pageCount; ++i) {
+            dataQuery.bindValue(0, qCompress(page(i, 0)));
+            ok = dataQuery.exec();
+            const QVariant fileId = dataQuery.lastInsertId();
+            nameQuery.bindValue(0, QString::fromLatin1("bench/page%1.html").arg(i));
+            nameQuery.bindValue(1, fileId);
+            nameQuery.bindValue(2, QString::fromLatin1("Page %1").arg(i));
+            filterQuery.bindValue(0, fileId);
+            ok = ok && nameQuery.exec() && filterQuery.exec();
+        }
+        ok = ok && db.commit();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return ok;
+}
+
+// Changes the content of one page and bumps the modification time
+// of the documentation, so that the indexer notices the update.
+bool tst_bench_Reindex::updatePage(int number, int revision)
+{
+    const QString connectionName = QLatin1String("benchUpdate");
+    bool ok = true;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QLatin1String("QSQLITE"), connectionName);
+        db.setDatabaseName(m_fileName);
+        ok = db.open();
+        QSqlQuery query(db);
+        ok = ok && query.prepare(QLatin1String("UPDATE FileDataTable SET Data = ? WHERE Id = "
+                                               "(SELECT FileId FROM FileNameTable WHERE Name = ?)"));
+        query.bindValue(0, qCompress(page(number, revision)));
+        query.bindValue(1, QString::fromLatin1("bench/page%1.html").arg(number));
+        ok = ok && query.exec() && query.numRowsAffected() == 1;
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    m_lastModified = m_lastModified.addSecs(1);
+    QFile file(m_fileName);
+    return ok && file.open(QIODevice::ReadWrite)
+            && file.setFileTime(m_lastModified, QFileDevice::FileModificationTime);
+}
+
+bool tst_bench_Reindex::waitForIndexing(void (QHelpSearchEngine::*start)())
+{
+    QSignalSpy spy(m_searchEngine, &QHelpSearchEngine::indexingFinished);
+    (m_searchEngine->*start)();
+    return spy.wait(120000);
+}
+
+void tst_bench_Reindex::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    m_fileName = m_dir.filePath(QLatin1String("bench.qch"));
+    QVERIFY(createDocumentation());
+    m_lastModified = QFileInfo(m_fileName).lastModified();
+
+    m_helpEngine = new QHelpEngineCore(m_dir.filePath(QLatin1String("bench.qhc")));
+    QVERIFY(m_helpEngine->setupData());
+    QVERIFY(m_helpEngine->registerDocumentation(m_fileName));
+
+    m_searchEngine = new QHelpSearchEngine(m_helpEngine);
+    QVERIFY(waitForIndexing(&QHelpSearchEngine::reindexDocumentation));
+}
+
+void tst_bench_Reindex::cleanupTestCase()
+{
+    delete m_searchEngine;
+    m_searchEngine = nullptr;
+    delete m_helpEngine;
+    m_helpEngine = nullptr;
+}
+
+void tst_bench_Reindex::changeOnePage()
+{
+    int revision = 0;
+    QBENCHMARK {
+        QVERIFY(updatePage(pageCount / 2, ++revision));
+        QVERIFY(waitForIndexing(&QHelpSearchEngine::scheduleIndexDocumentation));
+    }
+}
+
+void tst_bench_Reindex::reindexAll()
+{
+    QBENCHMARK {
+        QVERIFY(waitForIndexing(&QHelpSearchEngine::reindexDocumentation));
+    }
+}
+
+QTEST_MAIN(tst_bench_Reindex)
+#include "tst_bench_reindex.moc"
@@ -0,0 +1,8 @@
+CONFIG += benchmark
+QT = core-private testlib
+TARGET = tst_bench_qmwriter
+DEFINES += QT_NO_CAST_FROM_ASCII QT_NO_CAST_TO_ASCII
+
+include(../../../../src/linguist/shared/formats.pri)
+
+SOURCES += tst_bench_qmwriter.cpp
@@ -0,0 +1,98 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "translator.h"
+
+#include <QtCore/QBuffer>
+#include <QtTest/QtTest>
+
+class tst_bench_QMWriter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void save_data();
+    void save();
+
+private:
+    Translator m_translator;
+};
+
+void tst_bench_QMWriter::initTestCase()
+{
+    // 100k messages in 1000 contexts, some of them with comments and plurals.
+    m_translator.setLanguageCode(QLatin1String("de_DE"));
+    const int contexts = 1000;
+    const int messagesPerContext = 100;
+    for (int c = 0; c < contexts; ++c) {
+        const QString context = QString::fromLatin1("Context%1").arg(c);
+        for (int m = 0; m < messagesPerContext; ++m) {
+            TranslatorMessage msg;
+            msg.setContext(context);
+            msg.setSourceText(QString::fromLatin1("Message number %1 in %2").arg(m).arg(context));
+            if (m % 10 == 0)
+                msg.setComment(QString::fromLatin1("disambiguation %1").arg(m));
+            if (m % 20 == 0) {
+                msg.setPlural(true);
+                msg.setTranslations(QStringList()
+                                    << QString::fromLatin1("%n Nachricht %1").arg(m)
+                                    << QString::fromLatin1("%n Nachrichten %1").arg(m));
+            } else {
+                msg.setTranslation(QString::fromUtf8("Nachricht Nummer %1 \xc3\xbc\xc3\xa4")
+                                   .arg(m));
+            }
+            msg.setType(TranslatorMessage::Finished);
+            m_translator.append(msg);
+        }
+    }
+}
+
+void tst_bench_QMWriter::save_data()
+{
+    QTest::addColumn<int>("saveMode");
+    QTest::newRow("everything") << int(SaveEverything);
+    QTest::newRow("stripped") << int(SaveStripped);
+}
+
+void tst_bench_QMWriter::save()
+{
+    QFETCH(int, saveMode);
+
+    QBENCHMARK {
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        ConversionData cd;
+        cd.m_saveMode = TranslatorSaveMode(saveMode);
+        QVERIFY(saveQM(m_translator, buffer, cd));
+    }
+}
+
+QTEST_MAIN(tst_bench_QMWriter)
+#include "tst_bench_qmwriter.moc"
@@ -0,0 +1,184 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "translator.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QtTest>
+
+#if defined(__GLIBC__) && defined(__GLIBC_PREREQ)
+#  if __GLIBC_PREREQ(2, 33)
+#    include <malloc.h>
+#    define HAVE_MALLINFO2
+#  endif
+#endif
+
+QT_BEGIN_NAMESPACE
+bool loadTSWithXmlReader(Translator &translator, QIODevice &dev, ConversionData &cd);
+QT_END_NAMESPACE
+
+class tst_bench_TSReader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void sameResult();
+    void load_data();
+    void load();
+
+private:
+    bool loadWith(const QString &reader, Translator *translator);
+
+    QTemporaryDir m_dir;
+    QString m_fileName;
+};
+
+static qint64 heapInUse()
+{
+#ifdef HAVE_MALLINFO2
+    return qint64(mallinfo2().uordblks);
+#else
+    return -1;
+#endif
+}
+
+void tst_bench_TSReader::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    m_fileName = m_dir.filePath(QLatin1String("bench.ts"));
+
+    // A large, lupdate-like TS file: many messages in a moderate number of
+    // contexts and source files, with some plurals, comments and markup.
+    Translator tor;
+    tor.setLanguageCode(QLatin1String("de_DE"));
+    tor.setSourceLanguageCode(QLatin1String("en_US"));
+    tor.setLocationsType(Translator::RelativeLocations);
+    const int contexts = 1000;
+    const int messagesPerContext = 100;
+    for (int c = 0; c < contexts; ++c) {
+        const QString context = QString::fromLatin1("Context%1").arg(c);
+        const QString fileName = QString::fromLatin1("src/module%1/file%2.cpp").arg(c % 50).arg(c);
+        for (int m = 0; m < messagesPerContext; ++m) {
+            TranslatorMessage msg;
+            msg.setContext(context);
+            msg.setSourceText(QString::fromLatin1("<b>Message</b> number %1 in \"%2\" & co.")
+                              .arg(m).arg(context));
+            msg.setFileName(fileName);
+            msg.setLineNumber(10 + 7 * m);
+            if (m % 10 == 0)
+                msg.setComment(QString::fromLatin1("disambiguation %1").arg(m));
+            if (m % 5 == 0)
+                msg.setExtraComment(QLatin1String("A comment for the translator"));
+            if (m % 20 == 0) {
+                msg.setPlural(true);
+                msg.setTranslations(QStringList()
+                                    << QString::fromLatin1("%n Nachricht %1").arg(m)
+                                    << QString::fromLatin1("%n Nachrichten %1").arg(m));
+            } else {
+                msg.setTranslation(QString::fromUtf8("Nachricht Nummer %1 \xc3\xbc\xc3\xa4")
+                                   .arg(m));
+            }
+            msg.setType(m % 3 ? TranslatorMessage::Finished : TranslatorMessage::Unfinished);
+            tor.append(msg);
+        }
+    }
+    ConversionData cd;
+    QVERIFY2(tor.save(m_fileName, cd, QLatin1String("ts")), qPrintable(cd.error()));
+}
+
+bool tst_bench_TSReader::loadWith(const QString &reader, Translator *translator)
+{
+    ConversionData cd;
+    cd.m_sourceFileName = m_fileName;
+    if (reader == QLatin1String("fast"))
+        return translator->load(m_fileName, cd, QLatin1String("ts"));
+    QFile file(m_fileName);
+    return file.open(QIODevice::ReadOnly) && loadTSWithXmlReader(*translator, file, cd);
+}
+
+void tst_bench_TSReader::sameResult()
+{
+    Translator xml;
+    Translator fast;
+    QVERIFY(loadWith(QLatin1String("xmlreader"), &xml));
+    QVERIFY(loadWith(QLatin1String("fast"), &fast));
+
+    QCOMPARE(fast.languageCode(), xml.languageCode());
+    QCOMPARE(fast.sourceLanguageCode(), xml.sourceLanguageCode());
+    QCOMPARE(fast.locationsType(), xml.locationsType());
+    QCOMPARE(fast.messageCount(), xml.messageCount());
+    for (int i = 0; i < xml.messageCount(); ++i) {
+        const TranslatorMessage &a = fast.message(i);
+        const TranslatorMessage &b = xml.message(i);
+        QCOMPARE(a.context(), b.context());
+        QCOMPARE(a.sourceText(), b.sourceText());
+        QCOMPARE(a.comment(), b.comment());
+        QCOMPARE(a.extraComment(), b.extraComment());
+        QCOMPARE(a.translations(), b.translations());
+        QCOMPARE(a.type(), b.type());
+        QCOMPARE(a.isPlural(), b.isPlural());
+        QCOMPARE(a.fileName(), b.fileName());
+        QCOMPARE(a.lineNumber(), b.lineNumber());
+    }
+}
+
+void tst_bench_TSReader::load_data()
+{
+    QTest::addColumn<QString>("reader");
+    QTest::newRow("xmlreader") << QString::fromLatin1("xmlreader");
+    QTest::newRow("fast") << QString::fromLatin1("fast");
+}
+
+void tst_bench_TSReader::load()
+{
+    QFETCH(QString, reader);
+
+    // Memory that stays allocated for the loaded translator; the readers'
+    // own buffers are gone by then, so this is a lower bound of the peak.
+    const qint64 heapBefore = heapInUse();
+    {
+        Translator translator;
+        QVERIFY(loadWith(reader, &translator));
+        const qint64 heapAfter = heapInUse();
+        if (heapBefore >= 0) {
+            qDebug("%s: %d messages, %lld KiB of heap retained", qPrintable(reader),
+                   translator.messageCount(), (heapAfter - heapBefore) / 1024);
+        }
+    }
+
+    QBENCHMARK {
+        Translator translator;
+        loadWith(reader, &translator);
+    }
+}
+
+QTEST_MAIN(tst_bench_TSReader)
+#include "tst_bench_tsreader.moc"
@@ -0,0 +1,5 @@
+CONFIG += benchmark
+QT = core testlib
+TARGET = tst_bench_generate
+
+SOURCES += tst_bench_generate.cpp
@@ -0,0 +1,159 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QtCore/QProcess>
+#include <QtCore/QTemporaryDir>
+
+// Measures the -generate phase of a module that depends on many large
+// modules, reading the dependencies' XML or binary index files.
+static const int dependencyCount = 10;
+static const int pagesPerDependency = 2000;
+
+class tst_bench_Generate : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void generate_data();
+    void generate();
+
+private:
+    bool runQDoc(const QStringList &arguments);
+    bool writeFile(const QString &fileName, const QByteArray &contents);
+
+    QString m_qdoc;
+    QTemporaryDir m_dir;
+};
+
+bool tst_bench_Generate::runQDoc(const QStringList &arguments)
+{
+    QProcess qdoc;
+    qdoc.setProgram(m_qdoc);
+    qdoc.setArguments(arguments);
+    qdoc.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    qdoc.start();
+    return qdoc.waitForFinished(-1) && qdoc.exitStatus() == QProcess::NormalExit
+            && qdoc.exitCode() == 0;
+}
+
+bool tst_bench_Generate::writeFile(const QString &fileName, const QByteArray &contents)
+{
+    QFile file(m_dir.filePath(fileName));
+    return file.open(QIODevice::WriteOnly) && file.write(contents) == contents.size();
+}
+
+void tst_bench_Generate::initTestCase()
+{
+    const auto binpath = QLibraryInfo::path(QLibraryInfo::BinariesPath);
+    const auto extension = QSysInfo::productType() == "windows" ? ".exe" : "";
+    m_qdoc = binpath + QLatin1String("/qdoc") + extension;
+    if (!QFileInfo::exists(m_qdoc))
+        QSKIP("qdoc is not installed");
+    QVERIFY(m_dir.isValid());
+
+    // Dependencies with many pages, keywords, targets and sections, so
+    // that their indexes are of the size of a Qt module's index.
+    QByteArray depends;
+    qint64 xmlSize = 0;
+    qint64 binarySize = 0;
+    for (int d = 0; d < dependencyCount; ++d) {
+        const QByteArray module = "benchmodule" + QByteArray::number(d);
+        QByteArray source;
+        for (int p = 0; p < pagesPerDependency; ++p) {
+            const QByteArray page = QByteArray::number(p);
+            source += "/*!\n    \\page " + module + "-page" + page + ".html\n"
+                      "    \\title " + module + " Page " + page + "\n"
+                      "    \\keyword " + module + "-keyword" + page + "\n"
+                      "    \\target " + module + "-target" + page + "\n"
+                      "    \\brief A synthetic page for the generate benchmark.\n\n"
+                      "    \\section1 Details of Page " + page + "\n\n"
+                      "    Some text.\n\n"
+                      "    \\section1 Notes on Page " + page + "\n\n"
+                      "    Some more text.\n*/\n\n";
+        }
+        QVERIFY(writeFile(module + ".qdoc", source));
+        QVERIFY(writeFile(module + ".qdocconf",
+                          "project = " + module + "\n"
+                          "moduleheader =\n"
+                          "locationinfo = false\n"
+                          "sources = " + module + ".qdoc\n"));
+        const QString outputDir = m_dir.filePath(QLatin1String("docs/") + module);
+        QVERIFY(runQDoc(QStringList() << "-prepare" << "-outputdir" << outputDir
+                                      << m_dir.filePath(module + ".qdocconf")));
+        const QString index = outputDir + QLatin1Char('/') + module + ".index";
+        QVERIFY(QFileInfo::exists(index));
+        xmlSize += QFileInfo(index).size();
+        binarySize += QFileInfo(index + ".bin").size();
+        depends += ' ' + module;
+    }
+    qDebug("%d indexes: %lld KiB of XML, %lld KiB binary", dependencyCount, xmlSize / 1024,
+           binarySize / 1024);
+
+    QByteArray source = "/*!\n    \\page index.html\n    \\title Bench Main\n\n";
+    for (int d = 0; d < dependencyCount; ++d) {
+        const QByteArray module = "benchmodule" + QByteArray::number(d);
+        source += "    See \\l {" + module + " Page 42}, \\l {" + module + "-keyword7} and \\l {"
+                + module + "-target1999}.\n";
+    }
+    source += "*/\n";
+    QVERIFY(writeFile("benchmain.qdoc", source));
+    QVERIFY(writeFile("benchmain.qdocconf",
+                      "project = BenchMain\n"
+                      "moduleheader =\n"
+                      "locationinfo = false\n"
+                      "sources = benchmain.qdoc\n"
+                      "depends =" + depends + "\n"));
+}
+
+void tst_bench_Generate::generate_data()
+{
+    QTest::addColumn<QStringList>("extraArguments");
+    QTest::newRow("xml") << QStringList("-no-binary-indexes");
+    QTest::newRow("binary") << QStringList();
+}
+
+void tst_bench_Generate::generate()
+{
+    QFETCH(QStringList, extraArguments);
+
+    const QStringList arguments = QStringList()
+            << "-generate" << "-outputdir" << m_dir.filePath("docs/benchmain")
+            << "-indexdir" << m_dir.filePath("docs") << extraArguments
+            << m_dir.filePath("benchmain.qdocconf");
+    QVERIFY(runQDoc(arguments));
+
+    QBENCHMARK {
+        runQDoc(arguments);
+    }
+}
+
+QTEST_MAIN(tst_bench_Generate)
+#include "tst_bench_generate.moc"